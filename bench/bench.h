@@ -0,0 +1,56 @@
+#pragma once
+#include <stddef.h>
+
+// --- HOST BENCHMARK HARNESS ---
+// Built by [env:native]; see README "Host benchmarks".
+
+struct BenchSite {
+    const char *name;
+    double lat;
+    double lon;
+};
+
+extern const char *const BENCH_TLES[];
+extern const int BENCH_TLE_COUNT;
+extern const BenchSite BENCH_SITES[];
+extern const int BENCH_SITE_COUNT;
+
+// Wall clock in seconds (monotonic)
+double benchSeconds();
+
+// Heap accounting (malloc/new are wrapped at link time)
+struct BenchHeap {
+    unsigned long allocs;
+    size_t live;
+    size_t peak;
+};
+BenchHeap benchHeap();
+void benchResetPeak();
+
+// Loads one of BENCH_TLES through the normal parseTLEData() path
+bool benchLoadTLE(int index);
+
+// Same TLE straight into a SatElements, bypassing the orbit module
+struct SatElements;
+bool benchLoadElements(int index, SatElements &el);
+
+// Recomputes the modulo-10 checksum of an edited TLE line
+void benchFixChecksum(char *line);
+
+// A synthetic CelesTrak group file: the bench TLEs cloned under catalog
+// numbers 10000, 10001, ... with checksums fixed up. Caller frees.
+char *benchBuildGroupFile(int records, size_t &len);
+
+// Suites
+void benchOrbit();
+void benchPrecision();
+void benchTle();
+void benchTask();
+void benchCatalog();
+void benchNet();
+void benchPerf();
+void benchSched();
+void benchAlert();
+void benchGps();
+void benchTimeSync();
+void benchScreenshot();
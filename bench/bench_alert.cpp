@@ -0,0 +1,108 @@
+#include <Arduino.h>
+#include <climits>
+
+#include "alert.h"
+#include "bench.h"
+#include "config.h"
+
+// --- ALERTS ---
+// The sequencer against a speaker that only records what it was asked to
+// play and when, on a simulated clock. The "loop" polls when alertPoll()
+// says to, optionally late, the way TIMER_AUDIO runs on the device.
+// Each scenario prints the notes as they started. Then what one poll costs
+// next to the delay() chain the old playAosSequence() blocked loop() for.
+
+#define BENCH_NOTES_MAX 32
+#define NEVER           ULONG_MAX
+
+struct PlayedNote {
+    unsigned long at;
+    uint16_t freqHz;
+    uint32_t ms;
+    bool cut;           // A stop() came before it finished
+};
+
+static unsigned long simMs = 0;
+static PlayedNote played[BENCH_NOTES_MAX];
+static int playedCount = 0;
+
+static unsigned long simClock() {
+    return simMs;
+}
+
+static void fakeTone(uint16_t freqHz, uint32_t ms) {
+    if (playedCount < BENCH_NOTES_MAX) played[playedCount++] = {simMs, freqHz, ms, false};
+}
+
+static void fakeStop() {
+    if (playedCount > 0) {
+        PlayedNote &last = played[playedCount - 1];
+        if (simMs < last.at + last.ms) last.cut = true;
+    }
+}
+
+static const AlertSpeaker FAKE_SPEAKER = {fakeTone, fakeStop};
+
+struct Request {
+    unsigned long at;
+    Alert alert;
+};
+
+// Polls as told (plus `lateMs`) until silent, making `requests` on time
+static void run(const char *name, const Request *requests, int count, unsigned long lateMs) {
+    alertBegin(&FAKE_SPEAKER, simClock);
+    playedCount = 0;
+    simMs = 0;
+    int next = 0;
+    unsigned long pollAt = NEVER;
+    while (next < count || pollAt != NEVER) {
+        unsigned long reqAt = next < count ? requests[next].at : NEVER;
+        simMs = reqAt < pollAt ? reqAt : pollAt;
+        if (simMs == reqAt) alertPlay(requests[next++].alert);
+        unsigned long ms = alertPoll();
+        pollAt = ms ? simMs + ms + lateMs : NEVER;
+    }
+
+    printf("%s (polls %lu ms late):\n ", name, lateMs);
+    for (int i = 0; i < playedCount; i++) {
+        printf(" %lu:%u%s", played[i].at, played[i].freqHz, played[i].cut ? "(cut)" : "");
+    }
+    const PlayedNote &last = played[playedCount - 1];
+    printf("\n  silent at %lu ms\n", last.cut ? last.at : last.at + last.ms);
+}
+
+void benchAlert() {
+    const Request aos[] = {{0, ALERT_AOS}};
+    run("AOS melody", aos, 1, 0);
+    run("AOS melody", aos, 1, 20);
+
+    const Request countdown[] = {
+        {0, ALERT_COUNTDOWN}, {7000, ALERT_COUNTDOWN}, {8000, ALERT_COUNTDOWN},
+        {9000, ALERT_COUNTDOWN}, {10000, ALERT_AOS},
+    };
+    run("countdown 10-3-2-1 then AOS", countdown, 5, 0);
+
+    const Request cut[] = {{0, ALERT_LOS}, {60, ALERT_AOS}};
+    run("AOS cuts a LOS tone short", cut, 2, 0);
+
+    const Request queued[] = {{0, ALERT_AOS}, {100, ALERT_COUNTDOWN}, {120, ALERT_LOS}, {130, ALERT_LOS}};
+    run("LOS and a beep queued behind AOS", queued, 4, 0);
+
+    // Cost of one poll, and what the blocking version held loop() for
+    alertBegin(&FAKE_SPEAKER, simClock);
+    const int N = 2000000;
+    double t0 = benchSeconds();
+    for (int i = 0; i < N; i++) {
+        if (!alertBusy()) {
+            playedCount = 0;
+            alertPlay(ALERT_AOS);
+        }
+        simMs += 50;
+        alertPoll();
+    }
+    double pollNs = (benchSeconds() - t0) / N * 1e9;
+    static const AlertNote melody[] = AOS_MELODY;
+    unsigned long blocked = 0;
+    for (size_t i = 0; i + 1 < sizeof(melody) / sizeof(melody[0]); i++) blocked += melody[i].ms + melody[i].gapMs;
+    printf("\nalertPoll(): %.0f ns per call; playAosSequence() blocked loop() for %lu ms\n", pollNs, blocked);
+}
@@ -0,0 +1,243 @@
+#include <Arduino.h>
+#include <math.h>
+#include <vector>
+
+#include "bench.h"
+#include "config.h"
+#include "catalog.h"
+#include "catalog_file.h"
+#include "propagator.h"
+
+// --- BATCH CATALOG ---
+// Throughput of one catalog tick (propagate everything, then list what's
+// overhead) as the catalog grows, against the same satellites propagated one
+// at a time through propagate<float> + lookAngles() from a SatElements each.
+// The catalog is the near-Earth bench TLEs cloned with their node and mean
+// anomaly spread out, so the overhead list isn't the same few points.
+//
+// Then the compiled catalog file against the TLE text it's built from:
+// finding one satellite by NORAD number, and filling the batch catalog at
+// boot. Files go to the system temp directory.
+
+static void buildRecords(std::vector<TleRecord> &out, int n) {
+    std::vector<TleRecord> bases;
+    for (int i = 0; i < BENCH_TLE_COUNT; i++) {
+        TleRecord rec;
+        SatElements el;
+        if (!tleParseText(BENCH_TLES[i], strlen(BENCH_TLES[i]), rec)) continue;
+        if (!loadElements(el, rec.name, rec.line1, rec.line2) || !el.nearEarth) continue;
+        bases.push_back(rec);
+    }
+
+    out.clear();
+    for (int i = 0; i < n; i++) {
+        TleRecord rec = bases[i % bases.size()];
+        char field[10];
+        snprintf(field, sizeof(field), "%05d", 10000 + i % 90000);
+        memcpy(rec.line1 + 2, field, 5);
+        memcpy(rec.line2 + 2, field, 5);
+        snprintf(field, sizeof(field), "%8.4f", fmod(rec.raanDeg + i * 137.508, 360.0));
+        memcpy(rec.line2 + 17, field, 8);
+        snprintf(field, sizeof(field), "%8.4f", fmod(rec.meanAnomDeg + i * 97.31, 360.0));
+        memcpy(rec.line2 + 43, field, 8);
+        benchFixChecksum(rec.line1);
+        benchFixChecksum(rec.line2);
+        out.push_back(rec);
+    }
+}
+
+// Worst catalog position error against propagate<double>, `days` after epoch
+static double maxErrorKm(const std::vector<SatElements> &els, int days) {
+    double t = els[0].epochUnix + days * 86400.0;
+    catalogPropagate(t);
+    double worst = 0;
+    for (size_t i = 0; i < els.size(); i++) {
+        float r[3];
+        SatState ref = propagate<double>(els[i], t);
+        if (!ref.valid || !catalogPosition(i, r)) continue;
+        double dx = r[0] - ref.r[0], dy = r[1] - ref.r[1], dz = r[2] - ref.r[2];
+        double e = sqrt(dx * dx + dy * dy + dz * dz);
+        if (e > worst) worst = e;
+    }
+    return worst;
+}
+
+static const char *TEXT_PATH = "/tmp/iss_bench_catalog.tle";
+static const char *BIN_PATH = "/tmp/iss_bench_catalog.bin";
+
+struct TextFind {
+    long catalogNumber;
+    bool found;
+};
+
+static bool matchRecord(const TleRecord &rec, void *ctx) {
+    TextFind *f = (TextFind *)ctx;
+    if (rec.catalogNumber != f->catalogNumber) return true;
+    f->found = true;
+    return false;
+}
+
+// What readTLEFromSD() does: stream the text until the number turns up
+static bool textFind(long catalogNumber) {
+    FILE *in = fopen(TEXT_PATH, "rb");
+    if (!in) return false;
+    static TleReader reader;
+    char chunk[512];
+    TextFind find = {catalogNumber, false};
+    tleReaderInit(reader);
+    bool more = true;
+    size_t n;
+    while (more && (n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        more = tleReaderFeed(reader, chunk, n, matchRecord, &find);
+    }
+    if (more) tleReaderFinish(reader, matchRecord, &find);
+    fclose(in);
+    return find.found;
+}
+
+static bool addRecord(const TleRecord &rec, void *) {
+    catalogAdd(rec);
+    return catalogCount() < catalogCapacity();
+}
+
+static int textLoad(int capacity) {
+    FILE *in = fopen(TEXT_PATH, "rb");
+    if (!in) return 0;
+    static TleReader reader;
+    char chunk[512];
+    catalogBegin(capacity);
+    tleReaderInit(reader);
+    bool more = true;
+    size_t n;
+    while (more && (n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        more = tleReaderFeed(reader, chunk, n, addRecord, nullptr);
+    }
+    if (more) tleReaderFinish(reader, addRecord, nullptr);
+    fclose(in);
+    return catalogCount();
+}
+
+static void benchCatalogFile() {
+    const int records = 8000;
+    const int lookups = 200;
+    std::vector<TleRecord> recs;
+    buildRecords(recs, records);
+    FILE *out = fopen(TEXT_PATH, "wb");
+    if (!out) return;
+    for (const TleRecord &r : recs) fprintf(out, "%-24s\r\n%s\r\n%s\r\n", r.name, r.line1, r.line2);
+    long textBytes = ftell(out);
+    fclose(out);
+
+    double start = benchSeconds();
+    int built = catalogFileBuild(TEXT_PATH, BIN_PATH);
+    double buildS = benchSeconds() - start;
+    FILE *bin = fopen(BIN_PATH, "rb");
+    fseek(bin, 0, SEEK_END);
+    long binBytes = ftell(bin);
+    fclose(bin);
+    printf("\n-- compiled catalog: %d records, text %ld KB -> bin %ld KB, built in %.0f ms, fresh %s\n",
+           built, textBytes / 1024, binBytes / 1024, buildS * 1000,
+           catalogFileFresh(TEXT_PATH, BIN_PATH) ? "yes" : "no");
+
+    // Same pseudo-random NORAD numbers for both
+    int hits = 0;
+    start = benchSeconds();
+    for (int i = 0; i < lookups; i++) hits += textFind(10000 + (i * 7919) % records);
+    double textUs = (benchSeconds() - start) / lookups * 1e6;
+    TleRecord found;
+    int same = 0;
+    start = benchSeconds();
+    for (int i = 0; i < lookups; i++) {
+        int k = (i * 7919) % records;
+        if (catalogFileFind(TEXT_PATH, BIN_PATH, 10000 + k, found)) {
+            hits++;
+            same += strcmp(found.line1, recs[k].line1) == 0 && strcmp(found.line2, recs[k].line2) == 0;
+        }
+    }
+    double binUs = (benchSeconds() - start) / lookups * 1e6;
+    printf("%-26s %12s %12s\n", "", "text", "compiled");
+    printf("%-26s %12.1f %12.1f   (%d/%d found, %d/%d TLEs identical)\n", "find by NORAD number, us", textUs,
+           binUs, hits, 2 * lookups, same, lookups);
+
+    // The packed records have to propagate exactly like the text
+    double when = recs[0].epochUnix + 86400;
+    static float textPos[CATALOG_MAX][3];
+    start = benchSeconds();
+    int textCount = textLoad(CATALOG_MAX);
+    double textLoadMs = (benchSeconds() - start) * 1000;
+    catalogPropagate(when);
+    for (int i = 0; i < textCount; i++) catalogPosition(i, textPos[i]);
+    start = benchSeconds();
+    int binCount = catalogFileLoad(BIN_PATH, CATALOG_MAX);
+    double binLoadMs = (benchSeconds() - start) * 1000;
+    catalogPropagate(when);
+    int differ = binCount != textCount;
+    for (int i = 0; i < binCount && !differ; i++) {
+        float r[3];
+        differ += !catalogPosition(i, r) || memcmp(r, textPos[i], sizeof(r)) != 0;
+    }
+    printf("%-26s %12.2f %12.2f   (%d / %d sats, positions %s)\n", "boot catalog fill, ms", textLoadMs, binLoadMs,
+           textCount, binCount, differ ? "DIFFER" : "identical");
+
+    catalogEnd();
+    remove(TEXT_PATH);
+    remove(BIN_PATH);
+}
+
+void benchCatalog() {
+    static const int SIZES[] = {10, 100, 300, 1000, 5000};
+    const long propsPerSize = 2000000;
+    const int ROWS = 5;
+    Observer obs = makeObserver(BENCH_SITES[0].lat, BENCH_SITES[0].lon, 0);
+
+    printf("\n-- one tick = propagate all + overhead list (site %s)\n", BENCH_SITES[0].name);
+    printf("%6s %10s %12s %12s %12s %8s %8s %10s\n",
+           "sats", "bytes/sat", "batch us", "batch sat/s", "single sat/s", "speedup", "up", "7d err m");
+
+    std::vector<TleRecord> recs;
+    std::vector<SatElements> els;
+    double sink = 0;
+    for (int size : SIZES) {
+        buildRecords(recs, size);
+        catalogBegin(size);
+        els.resize(size);
+        for (int i = 0; i < size; i++) {
+            catalogAdd(recs[i]);
+            loadElements(els[i], recs[i].name, recs[i].line1, recs[i].line2);
+        }
+        double t0 = els[0].epochUnix + 86400;
+        long ticks = propsPerSize / size;
+
+        // Batch
+        CatalogSighting top[ROWS];
+        long upTotal = 0;
+        double start = benchSeconds();
+        for (long k = 0; k < ticks; k++) {
+            int total;
+            catalogPropagate(t0 + k);
+            catalogOverhead(obs, 0, top, ROWS, total);
+            upTotal += total;
+        }
+        double batch = benchSeconds() - start;
+
+        // One SatElements at a time
+        start = benchSeconds();
+        for (long k = 0; k < ticks; k++) {
+            for (int i = 0; i < size; i++) {
+                LookAngles la = lookAngles(propagate<float>(els[i], t0 + k), obs);
+                sink += la.el;
+            }
+        }
+        double single = benchSeconds() - start;
+
+        printf("%6d %10zu %12.1f %12.0f %12.0f %7.2fx %8.1f %10.0f\n", size,
+               catalogBytes() / size, batch / ticks * 1e6, ticks * size / batch,
+               ticks * size / single, single / batch, (double)upTotal / ticks,
+               maxErrorKm(els, 7) * 1000);
+    }
+    catalogEnd();
+    printf("(SatElements is %zu bytes; deep-space objects are left out of the catalog)\n", sizeof(SatElements));
+    if (sink == 12345.678) printf("\n");  // Keep the loops from being optimised away
+
+    benchCatalogFile();
+}
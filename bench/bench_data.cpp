@@ -0,0 +1,38 @@
+#include "bench.h"
+
+// Fixed element sets so runs are comparable across commits.
+// Covers LEO (low/high inclination), an eccentric Molniya and a GEO.
+const char *const BENCH_TLES[] = {
+    "ISS (ZARYA)\n"
+    "1 25544U 98067A   24045.50000000  .00016717  00000-0  30159-3 0  9993\n"
+    "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.50377579432614\n",
+
+    "HST\n"
+    "1 20580U 90037B   24045.25000000  .00002541  00000-0  12587-3 0  9994\n"
+    "2 20580  28.4699 101.1256 0002587  63.4126 296.8531 15.27919846643183\n",
+
+    "AO-07\n"
+    "1 07530U 74089B   24045.75000000 -.00000031  00000-0  73917-4 0  9996\n"
+    "2 07530 101.9873  58.1492 0012229  70.3342 291.1094 12.53673616273615\n",
+
+    "NOAA 19\n"
+    "1 33591U 09005A   24045.10000000  .00000243  00000-0  15432-3 0  9998\n"
+    "2 33591  99.0963  98.5263 0013853 222.6510 137.3586 14.12932104776426\n",
+
+    "MOLNIYA 1-93\n"
+    "1 28163U 04005A   24045.60000000  .00000092  00000-0  00000+0 0  9990\n"
+    "2 28163  62.8130 190.4408 7145124 279.3012  13.6741  2.00616521145876\n",
+
+    "GOES 16\n"
+    "1 41866U 16071A   24045.40000000 -.00000247  00000-0  00000+0 0  9992\n"
+    "2 41866   0.0543  91.2356 0000843 187.8765 293.5874  1.00270521264314\n",
+};
+const int BENCH_TLE_COUNT = sizeof(BENCH_TLES) / sizeof(BENCH_TLES[0]);
+
+const BenchSite BENCH_SITES[] = {
+    {"Lafayette", 30.22, -92.02},   // Firmware default
+    {"Quito",     -0.18, -78.47},
+    {"Tromso",    69.65,  18.96},
+    {"Hobart",   -42.88, 147.33},
+};
+const int BENCH_SITE_COUNT = sizeof(BENCH_SITES) / sizeof(BENCH_SITES[0]);
@@ -0,0 +1,244 @@
+#include <Arduino.h>
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <thread>
+
+#include "bench.h"
+#include "config.h"
+#include "gps.h"
+#include "nmea.h"
+
+// --- GPS INGEST ---
+// A recorded-style log: a minute of a 1 Hz receiver (GGA, GSA, three GSV,
+// RMC, VTG each second) with a few corrupted and cut-short sentences mixed
+// in. First the reader alone, fed in odd-sized chunks. Then the log
+// replayed at 10x to 10000x wire speed through gpsFeed(),
+// the ring and the parser thread, counting what arrived. Last, the old
+// path, where loop() drained a 256-byte UART buffer between its own
+// stalls, on a simulated clock next to the ingest task.
+
+#define LOG_SECONDS   60
+#define LOG_MAX       (LOG_SECONDS * 700)
+#define CORRUPT_EVERY 50       // Sentence n: a character changed after the checksum
+#define CUT_EVERY     211      // Sentence n: loses its second half and line end
+#define BYTE_US       86.8     // 10 bits at 115200 baud
+
+struct BenchLog {
+    char text[LOG_MAX];
+    size_t len;
+    size_t secondAt[LOG_SECONDS + 1];  // Where each second's burst starts
+    int sentences, corrupted, cut;
+    double lastLat, lastLon;
+    int lastSecond;
+};
+
+static BenchLog benchLog;
+
+static void coord(char *out, size_t size, double deg, char pos, char neg, bool isLat) {
+    char hemi = deg < 0 ? neg : pos;
+    deg = fabs(deg);
+    int whole = (int)deg;
+    snprintf(out, size, isLat ? "%02d%08.5f,%c" : "%03d%08.5f,%c", whole, (deg - whole) * 60, hemi);
+}
+
+static void addSentence(BenchLog &log, char *s, bool isLocation, double lat, double lon, int second) {
+    size_t n = nmeaFinish(s, 128);
+    int index = ++log.sentences;
+    if (index % CUT_EVERY == 0) {
+        n /= 2;
+        log.cut++;
+    } else if (index % CORRUPT_EVERY == 0) {
+        s[7] = s[7] == '1' ? '2' : '1';
+        log.corrupted++;
+    } else if (isLocation) {
+        log.lastLat = lat;
+        log.lastLon = lon;
+        log.lastSecond = second;
+    }
+    memcpy(log.text + log.len, s, n);
+    log.len += n;
+}
+
+static void buildLog(BenchLog &log) {
+    memset(&log, 0, sizeof(log));
+    for (int sec = 0; sec < LOG_SECONDS; sec++) {
+        log.secondAt[sec] = log.len;
+        double lat = 30.22410 + sec * 2e-6, lon = -92.01980 - sec * 3e-6;
+        char la[24], lo[24], t[16], s[128];
+        coord(la, sizeof(la), lat, 'N', 'S', true);
+        coord(lo, sizeof(lo), lon, 'E', 'W', false);
+        snprintf(t, sizeof(t), "12%02d%02d.00", sec / 60, sec % 60);
+
+        snprintf(s, sizeof(s), "$GPGGA,%s,%s,%s,1,09,0.9,12.%d,M,-26.3,M,,", t, la, lo, sec % 10);
+        addSentence(log, s, true, lat, lon, sec);
+        snprintf(s, sizeof(s), "$GPGSA,A,3,04,05,09,12,17,20,24,25,29,,,,1.8,0.9,1.5");
+        addSentence(log, s, false, 0, 0, sec);
+        for (int g = 1; g <= 3; g++) {
+            snprintf(s, sizeof(s), "$GPGSV,3,%d,11,%02d,71,040,42,%02d,55,300,40,%02d,32,120,37,%02d,12,210,30",
+                     g, g * 4, g * 4 + 1, g * 4 + 2, g * 4 + 3);
+            addSentence(log, s, false, 0, 0, sec);
+        }
+        snprintf(s, sizeof(s), "$GPRMC,%s,A,%s,%s,0.02,31.66,140326,,,A", t, la, lo);
+        addSentence(log, s, true, lat, lon, sec);
+        snprintf(s, sizeof(s), "$GPVTG,31.66,T,,M,0.02,N,0.04,K,A");
+        addSentence(log, s, false, 0, 0, sec);
+    }
+    log.secondAt[LOG_SECONDS] = log.len;
+}
+
+static bool check(const char *what, long got, long want) {
+    printf("  %-32s %6ld (want %ld)%s\n", what, got, want, got == want ? "" : "  MISMATCH");
+    return got == want;
+}
+
+// --- READER ---
+static void readerChecks(const BenchLog &log) {
+    NmeaReader r;
+    NmeaFix fix = {};
+    nmeaReaderInit(r);
+    uint32_t seed = 99;
+    for (size_t at = 0; at < log.len;) {
+        seed = seed * 1664525 + 1013904223;
+        size_t n = 1 + (seed >> 8) % 97;
+        if (n > log.len - at) n = log.len - at;
+        nmeaReaderFeed(r, log.text + at, n, fix);
+        at += n;
+    }
+    printf("Reader, %zu-byte log fed in 1-97 byte chunks:\n", log.len);
+    check("good sentences", r.sentences, log.sentences - log.corrupted - log.cut);
+    check("bad checksums", r.badChecksums, log.corrupted);
+    check("bad lines (cut short)", r.badLines, log.cut);
+    check("last second of time", fix.second, log.lastSecond % 60);
+    printf("  last position error: %.1e / %.1e deg\n", fabs(fix.lat - log.lastLat), fabs(fix.lon - log.lastLon));
+
+    const int N = 200;
+    double t0 = benchSeconds();
+    for (int i = 0; i < N; i++) {
+        nmeaReaderInit(r);
+        nmeaReaderFeed(r, log.text, log.len, fix);
+    }
+    double secs = (benchSeconds() - t0) / N;
+    printf("  %.1f MB/s, %.0f ns per sentence\n", log.len / secs / 1e6, secs / log.sentences * 1e9);
+}
+
+// --- THREADED REPLAY ---
+static std::atomic<int> wakes(0);
+
+static void countWake() {
+    wakes++;
+}
+
+// Sends each second's burst at `speed` times wire speed, 64 bytes at a time
+static void replay(const BenchLog &log, double speed) {
+    gpsBegin(countWake);
+    wakes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int sec = 0; sec < LOG_SECONDS; sec++) {
+        for (size_t at = log.secondAt[sec]; at < log.secondAt[sec + 1]; at += 64) {
+            size_t n = log.secondAt[sec + 1] - at;
+            if (n > 64) n = 64;
+            double us = (sec * 1e6 + (at - log.secondAt[sec] + n) * BYTE_US) / speed;
+            std::this_thread::sleep_until(start + std::chrono::microseconds((long)us));
+            gpsFeed((const uint8_t *)log.text + at, n);
+        }
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Let the parser catch up before reading the counters
+    unsigned long want = log.sentences - log.corrupted - log.cut;
+    double t0 = benchSeconds();
+    GpsStats st;
+    do {
+        gpsPoll();
+        st = gpsStats();
+    } while (st.sentences + st.badChecksums + st.badLines < (unsigned long)log.sentences &&
+             benchSeconds() - t0 < 0.2);
+    gpsStop();
+
+    char name[16];
+    snprintf(name, sizeof(name), "%gx", speed);
+    printf("%-9s %8.3f %9lu/%-5lu %5lu %5lu %8lu %6zu %6d\n", name, wall, st.sentences, want,
+           st.badChecksums, st.badLines, st.ringDropped, st.ringPeak, wakes.load());
+}
+
+// --- STALLS: LOOP DRAIN VS INGEST TASK ---
+// Bytes reach the UART buffer at wire speed. The old loop() emptied a
+// 256-byte buffer once per pass, so a pass that took longer than ~22 ms
+// of burst lost the rest of it. The ingest task empties the FIFO into the
+// ring every 120 bytes; its parser may be held off by higher-priority work
+// for a few ms, never by loop().
+#define UART_RX_DEFAULT 256
+#define FIFO_CHUNK      120
+#define PARSER_HOLD_US  5000
+
+struct Stall {
+    double atUs, forUs;
+    const char *what;
+};
+
+static const Stall STALLS[] = {
+    {10.2e6, 700e3, "screenshot to SD"},
+    {30.0e6, 8e6, "typing a latitude"},
+    {45.9e6, 120e3, "saving a TLE"},
+};
+
+// When loop() next gets to drain, if it's busy at `us`
+static double loopFreeAt(double us) {
+    for (const Stall &s : STALLS) {
+        if (us >= s.atUs && us < s.atUs + s.forUs) return s.atUs + s.forUs;
+    }
+    return us;
+}
+
+static void stallModel(const BenchLog &log, bool task) {
+    NmeaReader r;
+    NmeaFix fix = {};
+    nmeaReaderInit(r);
+    size_t buffered = 0, lost = 0, peak = 0;
+    size_t capacity = task ? GPS_UART_BUFFER + GPS_RING_SIZE : UART_RX_DEFAULT;
+    double drainAt = 0;
+    char kept[LOG_MAX];
+    size_t keptLen = 0;
+
+    for (int sec = 0; sec < LOG_SECONDS; sec++) {
+        for (size_t at = log.secondAt[sec]; at < log.secondAt[sec + 1]; at++) {
+            double us = sec * 1e6 + (at - log.secondAt[sec] + 1) * BYTE_US;
+            if (us >= drainAt) {
+                buffered = 0;
+                // Old: a 20 ms pass, unless a stall holds it. New: every FIFO chunk.
+                drainAt = task ? us + FIFO_CHUNK * BYTE_US + PARSER_HOLD_US : loopFreeAt(us) + 20000;
+            }
+            if (buffered == capacity) {
+                lost++;
+                continue;
+            }
+            buffered++;
+            if (buffered > peak) peak = buffered;
+            kept[keptLen++] = log.text[at];
+        }
+    }
+    nmeaReaderFeed(r, kept, keptLen, fix);
+    long want = log.sentences - log.corrupted - log.cut;
+    printf("%-22s %9lu %6ld %10zu %6zu\n", task ? "ingest task + ring" : "loop() drains 256 B", r.sentences,
+           want - (long)r.sentences, lost, peak);
+}
+
+void benchGps() {
+    buildLog(benchLog);
+    readerChecks(benchLog);
+
+    printf("\nReplay of %d s through gpsFeed() -> ring -> parser thread\n", LOG_SECONDS);
+    printf("%-9s %8s %15s %5s %5s %8s %6s %6s\n", "speed", "feed s", "sentences", "badck", "cut", "dropped",
+           "peak", "wakes");
+    replay(benchLog, 10);
+    replay(benchLog, 100);
+    replay(benchLog, 1000);
+    replay(benchLog, 10000);
+
+    printf("\nSame log with loop() stalls:");
+    for (const Stall &s : STALLS) printf(" %s %.0f ms;", s.what, s.forUs / 1000);
+    printf("\n%-22s %9s %6s %10s %6s\n", "", "sentences", "lost", "bytes lost", "peak");
+    stallModel(benchLog, false);
+    stallModel(benchLog, true);
+}
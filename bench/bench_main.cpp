@@ -0,0 +1,161 @@
+#include <Arduino.h>
+#include <malloc.h>
+#include <chrono>
+#include <new>
+
+#include "bench.h"
+#include "config.h"
+#include "orbit.h"
+
+// Globals normally owned by main.cpp
+double obsLatDeg = 30.22;
+double obsLonDeg = -92.02;
+int tzOffsetHours = 0;
+int minElevation = DEFAULT_MIN_EL;
+int passHorizonDays = DEFAULT_PASS_DAYS;
+bool tleParsedOK = false;
+bool useGpsModule = false;
+String satName = "";
+
+// --- HEAP ACCOUNTING ---
+// The native env links with -Wl,--wrap=malloc etc. so every String and
+// operator new allocation made by the code under test lands here.
+static BenchHeap heapStats = {0, 0, 0};
+
+extern "C" {
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t n, size_t s);
+void *__real_realloc(void *p, size_t n);
+void __real_free(void *p);
+
+void *__wrap_malloc(size_t n) {
+    void *p = __real_malloc(n);
+    if (p) {
+        heapStats.allocs++;
+        heapStats.live += malloc_usable_size(p);
+        if (heapStats.live > heapStats.peak) heapStats.peak = heapStats.live;
+    }
+    return p;
+}
+
+void *__wrap_calloc(size_t n, size_t s) {
+    void *p = __real_calloc(n, s);
+    if (p) {
+        heapStats.allocs++;
+        heapStats.live += malloc_usable_size(p);
+        if (heapStats.live > heapStats.peak) heapStats.peak = heapStats.live;
+    }
+    return p;
+}
+
+void *__wrap_realloc(void *p, size_t n) {
+    size_t old = p ? malloc_usable_size(p) : 0;
+    void *q = __real_realloc(p, n);
+    if (q) {
+        heapStats.allocs++;
+        heapStats.live = heapStats.live - old + malloc_usable_size(q);
+        if (heapStats.live > heapStats.peak) heapStats.peak = heapStats.live;
+    }
+    return q;
+}
+
+void __wrap_free(void *p) {
+    if (p) heapStats.live -= malloc_usable_size(p);
+    __real_free(p);
+}
+}
+
+void *operator new(size_t n) {
+    void *p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+BenchHeap benchHeap() { return heapStats; }
+void benchResetPeak() { heapStats.peak = heapStats.live; }
+
+double benchSeconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool benchLoadTLE(int index) {
+    setupOrbitLocation(obsLatDeg, obsLonDeg);
+    TleRecord rec;
+    if (!tleParseText(BENCH_TLES[index], strlen(BENCH_TLES[index]), rec)) return false;
+    return loadTLERecord(rec);
+}
+
+bool benchLoadElements(int index, SatElements &el) {
+    TleRecord rec;
+    if (!tleParseText(BENCH_TLES[index], strlen(BENCH_TLES[index]), rec)) return false;
+    return loadElements(el, rec.name, rec.line1, rec.line2);
+}
+
+void benchFixChecksum(char *line) {
+    int sum = 0;
+    for (int i = 0; i < TLE_LINE_LEN - 1; i++) {
+        if (line[i] >= '0' && line[i] <= '9') sum += line[i] - '0';
+        else if (line[i] == '-') sum += 1;
+    }
+    line[TLE_LINE_LEN - 1] = '0' + sum % 10;
+}
+
+char *benchBuildGroupFile(int records, size_t &len) {
+    size_t cap = records * 170;
+    char *text = (char *)malloc(cap);
+    len = 0;
+    for (int i = 0; i < records; i++) {
+        TleRecord rec;
+        const char *src = BENCH_TLES[i % BENCH_TLE_COUNT];
+        tleParseText(src, strlen(src), rec);
+
+        char num[6];
+        snprintf(num, sizeof(num), "%05d", 10000 + i % 90000);
+        memcpy(rec.line1 + 2, num, 5);
+        memcpy(rec.line2 + 2, num, 5);
+        benchFixChecksum(rec.line1);
+        benchFixChecksum(rec.line2);
+        len += snprintf(text + len, cap - len, "%-24s\r\n%s\r\n%s\r\n", rec.name, rec.line1, rec.line2);
+    }
+    return text;
+}
+
+struct BenchSuite {
+    const char *name;
+    void (*run)();
+};
+
+static const BenchSuite SUITES[] = {
+    {"orbit", benchOrbit},
+    {"precision", benchPrecision},
+    {"tle", benchTle},
+    {"task",  benchTask},
+    {"catalog", benchCatalog},
+    {"net", benchNet},
+    {"perf", benchPerf},
+    {"sched", benchSched},
+    {"alert", benchAlert},
+    {"gps", benchGps},
+    {"timesync", benchTimeSync},
+    {"screenshot", benchScreenshot},
+};
+
+int main(int argc, char **argv) {
+    printf("cardputer-iss-tracker host bench (%s)\n", APP_VERSION);
+    for (const BenchSuite &s : SUITES) {
+        bool selected = (argc < 2);
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], s.name) == 0) selected = true;
+        }
+        if (!selected) continue;
+        printf("\n=== %s ===\n", s.name);
+        s.run();
+    }
+    return 0;
+}
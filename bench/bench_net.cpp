@@ -0,0 +1,713 @@
+#include <Arduino.h>
+#include <arpa/inet.h>
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "bench.h"
+#include "net.h"
+#include "tle_download.h"
+#include "tle_refresh.h"
+#include "tle_reader.h"
+
+// --- NETWORK STATE MACHINE ---
+// Drives net.cpp the way loop() does (netPoll() every 20 ms) against a fake
+// radio and a stub HTTP server on 127.0.0.1. What matters is the worst
+// single netPoll(): the old code held the loop for the whole
+// connect + NTP + download.
+//
+// Then multi-megabyte group files streamed to a file through tle_download,
+// against buffering the whole body first as HTTPClient::getString() did,
+// and one trickled out over longer than the download timeout.
+//
+// Last, the conditional refresh (tle_refresh) over a run of reboots, with
+// the stub counting connections, requests and 200 / 304 answers.
+
+// --- FAKE RADIO ---
+static const unsigned long FAKE_CONNECT_MS = 300;
+static const unsigned long FAKE_NTP_MS = 150;
+static const unsigned long FAKE_SCAN_MS = 400;
+static const int FAKE_SCAN_FOUND = 6;
+
+static bool fakeWifiFails = false;
+static unsigned long fakeWifiAt = 0, fakeTimeAt = 0, fakeScanAt = 0;
+static bool fakeWifiOn = false;
+
+static void fakeWifiBegin(const char *, const char *) {
+    fakeWifiOn = true;
+    fakeWifiAt = millis();
+}
+
+static NetLink fakeWifiStatus() {
+    if (millis() - fakeWifiAt < FAKE_CONNECT_MS) return NET_LINK_CONNECTING;
+    return fakeWifiFails ? NET_LINK_FAILED : NET_LINK_UP;
+}
+
+static void fakeWifiOff() { fakeWifiOn = false; }
+
+static bool fakeScanStart() {
+    fakeWifiOn = true;
+    fakeScanAt = millis();
+    return true;
+}
+
+static int fakeScanDone() {
+    return millis() - fakeScanAt < FAKE_SCAN_MS ? NET_SCAN_RUNNING : FAKE_SCAN_FOUND;
+}
+
+static void fakeTimeStart(long) { fakeTimeAt = millis(); }
+
+// SNTP only gets an answer once the link is up
+static bool fakeTimeSynced() {
+    return millis() - fakeTimeAt >= FAKE_CONNECT_MS + FAKE_NTP_MS;
+}
+
+// --- SOCKET HTTP CLIENT ---
+// Non-blocking HTTP/1.1 over one kept-alive connection, enough for the
+// stub: at most one recv() per poll, the body ends at Content-Length (or
+// when the server closes).
+static int httpFd = -1;
+static int httpPort = 0;
+static bool httpSent = false, httpHeadersDone = false, httpServerCloses = false;
+static int httpCode = 0;
+static long httpLength = -1, httpBodyRead = 0;
+static char httpRequest[NET_URL_MAX + 192];
+static char httpHead[512];
+static size_t httpHeadLen = 0;
+static char httpEtagValue[48], httpLastModifiedValue[32];
+static NetSinkFn httpSink = nullptr;
+static void *httpCtx = nullptr;
+static bool clientNoReuse = false;   // The old way: a connection per request, no validators
+
+static bool socketConnect(int port) {
+    httpFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (httpFd < 0) return false;
+    fcntl(httpFd, F_SETFL, fcntl(httpFd, F_GETFL) | O_NONBLOCK);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(httpFd, (sockaddr *)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) return false;
+    httpPort = port;
+    return true;
+}
+
+static bool socketHttpStart(const char *url, const char *etag, const char *lastModified,
+                            NetSinkFn sink, void *ctx) {
+    int port = 0;
+    char path[NET_URL_MAX];
+    if (sscanf(url, "http://127.0.0.1:%d%159s", &port, path) != 2) return false;
+    if (httpFd >= 0 && port != httpPort) {
+        close(httpFd);
+        httpFd = -1;
+    }
+    if (httpFd < 0 && !socketConnect(port)) return false;
+
+    int n = snprintf(httpRequest, sizeof(httpRequest), "GET %s HTTP/1.1\r\nHost: 127.0.0.1\r\n", path);
+    if (etag && etag[0] && !clientNoReuse) {
+        n += snprintf(httpRequest + n, sizeof(httpRequest) - n, "If-None-Match: %s\r\n", etag);
+    }
+    if (lastModified && lastModified[0] && !clientNoReuse) {
+        n += snprintf(httpRequest + n, sizeof(httpRequest) - n, "If-Modified-Since: %s\r\n", lastModified);
+    }
+    snprintf(httpRequest + n, sizeof(httpRequest) - n, "\r\n");
+
+    httpSent = httpHeadersDone = httpServerCloses = false;
+    httpCode = 0;
+    httpLength = -1;
+    httpBodyRead = 0;
+    httpHeadLen = 0;
+    httpEtagValue[0] = httpLastModifiedValue[0] = 0;
+    httpSink = sink;
+    httpCtx = ctx;
+    return true;
+}
+
+static void headerValue(const char *name, char *dst, size_t size) {
+    const char *p = strcasestr(httpHead, name);
+    if (!p) return;
+    p += strlen(name);
+    size_t n = strcspn(p, "\r\n");
+    if (n >= size) n = size - 1;
+    memcpy(dst, p, n);
+    dst[n] = 0;
+}
+
+// Splits the status line and headers off the front of the stream
+static bool takeHeaders(const char *data, size_t n, size_t &used) {
+    used = 0;
+    while (used < n && !httpHeadersDone) {
+        if (httpHeadLen >= sizeof(httpHead) - 1) return false;
+        httpHead[httpHeadLen++] = data[used++];
+        httpHead[httpHeadLen] = 0;
+        if (httpHeadLen >= 4 && strcmp(httpHead + httpHeadLen - 4, "\r\n\r\n") == 0) {
+            httpHeadersDone = true;
+            if (sscanf(httpHead, "HTTP/%*d.%*d %d", &httpCode) != 1) return false;
+            char value[16] = "";
+            headerValue("\r\nContent-Length: ", value, sizeof(value));
+            if (value[0]) httpLength = atol(value);
+            if (httpCode == 304) httpLength = 0;
+            httpServerCloses = strcasestr(httpHead, "\r\nConnection: close") != nullptr;
+            headerValue("\r\nETag: ", httpEtagValue, sizeof(httpEtagValue));
+            headerValue("\r\nLast-Modified: ", httpLastModifiedValue, sizeof(httpLastModifiedValue));
+        }
+    }
+    return true;
+}
+
+static NetHttp socketHttpPoll() {
+    if (!httpSent) {
+        ssize_t n = send(httpFd, httpRequest, strlen(httpRequest), MSG_NOSIGNAL);
+        if (n < 0) return (errno == EAGAIN || errno == ENOTCONN) ? NET_HTTP_PENDING : NET_HTTP_ERROR;
+        httpSent = true;  // Short enough to go in one send
+        return NET_HTTP_PENDING;
+    }
+
+    char buf[512];   // esp_http_client's default buffer
+    ssize_t n = recv(httpFd, buf, sizeof(buf), 0);
+    if (n < 0) return errno == EAGAIN ? NET_HTTP_PENDING : NET_HTTP_ERROR;
+    if (n == 0) return (httpHeadersDone && httpLength < 0) ? NET_HTTP_DONE : NET_HTTP_ERROR;
+
+    size_t used;
+    if (!takeHeaders(buf, n, used)) return NET_HTTP_ERROR;
+    size_t body = n - used;
+    if (httpLength >= 0 && httpBodyRead + (long)body > httpLength) body = httpLength - httpBodyRead;
+    if (body > 0 && !httpSink(buf + used, body, httpCtx)) return NET_HTTP_ERROR;
+    httpBodyRead += body;
+    if (httpHeadersDone && httpLength >= 0 && httpBodyRead == httpLength) return NET_HTTP_DONE;
+    return NET_HTTP_PENDING;
+}
+
+static int socketHttpStatus() { return httpCode; }
+static const char *socketHttpEtag() { return httpEtagValue; }
+static const char *socketHttpLastModified() { return httpLastModifiedValue; }
+
+static void socketHttpEnd(bool keepAlive) {
+    if (keepAlive && !httpServerCloses && !clientNoReuse) return;
+    if (httpFd >= 0) close(httpFd);
+    httpFd = -1;
+}
+
+static const NetDriver BENCH_DRIVER = {
+    fakeWifiBegin, fakeWifiStatus, fakeWifiOff,
+    fakeScanStart, fakeScanDone,
+    fakeTimeStart, fakeTimeSynced,
+    socketHttpStart, socketHttpPoll, socketHttpStatus,
+    socketHttpEtag, socketHttpLastModified, socketHttpEnd,
+};
+
+// --- STUB SERVER ---
+// Closes after each of these:
+// /ok      200 with a TLE
+// /drip    200, the same TLE 16 bytes at a time
+// /missing 404
+// /garbage 200 with an HTML error page
+// /group   200 with `groupText`
+// /slowgroup 200 with `groupText` at SLOW_GROUP_BPS, longer than NET_HTTP_TIMEOUT_MS
+// Keeps the connection open after these, as CelesTrak does:
+// /gp.php?CATNR=n  200 with bench TLE n at `stubEpoch`, or 304 if the
+//                  client's If-None-Match is the current version
+static std::atomic<bool> serverRun(false);
+static const long SLOW_GROUP_BPS = 6000;
+static const char *groupText = nullptr;
+static size_t groupLen = 0;
+static int serverFd = -1;
+
+static int stubVersion = 1;
+static double stubEpoch = 0;
+static std::atomic<int> stubConnections(0), stubRequests(0), stubOk(0), stubNotModified(0);
+static std::atomic<long> stubBodyBytes(0);
+
+static void sendAll(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        data += n;
+        len -= n;
+    }
+}
+
+// Writes the YYDDD.DDDDDDDD epoch field of line 1
+static void setEpoch(char *line1, double unixTime) {
+    time_t t = (time_t)unixTime;
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    double day = tm.tm_yday + 1 + (tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec + (unixTime - t)) / 86400.0;
+    char field[16];
+    snprintf(field, sizeof(field), "%02d%012.8f", tm.tm_year % 100, day);
+    memcpy(line1 + 18, field, 14);
+    benchFixChecksum(line1);
+}
+
+// Bench TLE `catnr` at the stub's current epoch
+static int stubTle(long catnr, char *out, size_t size) {
+    for (int i = 0; i < BENCH_TLE_COUNT; i++) {
+        TleRecord rec;
+        if (!tleParseText(BENCH_TLES[i], strlen(BENCH_TLES[i]), rec) || rec.catalogNumber != catnr) continue;
+        setEpoch(rec.line1, stubEpoch);
+        return snprintf(out, size, "%-24s\r\n%s\r\n%s\r\n", rec.name, rec.line1, rec.line2);
+    }
+    return -1;
+}
+
+static void serveTle(int fd, long catnr, const char *req) {
+    char etag[32], head[256], body[256];
+    snprintf(etag, sizeof(etag), "\"%ld-v%d\"", catnr, stubVersion);
+    stubRequests++;
+
+    const char *inm = strcasestr(req, "\r\nIf-None-Match: ");
+    if (inm && strncmp(inm + 17, etag, strlen(etag)) == 0) {
+        snprintf(head, sizeof(head), "HTTP/1.1 304 Not Modified\r\nETag: %s\r\n\r\n", etag);
+        sendAll(fd, head, strlen(head));
+        stubNotModified++;
+        return;
+    }
+    int len = stubTle(catnr, body, sizeof(body));
+    if (len < 0) {
+        const char *nf = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+        sendAll(fd, nf, strlen(nf));
+        return;
+    }
+    snprintf(head, sizeof(head),
+             "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: %d\r\n"
+             "ETag: %s\r\nLast-Modified: Mon, 0%d Jan 2024 00:00:00 GMT\r\n\r\n",
+             len, etag, stubVersion);
+    sendAll(fd, head, strlen(head));
+    sendAll(fd, body, len);
+    stubOk++;
+    stubBodyBytes += len;
+}
+
+// Returns false once the connection should close
+static bool serveOne(int fd) {
+    char req[512];
+    size_t len = 0;
+    while (len < sizeof(req) - 1) {
+        ssize_t n = recv(fd, req + len, sizeof(req) - 1 - len, 0);
+        if (n <= 0) return false;
+        len += n;
+        req[len] = 0;
+        if (strstr(req, "\r\n\r\n")) break;
+    }
+    char path[64] = "";
+    sscanf(req, "GET %63s", path);
+
+    long catnr;
+    if (sscanf(path, "/gp.php?CATNR=%ld", &catnr) == 1) {
+        serveTle(fd, catnr, req);
+        return true;
+    }
+
+    const char *ok = "HTTP/1.0 200 OK\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\n";
+    if (strcmp(path, "/ok") == 0) {
+        sendAll(fd, ok, strlen(ok));
+        sendAll(fd, BENCH_TLES[0], strlen(BENCH_TLES[0]));
+    } else if (strcmp(path, "/drip") == 0) {
+        sendAll(fd, ok, strlen(ok));
+        const char *body = BENCH_TLES[0];
+        for (size_t i = 0, len = strlen(body); i < len; i += 16) {
+            sendAll(fd, body + i, len - i < 16 ? len - i : 16);
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        }
+    } else if (strcmp(path, "/group") == 0 && groupText) {
+        sendAll(fd, ok, strlen(ok));
+        sendAll(fd, groupText, groupLen);
+    } else if (strcmp(path, "/slowgroup") == 0 && groupText) {
+        sendAll(fd, ok, strlen(ok));
+        const size_t slice = SLOW_GROUP_BPS / 10;
+        for (size_t i = 0; i < groupLen && serverRun; i += slice) {
+            sendAll(fd, groupText + i, groupLen - i < slice ? groupLen - i : slice);
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    } else if (strcmp(path, "/garbage") == 0) {
+        sendAll(fd, ok, strlen(ok));
+        const char *page = "<html><body>No GP data found</body></html>\n";
+        sendAll(fd, page, strlen(page));
+    } else {
+        const char *nf = "HTTP/1.0 404 Not Found\r\nConnection: close\r\n\r\n";
+        sendAll(fd, nf, strlen(nf));
+    }
+    return false;
+}
+
+static void serverLoop() {
+    while (serverRun) {
+        int fd = accept(serverFd, nullptr, nullptr);
+        if (fd < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        stubConnections++;
+        timeval tv = {1, 0};   // So a stop isn't stuck behind an idle client
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        while (serverRun && serveOne(fd)) {}
+        close(fd);
+    }
+}
+
+// Returns the port, 0 on failure
+static int serverStart(std::thread &t) {
+    serverFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (serverFd < 0) return 0;
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(serverFd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(serverFd, 4) < 0 ||
+        getsockname(serverFd, (sockaddr *)&addr, &len) < 0) {
+        close(serverFd);
+        return 0;
+    }
+    fcntl(serverFd, F_SETFL, fcntl(serverFd, F_GETFL) | O_NONBLOCK);
+    serverRun = true;
+    t = std::thread(serverLoop);
+    return ntohs(addr.sin_port);
+}
+
+static void serverStop(std::thread &t) {
+    serverRun = false;
+    t.join();
+    close(serverFd);
+}
+
+// --- SCENARIOS ---
+static char body[1024];
+static size_t bodyLen = 0;
+
+static bool collect(const char *data, size_t len, void *) {
+    if (len > sizeof(body) - 1 - bodyLen) len = sizeof(body) - 1 - bodyLen;
+    memcpy(body + bodyLen, data, len);
+    bodyLen += len;
+    return true;
+}
+
+static const char *EVENT_CODES = "-SCTDF";   // Indexed by NetEvent
+
+// A session with a single request
+struct OneGet {
+    char url[NET_URL_MAX];
+    NetSinkFn sink;
+    void *ctx;
+    bool given;
+};
+static OneGet oneGet;
+
+static bool oneNext(NetRequest &req, void *) {
+    if (oneGet.given) return false;
+    oneGet.given = true;
+    strcpy(req.url, oneGet.url);
+    req.sink = oneGet.sink;
+    req.ctx = oneGet.ctx;
+    return true;
+}
+
+static bool startOne(int port, const char *path, NetSinkFn sink, void *ctx) {
+    snprintf(oneGet.url, sizeof(oneGet.url), "http://127.0.0.1:%d%s", port, path);
+    oneGet.sink = sink;
+    oneGet.ctx = ctx;
+    oneGet.given = false;
+    return netStartOnline("bench", "pw", 0, oneNext, nullptr, nullptr);
+}
+
+struct NetRun {
+    char events[16];
+    double ms;
+    double worstPollUs;
+    bool parsed;
+};
+
+// Polls like loop() until the job is over (or `limit` s pass)
+static NetRun pollUntilIdle(unsigned long pollMs = 20, double limit = 5) {
+    NetRun r = {"", 0, 0, false};
+    int e = 0;
+    double start = benchSeconds();
+    while (netBusy() && benchSeconds() - start < limit) {
+        double t0 = benchSeconds();
+        NetEvent ev = netPoll();
+        double us = (benchSeconds() - t0) * 1e6;
+        if (us > r.worstPollUs) r.worstPollUs = us;
+        if (ev != NET_EV_NONE && e < (int)sizeof(r.events) - 1) r.events[e++] = EVENT_CODES[ev];
+        delay(pollMs);
+    }
+    r.events[e] = 0;
+    r.ms = (benchSeconds() - start) * 1000;
+    return r;
+}
+
+static void runDownload(const char *label, int port, const char *path, bool wifiFails) {
+    fakeWifiFails = wifiFails;
+    bodyLen = 0;
+
+    if (!startOne(port, path, collect, nullptr)) {
+        printf("  %-10s could not start\n", label);
+        return;
+    }
+    NetRun r = pollUntilIdle();
+    body[bodyLen] = 0;
+    TleRecord rec;
+    r.parsed = bodyLen > 0 && tleParseText(body, bodyLen, rec);
+
+    const NetProgress &p = netProgress();
+    printf("  %-10s %-7s %7.0f ms  worst poll %6.1f us  %4u B  http %3d  %-8s %s\n",
+           label, r.events, r.ms, r.worstPollUs, (unsigned)p.bytes, p.httpStatus,
+           r.parsed ? "TLE ok" : "no TLE", p.error ? p.error : "");
+    if (fakeWifiOn) printf("  !! radio left on after %s\n", label);
+}
+
+// --- STREAMED GROUP DOWNLOADS ---
+static const char *TLE_PATH = "/tmp/iss_bench_download.tle";
+
+// The old way: the whole body in one growing heap buffer
+struct WholeBody {
+    char *data;
+    size_t len, cap;
+};
+
+static bool bufferAll(const char *data, size_t len, void *ctx) {
+    WholeBody *b = (WholeBody *)ctx;
+    if (b->len + len > b->cap) {
+        b->cap = (b->len + len) * 2;
+        b->data = (char *)realloc(b->data, b->cap);
+    }
+    memcpy(b->data + b->len, data, len);
+    b->len += len;
+    return true;
+}
+
+static bool fileMatches(const char *path, const char *text, size_t len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    bool same = true;
+    char buf[4096];
+    size_t off = 0, n;
+    while (same && (n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        same = off + n <= len && memcmp(buf, text + off, n) == 0;
+        off += n;
+    }
+    fclose(f);
+    return same && off == len;
+}
+
+// A group file on a slow link: it takes longer than NET_HTTP_TIMEOUT_MS
+// but data never stops coming, so it has to complete
+static void runSlowGroup(int port, int records) {
+    size_t len;
+    char *text = benchBuildGroupFile(records, len);
+    groupText = text;
+    groupLen = len;
+    long want = 10000 + records - 1;
+    fakeWifiFails = false;
+
+    static TleDownload d;
+    remove(TLE_PATH);
+    tleDownloadBegin(d, TLE_PATH, want);
+    startOne(port, "/slowgroup", tleDownloadSink, &d);
+    NetRun r = pollUntilIdle(20, 120);
+    TleRecord rec;
+    bool done = strchr(r.events, 'D') != nullptr;
+    bool ok = done && tleDownloadFinish(d, rec) && rec.catalogNumber == want;
+    if (!done) tleDownloadAbort(d);
+    const NetProgress &p = netProgress();
+    printf("  %-8s %6.2f MB %7.0f ms  at %ld B/s (timeout %d ms)  %-7s %s, file %s %s\n", "slow",
+           len / 1e6, r.ms, SLOW_GROUP_BPS, NET_HTTP_TIMEOUT_MS, r.events, ok ? "TLE ok" : "no TLE",
+           fileMatches(TLE_PATH, text, len) ? "identical" : "DIFFERS", p.error ? p.error : "");
+
+    groupText = nullptr;
+    free(text);
+    remove(TLE_PATH);
+}
+
+static void runGroup(int port, int records) {
+    size_t len;
+    char *text = benchBuildGroupFile(records, len);
+    groupText = text;
+    groupLen = len;
+    long want = 10000 + records - 1;   // The last one in the file
+    fakeWifiFails = false;
+
+    // Streamed to a file, parsed on the way
+    static TleDownload d;
+    remove(TLE_PATH);
+    benchResetPeak();
+    BenchHeap h0 = benchHeap();
+    tleDownloadBegin(d, TLE_PATH, want);
+    startOne(port, "/group", tleDownloadSink, &d);
+    NetRun r = pollUntilIdle(0, 60);
+    TleRecord rec;
+    bool ok = strchr(r.events, 'D') && tleDownloadFinish(d, rec) && rec.catalogNumber == want;
+    BenchHeap h1 = benchHeap();
+    printf("  %-8s %6.1f MB %7.0f ms  peak heap %9zu  worst poll %6.1f us  %s, file %s\n", "stream",
+           len / 1e6, r.ms, h1.peak - h0.live, r.worstPollUs, ok ? "TLE ok" : "no TLE",
+           fileMatches(TLE_PATH, text, len) ? "identical" : "DIFFERS");
+
+    // Whole body in RAM first
+    WholeBody b = {nullptr, 0, 0};
+    benchResetPeak();
+    h0 = benchHeap();
+    startOne(port, "/group", bufferAll, &b);
+    r = pollUntilIdle(0, 60);
+    ok = tleParseText(b.data, b.len, rec, want);
+    h1 = benchHeap();
+    printf("  %-8s %6.1f MB %7.0f ms  peak heap %9zu  worst poll %6.1f us  %s\n", "buffered",
+           len / 1e6, r.ms, h1.peak - h0.live, r.worstPollUs, ok ? "TLE ok" : "no TLE");
+    free(b.data);
+
+    groupText = nullptr;
+    free(text);
+}
+
+// An error page, then a cut-off transfer: the file from the last good
+// download must survive both
+static void runKeepsGoodFile(int port) {
+    static TleDownload d;
+    TleRecord rec;
+    size_t len;
+    char *text = benchBuildGroupFile(100, len);
+    fakeWifiFails = false;
+    FILE *f = fopen(TLE_PATH, "wb");
+    fwrite(text, 1, len, f);
+    fclose(f);
+
+    tleDownloadBegin(d, TLE_PATH, 0);
+    startOne(port, "/garbage", tleDownloadSink, &d);
+    pollUntilIdle(0);
+    bool pageReplaced = tleDownloadFinish(d, rec);
+
+    tleDownloadBegin(d, TLE_PATH, 0);
+    tleDownloadSink(text, len / 2, &d);  // Link drops half way: netPoll() fails
+    tleDownloadAbort(d);
+
+    printf("  error page %s, cut-off transfer dropped, file %s\n",
+           pageReplaced ? "REPLACED THE FILE" : "rejected",
+           fileMatches(TLE_PATH, text, len) ? "intact" : "DAMAGED");
+    free(text);
+    remove(TLE_PATH);
+}
+
+// --- CONDITIONAL REFRESH ---
+static const char *REFRESH_DIR = "/tmp/iss_bench_tle";
+static long refreshIds[16];   // BENCH_TLE_COUNT of them
+static int refreshUpdated = 0;
+
+static double refreshNow = 0;
+
+static void countUpdated(const TleRecord &) { refreshUpdated++; }
+static double refreshClock() { return refreshNow; }
+
+static void clearRefreshDir() {
+    char path[96];
+    for (int i = 0; i < BENCH_TLE_COUNT; i++) {
+        snprintf(path, sizeof(path), "%s/%ld.tle", REFRESH_DIR, refreshIds[i]);
+        remove(path);
+    }
+    snprintf(path, sizeof(path), "%s/validators.bin", REFRESH_DIR);
+    remove(path);
+}
+
+// One boot's (or one Force Update's) refresh session
+static void runRefresh(const char *label, const long *ids, int count, bool force) {
+    int c0 = stubConnections, q0 = stubRequests, ok0 = stubOk, nm0 = stubNotModified;
+    long b0 = stubBodyBytes;
+    refreshUpdated = 0;
+    tleRefreshSet(ids, count, force);
+    NetRun r = {"", 0, 0, false};
+    if (tleRefreshStart("bench", "pw", 0)) r = pollUntilIdle();
+    printf("  %-22s %4d %5d %5d %5d %7ld %7.0f %4d\n", label, (int)stubConnections - c0,
+           (int)stubRequests - q0, (int)stubOk - ok0, (int)stubNotModified - nm0,
+           (long)stubBodyBytes - b0, r.ms, refreshUpdated);
+}
+
+static void benchRefresh(int port) {
+    static char urlFormat[64];
+    snprintf(urlFormat, sizeof(urlFormat), "http://127.0.0.1:%d/gp.php?CATNR=%%ld", port);
+    for (int i = 0; i < BENCH_TLE_COUNT; i++) {
+        TleRecord rec;
+        tleParseText(BENCH_TLES[i], strlen(BENCH_TLES[i]), rec);
+        refreshIds[i] = rec.catalogNumber;
+        printf("%s%s %.0fh", i ? ", " : "", rec.name, tleMaxAgeSec(rec) / 3600.0);
+    }
+    printf("  (max element age)\n");
+
+    mkdir(REFRESH_DIR, 0755);
+    clearRefreshDir();
+    tleRefreshBegin(REFRESH_DIR, urlFormat, countUpdated, refreshClock);
+    fakeWifiFails = false;
+    double t0 = (double)time(nullptr);
+    refreshNow = t0;
+    stubVersion = 1;
+    stubEpoch = t0 - 86400.0;   // The newest elements the server has
+
+    printf("%-24s %4s %5s %5s %5s %7s %7s %4s\n", "", "conn", "reqs", "200", "304", "bytes", "ms", "new");
+    clientNoReuse = true;
+    runRefresh("unconditional (old)", refreshIds, BENCH_TLE_COUNT, true);
+    clientNoReuse = false;
+    clearRefreshDir();
+    tleRefreshBegin(REFRESH_DIR, urlFormat, countUpdated, refreshClock);
+
+    runRefresh("first boot", refreshIds, BENCH_TLE_COUNT, false);
+    refreshNow = t0 + 2 * 3600;
+    runRefresh("reboot +2 h", refreshIds, BENCH_TLE_COUNT, false);
+    refreshNow = t0 + 1.5 * 86400;
+    runRefresh("reboot +1.5 d", refreshIds, BENCH_TLE_COUNT, false);
+    refreshNow += 3600;
+    runRefresh("reboot +1 h", refreshIds, BENCH_TLE_COUNT, false);
+    tleRefreshSet(refreshIds, BENCH_TLE_COUNT, false);
+    printf("  %-22s %s\n", "  clock set by GPS:", tleRefreshAnyDue((long)refreshNow) ? "radio on" : "radio skipped");
+
+    refreshNow = t0 + 2 * 86400;
+    stubVersion = 2;
+    stubEpoch = refreshNow - 3600;
+    runRefresh("Force Update (ISS)", refreshIds, 1, true);
+    refreshNow += 7 * 3600;
+    runRefresh("reboot +7 h", refreshIds, BENCH_TLE_COUNT, false);
+    TleRecord iss;
+    printf("ISS elements %.1f h old after the refreshes\n",
+           tleRefreshLoad(refreshIds[0], iss) ? (refreshNow - iss.epochUnix) / 3600.0 : -1.0);
+
+    clearRefreshDir();
+    rmdir(REFRESH_DIR);
+}
+
+void benchNet() {
+    std::thread server;
+    int port = serverStart(server);
+    if (!port) {
+        printf("stub server failed to start\n");
+        return;
+    }
+    netBegin(&BENCH_DRIVER);
+
+    printf("events: S scan done, C connected, T time set, D download done, F failed\n");
+    printf("connect %lu ms, NTP %lu ms, stub server on port %d\n\n", FAKE_CONNECT_MS, FAKE_NTP_MS, port);
+
+    runDownload("ok", port, "/ok", false);
+    runDownload("drip", port, "/drip", false);
+    runDownload("404", port, "/missing", false);
+    runDownload("garbage", port, "/garbage", false);
+    runDownload("no wifi", port, "/ok", true);
+
+    bool started = netStartScan();
+    bool refused = !netStartOnline("bench", "pw", 0, nullptr, nullptr, nullptr);
+    NetRun r = pollUntilIdle();
+    printf("  %-10s %-7s %7.0f ms  worst poll %6.1f us  %d networks  (second job refused: %s)\n",
+           "scan", started ? r.events : "?", r.ms, r.worstPollUs, netProgress().scanCount,
+           refused ? "yes" : "no");
+
+    printf("\n-- group downloads to a file (%zu-byte TleDownload, %d-byte blocks)\n",
+           sizeof(TleDownload), TLE_DOWNLOAD_BLOCK);
+    runGroup(port, 1000);
+    runGroup(port, 10000);
+    runGroup(port, 30000);
+    runSlowGroup(port, 1000);
+    runKeepsGoodFile(port);
+
+    printf("\n-- conditional refresh of %d satellites\n", BENCH_TLE_COUNT);
+    benchRefresh(port);
+
+    serverStop(server);
+}
@@ -0,0 +1,208 @@
+#include <Arduino.h>
+
+#include "bench.h"
+#include "config.h"
+#include "ephemeris.h"
+#include "orbit.h"
+
+// --- TLE LOAD ---
+// Text -> record (streaming reader) -> SGP4 init, as the worker does it
+static void benchLoad() {
+    const int iterations = 2000;
+    printf("\n-- tleParseText + loadTLERecord (%d iterations per TLE)\n", iterations);
+    printf("%-14s %10s %10s %12s\n", "satellite", "us/parse", "us/load", "allocs/load");
+
+    for (int i = 0; i < BENCH_TLE_COUNT; i++) {
+        const char *text = BENCH_TLES[i];
+        size_t len = strlen(text);
+        TleRecord rec;
+
+        double t0 = benchSeconds();
+        for (int n = 0; n < iterations; n++) tleParseText(text, len, rec);
+        double parseUs = (benchSeconds() - t0) * 1e6 / iterations;
+
+        unsigned long a0 = benchHeap().allocs;
+        t0 = benchSeconds();
+        for (int n = 0; n < iterations; n++) loadTLERecord(rec);
+        double loadUs = (benchSeconds() - t0) * 1e6 / iterations;
+        unsigned long allocs = benchHeap().allocs - a0;
+        printf("%-14s %10.2f %10.2f %12.1f\n", satName.c_str(), parseUs, loadUs, (double)allocs / iterations);
+    }
+}
+
+// --- LIVE POSITION ---
+// The live view at 10 Hz: interpolated updates per second, SGP4 calls per
+// simulated minute (1 Hz direct propagation was 60), and the worst position
+// error against direct double-precision SGP4 at the same instants.
+static void benchLive() {
+    const unsigned long samples = 20000;
+    const double rateHz = 10;
+    printf("\n-- satellitePosition at %.0f Hz (%lu samples)\n", rateHz, samples);
+    printf("%-14s %12s %12s %10s\n", "satellite", "updates/sec", "sgp4/min", "max err m");
+
+    for (int i = 0; i < BENCH_TLE_COUNT; i++) {
+        benchLoadTLE(i);
+        double t = tleEpochUnix + 0.05;
+        unsigned long f0 = ephemLiveFills;
+        double t0 = benchSeconds();
+        for (unsigned long n = 0; n < samples; n++) satellitePosition(t + n / rateHz);
+        double dt = benchSeconds() - t0;
+        double calls = ephemLiveFills - f0;
+
+        SatElements el;
+        benchLoadElements(i, el);
+        double worst = 0;
+        for (unsigned long n = 0; n < samples; n += 7) {
+            SatState a = ephemLiveState(t + n / rateHz);
+            SatState b = propagate<double>(el, t + n / rateHz);
+            double dx = a.r[0] - b.r[0], dy = a.r[1] - b.r[1], dz = a.r[2] - b.r[2];
+            double e = sqrt(dx * dx + dy * dy + dz * dz);
+            if (e > worst) worst = e;
+        }
+        printf("%-14s %12.0f %12.1f %10.1f\n", satName.c_str(), samples / dt,
+               calls / (samples / rateHz / 60.0), worst * 1000);
+    }
+}
+
+// SGP4 evaluations from any path (live nodes + ephemeris cache fills)
+static unsigned long sgp4Calls() {
+    return ephemLiveFills + ephemNodeFills;
+}
+
+// --- PASS SEARCH ---
+// One 24h predictNextPass() per (TLE, site), starting at the TLE epoch.
+// AOS/LOS/max-el are printed so accuracy changes show up in diffs too.
+// "moved" repeats the search after nudging the observer ~10 m, as a GPS
+// fix would; that should be served entirely from the ephemeris cache.
+static void benchPassSearch() {
+    printf("\n-- predictNextPass (24h window, minEl %d)\n", DEFAULT_MIN_EL);
+    printf("%-14s %-10s %9s %8s %7s %10s %10s %6s %6s\n",
+           "satellite", "site", "ms", "props", "allocs", "aos+s", "los+s", "maxEl", "moved");
+
+    double totalMs = 0;
+    unsigned long totalProps = 0;
+    int searches = 0;
+
+    for (int i = 0; i < BENCH_TLE_COUNT; i++) {
+        for (int s = 0; s < BENCH_SITE_COUNT; s++) {
+            obsLatDeg = BENCH_SITES[s].lat;
+            obsLonDeg = BENCH_SITES[s].lon;
+            benchLoadTLE(i);
+            unsigned long start = tleEpochUnix;
+
+            PassDetails pass = {0, 0, 0, 0};
+            unsigned long p0 = sgp4Calls();
+            unsigned long a0 = benchHeap().allocs;
+            double t0 = benchSeconds();
+            bool found = predictNextPass(start, pass, DEFAULT_MIN_EL);
+            double ms = (benchSeconds() - t0) * 1000.0;
+            unsigned long props = sgp4Calls() - p0;
+            unsigned long allocs = benchHeap().allocs - a0;
+
+            PassDetails moved;
+            setupOrbitLocation(obsLatDeg + 0.0001, obsLonDeg);
+            unsigned long m0 = sgp4Calls();
+            predictNextPass(start, moved, DEFAULT_MIN_EL);
+            unsigned long movedProps = sgp4Calls() - m0;
+
+            if (found) {
+                printf("%-14s %-10s %9.2f %8lu %7lu %10lu %10lu %6.1f %6lu\n",
+                       satName.c_str(), BENCH_SITES[s].name, ms, props, allocs,
+                       pass.aosUnix - start, pass.losUnix - start, pass.maxElevation, movedProps);
+            } else {
+                // No pass, and why: still rising and setting, or ruled out by geometry
+                PassVisibility vis = passVisibility(DEFAULT_MIN_EL, start);
+                const char *why = (vis == PASS_VIS_NEVER) ? "never" : (vis == PASS_VIS_ALWAYS_UP) ? "alwaysup" : "-";
+                printf("%-14s %-10s %9.2f %8lu %7lu %10s %10s %6s %6lu\n",
+                       satName.c_str(), BENCH_SITES[s].name, ms, props, allocs,
+                       why, "-", "-", movedProps);
+            }
+            totalMs += ms;
+            totalProps += props;
+            searches++;
+        }
+    }
+    printf("mean: %.2f ms/search, %.0f props/search\n",
+           totalMs / searches, (double)totalProps / searches);
+}
+
+// --- PASS SCHEDULE ---
+// Builds a 7-day schedule ("moved": rebuilt for a site ~1 km away), then advances the clock an hour at a time for a
+// day. Compares incremental extension with rebuilding from scratch each hour.
+// Then shortens the horizon to a day and lengthens it back, which should
+// leave nothing past the day and then match a fresh build. "ends" is how
+// far the schedule reaches; short of 7 days, it hit PASS_SCHEDULE_MAX.
+static bool samePasses(const PassSchedule &a, const PassSchedule &b) {
+    if (a.count != b.count) return false;
+    for (int i = 0; i < a.count; i++) {
+        if (labs((long)a.passes[i].aosUnix - (long)b.passes[i].aosUnix) > 2 ||
+            labs((long)a.passes[i].losUnix - (long)b.passes[i].losUnix) > 2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void benchSchedule() {
+    const unsigned long horizon = 7 * 86400UL;
+    static PassSchedule fresh;
+    printf("\n-- updatePassSchedule (7 day horizon, 24 hourly advances)\n");
+    printf("%-14s %-10s %6s %6s %10s %7s %10s %12s %8s\n",
+           "satellite", "site", "passes", "ends", "build", "moved", "incr/hr", "rebuild/hr", "7d-1d-7d");
+
+    for (int i = 0; i < BENCH_TLE_COUNT; i++) {
+        for (int s = 0; s < BENCH_SITE_COUNT; s++) {
+            obsLatDeg = BENCH_SITES[s].lat;
+            obsLonDeg = BENCH_SITES[s].lon;
+            benchLoadTLE(i);
+            unsigned long start = tleEpochUnix;
+
+            unsigned long p0 = sgp4Calls();
+            updatePassSchedule(passSchedule, start, DEFAULT_MIN_EL, horizon);
+            unsigned long build = sgp4Calls() - p0;
+            int passes = passSchedule.count;
+            double endsDays = (passSchedule.searchedUntil - start) / 86400.0;
+
+            // A lat/lon typed in ~1 km away: the whole 7 days again, from the cache
+            setupOrbitLocation(obsLatDeg + 0.01, obsLonDeg);
+            resetPassSchedule(passSchedule);
+            p0 = sgp4Calls();
+            updatePassSchedule(passSchedule, start, DEFAULT_MIN_EL, horizon);
+            unsigned long moved = sgp4Calls() - p0;
+            setupOrbitLocation(obsLatDeg, obsLonDeg);
+            resetPassSchedule(passSchedule);
+            updatePassSchedule(passSchedule, start, DEFAULT_MIN_EL, horizon);
+
+            p0 = sgp4Calls();
+            for (int h = 1; h <= 24; h++) {
+                updatePassSchedule(passSchedule, start + h * 3600UL, DEFAULT_MIN_EL, horizon);
+            }
+            unsigned long incr = sgp4Calls() - p0;
+
+            p0 = sgp4Calls();
+            for (int h = 1; h <= 24; h++) {
+                resetPassSchedule(passSchedule);
+                updatePassSchedule(passSchedule, start + h * 3600UL, DEFAULT_MIN_EL, horizon);
+            }
+            unsigned long rebuild = sgp4Calls() - p0;
+
+            unsigned long now = start + 24 * 3600UL;
+            updatePassSchedule(passSchedule, now, DEFAULT_MIN_EL, 86400);
+            bool trimmed = passSchedule.count == 0 || passSchedule.passes[passSchedule.count - 1].aosUnix < now + 86400;
+            updatePassSchedule(passSchedule, now, DEFAULT_MIN_EL, horizon);
+            resetPassSchedule(fresh);
+            updatePassSchedule(fresh, now, DEFAULT_MIN_EL, horizon);
+            bool regrown = samePasses(passSchedule, fresh);
+
+            printf("%-14s %-10s %6d %5.1fd %10lu %7lu %10.0f %12.0f %8s\n", satName.c_str(), BENCH_SITES[s].name,
+                   passes, endsDays, build, moved, incr / 24.0, rebuild / 24.0, trimmed && regrown ? "ok" : "FAIL");
+        }
+    }
+}
+
+void benchOrbit() {
+    benchLoad();
+    benchLive();
+    benchPassSearch();
+    benchSchedule();
+}
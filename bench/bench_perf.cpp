@@ -0,0 +1,89 @@
+#include <Arduino.h>
+#include <algorithm>
+#include <vector>
+
+#include "bench.h"
+#include "perf.h"
+
+// --- LOOP INSTRUMENTATION ---
+// What a PERF_BEGIN / PERF_END pair costs on the hot path, then how close
+// the histogram's p99 comes to the exact one for a loop-like mix of
+// durations with a few slow outliers, and one report as it is streamed.
+
+static void waitForWindow() {
+    while (!perfPoll(0)) delay(5);
+}
+
+static void benchOverhead() {
+    const int N = 2000000;
+    waitForWindow();
+    double t0 = benchSeconds();
+    for (int i = 0; i < N; i++) {
+        PERF_BEGIN(PERF_DRAW);
+        PERF_END(PERF_DRAW);
+    }
+    double pair = (benchSeconds() - t0) / N * 1e9;
+
+    t0 = benchSeconds();
+    for (int i = 0; i < N; i++) perfRecord(PERF_PUSH, (uint32_t)(i & 0xFFFF));
+    double record = (benchSeconds() - t0) / N * 1e9;
+
+    double micro = pair - record;
+    printf("BEGIN/END pair: %.1f ns  (perfRecord %.1f ns, two micros() %.1f ns)\n", pair, record, micro);
+}
+
+static void benchAccuracy() {
+    // Mostly 0.3-1 ms passes; 2% at 5-20 ms (SD writes, a pass search
+    // landing); 0.3% at 40-120 ms (a blocking dialog)
+    std::vector<uint32_t> us;
+    uint32_t seed = 12345;
+    auto rnd = [&seed](uint32_t lo, uint32_t hi) {
+        seed = seed * 1664525 + 1013904223;
+        return lo + (seed >> 8) % (hi - lo);
+    };
+    for (int i = 0; i < 5000; i++) {
+        uint32_t r = rnd(0, 1000);
+        if (r < 3) us.push_back(rnd(40000, 120000));
+        else if (r < 23) us.push_back(rnd(5000, 20000));
+        else us.push_back(rnd(300, 1000));
+    }
+
+    waitForWindow();
+    for (uint32_t v : us) perfRecord(PERF_LOOP, v);
+    waitForWindow();
+    const PerfPhaseStats &s = perfReport().phase[PERF_LOOP];
+
+    std::vector<uint32_t> sorted = us;
+    std::sort(sorted.begin(), sorted.end());
+    uint64_t sum = 0;
+    for (uint32_t v : us) sum += v;
+    uint32_t exactP99 = sorted[sorted.size() - sorted.size() / 100 - 1];
+
+    printf("%-10s %8s %8s %8s %8s %8s\n", "", "n", "min", "avg", "p99", "max");
+    printf("%-10s %8zu %8u %8u %8u %8u\n", "exact", us.size(), sorted.front(),
+           (unsigned)(sum / us.size()), exactP99, sorted.back());
+    printf("%-10s %8lu %8lu %8lu %8lu %8lu\n", "histogram", (unsigned long)s.count, (unsigned long)s.minUs,
+           (unsigned long)s.avgUs, (unsigned long)s.p99Us, (unsigned long)s.maxUs);
+    printf("p99 error %+.1f%% (bucket upper bound, at most +25%%)\n",
+           100.0 * ((double)s.p99Us - exactP99) / exactP99);
+}
+
+static void benchStream() {
+    for (int i = 0; i < 50; i++) {
+        perfRecord(PERF_LOOP, 700 + i * 3);
+        perfRecord(PERF_INPUT, 120 + i);
+        perfRecord(PERF_IDLE, 20100 + i * 7);
+    }
+    perfStream(true);
+    printf("streamed report:\n");
+    waitForWindow();
+    perfStream(false);
+}
+
+void benchPerf() {
+    benchOverhead();
+    printf("\n");
+    benchAccuracy();
+    printf("\n");
+    benchStream();
+}
@@ -0,0 +1,103 @@
+#include <Arduino.h>
+#include <math.h>
+
+#include "bench.h"
+#include "propagator.h"
+
+// --- FLOAT VS DOUBLE SGP4 ---
+// Accuracy of propagate<float> against the double reference as the TLE
+// ages, and the cost of each variant. On the host both scalar types run in
+// hardware, so the speed ratio here understates the gain on the ESP32-S3.
+
+static double distKm(const double a[3], const double b[3]) {
+    double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+// Worst position difference over [epoch, epoch + days], sampled every minute
+template <typename T>
+static double maxErrorKm(const SatElements &el, int days) {
+    double worst = 0;
+    for (long m = 0; m <= days * 1440L; m++) {
+        double t = el.epochUnix + m * 60.0;
+        SatState ref = propagate<double>(el, t);
+        SatState s = propagate<T>(el, t);
+        if (!ref.valid || !s.valid) continue;
+        double e = distKm(s.r, ref.r);
+        if (e > worst) worst = e;
+    }
+    return worst;
+}
+
+// Our double instance against the library's own sgp4()
+static double maxLibraryDiffKm(const SatElements &el, int days) {
+    double worst = 0;
+    for (long m = 0; m <= days * 1440L; m++) {
+        double r[3], v[3];
+        elsetrec rec = el.rec;
+        if (!sgp4(wgs72, rec, m, r, v)) continue;
+        SatState s = propagate<double>(el, el.epochUnix + m * 60.0);
+        if (!s.valid) continue;
+        double e = distKm(s.r, r);
+        if (e > worst) worst = e;
+    }
+    return worst;
+}
+
+static void benchAccuracy() {
+    printf("\n-- propagate<float> position error vs double (max over TLE age, 1 min samples)\n");
+    printf("%-14s %6s %10s %10s %10s %14s\n", "satellite", "model", "1 day m", "3 day m", "7 day m", "dbl-vs-lib m");
+
+    for (int i = 0; i < BENCH_TLE_COUNT; i++) {
+        SatElements el;
+        if (!benchLoadElements(i, el)) continue;
+        if (!el.nearEarth) {
+            printf("%-14s %6s %10s %10s %10s %14s\n", el.name, "deep", "-", "-", "-", "(library)");
+            continue;
+        }
+        printf("%-14s %6s %10.1f %10.1f %10.1f %14.6f\n", el.name, "near",
+               maxErrorKm<float>(el, 1) * 1000, maxErrorKm<float>(el, 3) * 1000,
+               maxErrorKm<float>(el, 7) * 1000, maxLibraryDiffKm(el, 7) * 1000);
+    }
+}
+
+template <typename T>
+static double propsPerSec(const SatElements &el, unsigned long samples, double &sink) {
+    double t0 = benchSeconds();
+    for (unsigned long n = 0; n < samples; n++) {
+        SatState s = propagate<T>(el, el.epochUnix + n);
+        sink += s.r[0];
+    }
+    return samples / (benchSeconds() - t0);
+}
+
+static void benchSpeed() {
+    const unsigned long samples = 200000;
+    printf("\n-- propagations/sec by variant (%lu samples, 1 s apart)\n", samples);
+    printf("%-14s %12s %12s %12s\n", "satellite", "library", "double", "float");
+
+    double sink = 0;
+    for (int i = 0; i < BENCH_TLE_COUNT; i++) {
+        SatElements el;
+        if (!benchLoadElements(i, el)) continue;
+
+        double t0 = benchSeconds();
+        for (unsigned long n = 0; n < samples; n++) {
+            double r[3], v[3];
+            elsetrec rec = el.rec;
+            sgp4(wgs72, rec, n / 60.0, r, v);
+            sink += r[0];
+        }
+        double lib = samples / (benchSeconds() - t0);
+
+        double d = propsPerSec<double>(el, samples, sink);
+        double f = propsPerSec<float>(el, samples, sink);
+        printf("%-14s %12.0f %12.0f %12.0f%s\n", el.name, lib, d, f, el.nearEarth ? "" : "  (deep: library)");
+    }
+    if (sink == 12345.678) printf("\n");  // Keep the loops from being optimised away
+}
+
+void benchPrecision() {
+    benchAccuracy();
+    benchSpeed();
+}
@@ -0,0 +1,240 @@
+#include <Arduino.h>
+#include <climits>
+
+#include "bench.h"
+#include "config.h"
+#include "net.h"
+#include "scheduler.h"
+
+// --- LOOP SCHEDULER ---
+// A minute of loop() on a simulated clock, once as the old fixed
+// `delay(20)` spin and once driven by the scheduler, with the same work
+// costs: a keyboard scan, a redraw per orbit snapshot (10 Hz), a GPS
+// sentence burst a second, a 3 s network session and one LOS. For each it
+// counts passes and measures how long keys, snapshots and NMEA waited
+// before loop() saw them, and how late the LOS LED went off. Then checks
+// the timer arithmetic itself and what a pass's scheduler calls cost.
+
+#define SIM_SECONDS    60
+#define SCAN_US        300      // M5Cardputer.update()
+#define POLL_US        150      // A pass's cheap checks (netPoll, orbitPoll...)
+#define REDRAW_US      8000     // Drawing and pushing a changed screen
+#define SNAPSHOT_US    100000
+#define SNAPSHOT_PHASE 37000    // The worker isn't aligned with loop()
+#define GPS_US         1000000
+#define GPS_PHASE      512000
+#define NET_START_US   2000000
+#define NET_END_US     5000000
+#define LOS_US         30000000
+#define LOS_LED_US     5000000  // LOS_DURATION_MS
+#define KEY_PRESSES    40
+
+enum BenchTimer { BT_INPUT, BT_NET, BT_LOS, BT_PERF };
+
+static unsigned long simUs = 0;
+static unsigned long simClock() {
+    return simUs / 1000;
+}
+
+struct Waits {
+    unsigned long count;
+    double sumUs, maxUs;
+    void add(double us) {
+        count++;
+        sumUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+    double avgMs() const { return count ? sumUs / count / 1000 : 0; }
+    double maxMs() const { return maxUs / 1000; }
+};
+
+struct LoopRun {
+    unsigned long passes, scans;
+    double busyUs;
+    Waits keys, snapshots, gps;
+    double ledLateMs;
+};
+
+static unsigned long keyTimes[KEY_PRESSES];
+
+static void makeKeys() {
+    uint32_t seed = 777;
+    for (int i = 0; i < KEY_PRESSES; i++) {
+        seed = seed * 1664525 + 1013904223;
+        keyTimes[i] = (unsigned long)i * (SIM_SECONDS * 1000000UL / KEY_PRESSES) + (seed >> 8) % 1000000;
+    }
+}
+
+// Everything that has happened by `simUs` and not been seen yet
+struct Pending {
+    int key = 0;
+    unsigned long snapshot = SNAPSHOT_PHASE;
+    unsigned long gps = GPS_PHASE;
+};
+
+static double takeSnapshots(Pending &p, Waits &w) {
+    double cost = 0;
+    while (p.snapshot <= simUs) {
+        w.add(simUs - p.snapshot);
+        p.snapshot += SNAPSHOT_US;
+        cost = REDRAW_US;  // Several at once still redraw once
+    }
+    return cost;
+}
+
+static void takeGps(Pending &p, Waits &w) {
+    while (p.gps <= simUs) {
+        w.add(simUs - p.gps);
+        p.gps += GPS_US;
+    }
+}
+
+static void takeKeys(Pending &p, Waits &w) {
+    while (p.key < KEY_PRESSES && keyTimes[p.key] <= simUs) w.add(simUs - keyTimes[p.key++]);
+}
+
+static LoopRun runSpin() {
+    LoopRun r = {};
+    Pending p;
+    bool losLit = false;
+    unsigned long losStart = 0;
+    simUs = 0;
+    while (simUs < SIM_SECONDS * 1000000UL) {
+        double cost = SCAN_US + POLL_US;
+        r.scans++;
+        takeKeys(p, r.keys);
+        takeGps(p, r.gps);
+        double draw = takeSnapshots(p, r.snapshots);
+        // The LED was only looked at when a snapshot came in
+        if (draw > 0) {
+            if (!losLit && losStart == 0 && simUs >= LOS_US) {
+                losLit = true;
+                losStart = simUs;
+            } else if (losLit && simUs - losStart >= LOS_LED_US) {
+                r.ledLateMs = (simUs - losStart - LOS_LED_US) / 1000.0;
+                losLit = false;
+            }
+        }
+        cost += draw;
+        r.passes++;
+        r.busyUs += cost;
+        simUs += (unsigned long)cost + 20000;  // delay(20)
+    }
+    return r;
+}
+
+static LoopRun runScheduled() {
+    LoopRun r = {};
+    Pending p;
+    simUs = 0;
+    schedBegin(simClock);
+    schedEvery(BT_INPUT, INPUT_POLL_MS);
+    schedEvery(BT_PERF, PERF_WINDOW_MS);
+    unsigned long losStart = 0;
+
+    while (simUs < SIM_SECONDS * 1000000UL) {
+        // Sleep to the next deadline or the next wake from another task
+        unsigned long until = schedUntilNext();
+        unsigned long wakeUs = until == SCHED_NEVER ? ULONG_MAX : (simClock() + until) * 1000;
+        unsigned long external = p.snapshot < p.gps ? p.snapshot : p.gps;
+        if (external < wakeUs) wakeUs = external;
+        if (wakeUs > simUs) simUs = wakeUs;
+
+        double cost = POLL_US;
+        bool inputDue = false;
+        for (int id = schedNextFired(); id >= 0; id = schedNextFired()) {
+            if (id == BT_INPUT) inputDue = true;
+            if (id == BT_LOS) r.ledLateMs = (simUs - losStart - LOS_LED_US) / 1000.0;
+        }
+        if (inputDue) {
+            cost += SCAN_US;
+            r.scans++;
+            takeKeys(p, r.keys);
+        }
+        takeGps(p, r.gps);
+        double draw = takeSnapshots(p, r.snapshots);
+        if (draw > 0 && losStart == 0 && simUs >= LOS_US) {
+            schedIn(BT_LOS, LOS_LED_US / 1000);
+            losStart = simUs;
+        }
+        cost += draw;
+
+        bool netBusy = simUs >= NET_START_US && simUs < NET_END_US;
+        if (!netBusy) schedCancel(BT_NET);
+        else if (!schedPending(BT_NET)) schedEvery(BT_NET, NET_POLL_MS);
+
+        r.passes++;
+        r.busyUs += cost;
+        simUs += (unsigned long)cost;
+    }
+    return r;
+}
+
+static void printRun(const char *name, const LoopRun &r) {
+    printf("%-10s %7lu %6lu %6.1f%%  %5.1f /%5.1f  %5.1f /%5.1f  %5.1f /%5.1f  %6.1f\n", name,
+           r.passes, r.scans, 100.0 * r.busyUs / (SIM_SECONDS * 1e6), r.keys.avgMs(), r.keys.maxMs(),
+           r.snapshots.avgMs(), r.snapshots.maxMs(), r.gps.avgMs(), r.gps.maxMs(), r.ledLateMs);
+}
+
+// --- TIMER CHECKS ---
+static int fired[SCHED_TIMERS];
+
+static void drain() {
+    for (int id = schedNextFired(); id >= 0; id = schedNextFired()) fired[id]++;
+}
+
+static bool check(const char *what, int got, int want) {
+    printf("  %-36s %4d (want %d)%s\n", what, got, want, got == want ? "" : "  MISMATCH");
+    return got == want;
+}
+
+static void timerChecks() {
+    memset(fired, 0, sizeof(fired));
+    simUs = 0;
+    schedBegin(simClock);
+    schedEvery(0, 20);
+    schedIn(1, 250);
+    schedIn(2, 100);
+    schedCancel(2);
+    for (int ms = 1; ms <= 1000; ms++) {
+        simUs = ms * 1000UL;
+        drain();
+    }
+    check("20 ms repeating over 1 s", fired[0], 50);
+    check("one shot", fired[1], 1);
+    check("cancelled one shot", fired[2], 0);
+
+    // A 95 ms stall: one late fire, then back on a 20 ms beat from there
+    memset(fired, 0, sizeof(fired));
+    simUs += 95000;
+    drain();
+    check("after a 95 ms stall", fired[0], 1);
+    check("ms until the next", (int)schedUntilNext(), 20);
+}
+
+static void costs() {
+    simUs = 0;
+    schedBegin(simClock);
+    for (int i = 0; i < 6; i++) schedEvery(i, 20 + i * 7);
+    const int N = 2000000;
+    volatile long sink = 0;
+    double t0 = benchSeconds();
+    for (int i = 0; i < N; i++) {
+        sink += schedUntilNext();
+        sink += schedNextFired();
+    }
+    printf("schedUntilNext + schedNextFired, 6 timers: %.1f ns\n", (benchSeconds() - t0) / N * 1e9);
+}
+
+void benchSched() {
+    makeKeys();
+    printf("%d s of loop(), same work costs (waits in ms, avg / max)\n", SIM_SECONDS);
+    printf("%-10s %7s %6s %7s  %13s  %13s  %13s  %6s\n", "", "passes", "scans", "busy", "key wait",
+           "snapshot wait", "NMEA wait", "LED late");
+    printRun("delay(20)", runSpin());
+    printRun("scheduler", runScheduled());
+    printf("\n");
+    timerChecks();
+    printf("\n");
+    costs();
+}
@@ -0,0 +1,271 @@
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "iss_icon.h"
+#include "screenshot.h"
+#include "storage.h"
+
+// --- SCREENSHOTS ---
+// Synthetic 240x135 frames like the ones the screens draw (flat background,
+// text, the radar, the ISS icon) and one photo-like frame with thousands of
+// colours. Each is written through screenshotWriteBmp() the way the canvas
+// keeps it (bytes swapped), read back and decoded here, and compared pixel
+// for pixel. Sizes and times are set against the old 24-bit BMP written
+// one row at a time.
+//
+// Then the filename lookup: the old probe that tried snap001, snap002, ...
+// until one was free, against the counter kept in prefs.
+
+#define FRAME_W 240
+#define FRAME_H 135
+#define SNAP_PATH "/tmp/bench_snap.bmp"
+
+static uint16_t frame[FRAME_W * FRAME_H];
+
+// --- FRAMES ---
+static void fill(int x, int y, int w, int h, uint16_t c) {
+    for (int j = y; j < y + h && j < FRAME_H; j++)
+        for (int i = x; i < x + w && i < FRAME_W; i++) frame[j * FRAME_W + i] = c;
+}
+
+static void dot(int x, int y, uint16_t c) {
+    if (x >= 0 && x < FRAME_W && y >= 0 && y < FRAME_H) frame[y * FRAME_W + x] = c;
+}
+
+// Glyph-sized blocks of scattered pixels, close enough to 6x8 text
+static void text(int x, int y, int chars, uint16_t c, uint32_t &seed) {
+    for (int k = 0; k < chars; k++)
+        for (int j = 0; j < 8; j++)
+            for (int i = 0; i < 5; i++) {
+                seed = seed * 1664525 + 1013904223;
+                if ((seed >> 24) % 3 == 0) dot(x + k * 6 + i, y + j, c);
+            }
+}
+
+static void circle(int cx, int cy, int r, uint16_t c) {
+    for (int a = 0; a < 720; a++) {
+        double t = a * M_PI / 360;
+        dot(cx + (int)lround(r * cos(t)), cy + (int)lround(r * sin(t)), c);
+    }
+}
+
+static void icon(int x, int y) {
+    for (int j = 0; j < 32; j++)
+        for (int i = 0; i < 32; i++)
+            if (ISS_ICON_32x32[j * 32 + i]) dot(x + i, y + j, ISS_ICON_32x32[j * 32 + i]);
+}
+
+static void homeFrame() {
+    uint32_t seed = 7;
+    fill(0, 0, FRAME_W, FRAME_H, 0x0000);
+    fill(0, 0, FRAME_W, 14, 0x18E3);
+    text(4, 3, 20, 0xFFFF, seed);
+    icon(200, 20);
+    for (int row = 0; row < 6; row++) text(6, 22 + row * 14, 22 + row % 3, row % 2 ? 0x07FF : 0xFFE0, seed);
+    fill(0, 121, FRAME_W, 14, 0x18E3);
+    text(4, 124, 30, 0x8410, seed);
+}
+
+static void radarFrame() {
+    uint32_t seed = 11;
+    fill(0, 0, FRAME_W, FRAME_H, 0x0000);
+    for (int r = 20; r <= 60; r += 20) circle(67, 67, r, 0x03E0);
+    fill(7, 67, 121, 1, 0x03E0);
+    fill(67, 7, 1, 121, 0x03E0);
+    for (int i = 0; i < 90; i++) dot(20 + i, 100 - i * 3 / 4 + (i * i) / 120, 0xFFE0);
+    fill(89, 58, 4, 4, 0xF800);
+    for (int row = 0; row < 7; row++) text(140, 10 + row * 16, 15, 0xFFFF, seed);
+}
+
+static void photoFrame() {
+    uint32_t seed = 3;
+    for (int y = 0; y < FRAME_H; y++)
+        for (int x = 0; x < FRAME_W; x++) {
+            seed = seed * 1664525 + 1013904223;
+            int r = (x * 31 / FRAME_W + (seed >> 28) % 3) & 31;
+            int g = (y * 63 / FRAME_H + (seed >> 24) % 5) & 63;
+            int b = ((x + y) * 31 / (FRAME_W + FRAME_H)) & 31;
+            frame[y * FRAME_W + x] = r << 11 | g << 5 | b;
+        }
+}
+
+// --- DECODE ---
+static uint32_t rd32(const uint8_t *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint16_t from888(uint8_t r, uint8_t g, uint8_t b) {
+    return (r >> 3) << 11 | (g >> 2) << 5 | b >> 3;
+}
+
+// Decodes the file back to RGB565, top row first; counts mismatches
+// against `frame` (-1 if the file doesn't parse)
+static long verify(const char *path, uint32_t expectBytes) {
+    static uint8_t file[FRAME_W * FRAME_H * 4];
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    size_t len = fread(file, 1, sizeof(file), f);
+    fclose(f);
+    if (len < 54 || file[0] != 'B' || file[1] != 'M' || rd32(file + 2) != len || len != expectBytes) return -1;
+    uint32_t offset = rd32(file + 10);
+    int w = rd32(file + 18), h = rd32(file + 22), bits = file[28];
+    uint32_t compression = rd32(file + 30);
+    if (w != FRAME_W || h != FRAME_H || rd32(file + 34) != len - offset) return -1;
+
+    static uint16_t out[FRAME_W * FRAME_H];
+    memset(out, 0, sizeof(out));
+    if (compression == 1 && bits == 8) {
+        uint16_t pal[256];
+        int colors = rd32(file + 46);
+        for (int i = 0; i < colors; i++) {
+            const uint8_t *q = file + 54 + i * 4;
+            pal[i] = from888(q[2], q[1], q[0]);
+        }
+        const uint8_t *p = file + offset, *end = file + len;
+        int x = 0, y = h - 1;
+        while (p + 1 < end) {
+            uint8_t a = *p++, b = *p++;
+            if (a) {
+                for (int k = 0; k < a && x < w; k++) out[y * w + x++] = pal[b];
+            } else if (b == 0) {
+                x = 0;
+                y--;
+            } else if (b == 1) {
+                break;
+            } else if (b == 2) {
+                return -1;  // Delta isn't written
+            } else {
+                for (int k = 0; k < b && x < w; k++) out[y * w + x++] = pal[p[k]];
+                p += (b + 1) & ~1;
+            }
+        }
+    } else if (compression == 3 && bits == 16) {
+        int rowBytes = (w * 2 + 3) & ~3;
+        for (int y = 0; y < h; y++) {
+            const uint8_t *row = file + offset + (h - 1 - y) * rowBytes;
+            for (int x = 0; x < w; x++) out[y * w + x] = row[x * 2] | row[x * 2 + 1] << 8;
+        }
+    } else {
+        return -1;
+    }
+
+    long bad = 0;
+    for (int i = 0; i < w * h; i++) bad += out[i] != frame[i];
+    return bad;
+}
+
+// --- OLD WRITER ---
+// 24-bit, one write per row, as takeScreenshot() did after each row was
+// read back from the panel (the readback isn't simulated)
+static uint32_t oldWrite(const char *path) {
+    int rowSize = (FRAME_W * 3 + 3) & ~3;
+    uint32_t fileSize = 54 + rowSize * FRAME_H;
+    uint8_t header[54] = {'B', 'M'};
+    header[2] = fileSize;
+    header[3] = fileSize >> 8;
+    header[4] = fileSize >> 16;
+    header[10] = 54;
+    header[14] = 40;
+    header[18] = FRAME_W;
+    header[22] = FRAME_H;
+    header[26] = 1;
+    header[28] = 24;
+    StorageFile f = storageOpen(path, STORAGE_WRITE);
+    storageWrite(f, header, 54);
+    uint8_t line[FRAME_W * 3 + 4] = {};
+    for (int y = FRAME_H - 1; y >= 0; y--) {
+        for (int x = 0; x < FRAME_W; x++) {
+            uint16_t c = frame[y * FRAME_W + x];
+            line[x * 3] = (c & 0x1F) << 3;
+            line[x * 3 + 1] = (c >> 5 & 0x3F) << 2;
+            line[x * 3 + 2] = (c >> 11) << 3;
+        }
+        storageWrite(f, line, rowSize);
+    }
+    storageClose(f);
+    return fileSize;
+}
+
+static void runFrame(const char *name, void (*draw)()) {
+    draw();
+    static uint16_t swapped[FRAME_W * FRAME_H];
+    for (int i = 0; i < FRAME_W * FRAME_H; i++) swapped[i] = frame[i] << 8 | frame[i] >> 8;
+
+    const int REPS = 50;
+    ScreenshotInfo info = {};
+    bool ok = true;
+    double t0 = benchSeconds();
+    for (int i = 0; i < REPS; i++) ok &= screenshotWriteBmp(SNAP_PATH, swapped, FRAME_W, FRAME_H, true, info);
+    double newMs = (benchSeconds() - t0) / REPS * 1000;
+    long bad = ok ? verify(SNAP_PATH, info.bytes) : -1;
+
+    uint32_t oldBytes = 0;
+    t0 = benchSeconds();
+    for (int i = 0; i < REPS; i++) oldBytes = oldWrite(SNAP_PATH);
+    double oldMs = (benchSeconds() - t0) / REPS * 1000;
+
+    printf("%-8s %7d %9s %8lu %6.1f%% %7lu %8lu %6.3f %6.3f   %s\n", name, info.colors,
+           info.colors ? "RLE8" : "RGB565", (unsigned long)info.bytes, 100.0 * info.bytes / oldBytes,
+           (unsigned long)(info.bytes + SCREENSHOT_BLOCK - 1) / SCREENSHOT_BLOCK + 2, (unsigned long)FRAME_H + 1,
+           newMs, oldMs, bad == 0 ? "ok" : bad < 0 ? "UNREADABLE" : "MISMATCH");
+}
+
+// --- FILENAMES ---
+#define NAME_DIR "/tmp/bench_snapnames"
+
+static void filenames() {
+    printf("\nnext filename with N shots already on the card: lookups and us per shot\n");
+    printf("%6s %12s %10s %12s %10s\n", "N", "probe (old)", "us", "counter", "us");
+    storageMakeDir(NAME_DIR);
+    char path[64];
+    int have = 0;
+    const int counts[] = {10, 100, 500};
+    for (int n : counts) {
+        for (; have < n; have++) {
+            snprintf(path, sizeof(path), NAME_DIR "/snap%03d.bmp", have + 1);
+            StorageFile f = storageOpen(path, STORAGE_WRITE);
+            storageClose(f);
+        }
+        struct stat st;
+        int probes = 0;
+        double t0 = benchSeconds();
+        for (int num = 1;; num++) {
+            snprintf(path, sizeof(path), NAME_DIR "/snap%03d.bmp", num);
+            probes++;
+            if (stat(path, &st) != 0) break;
+        }
+        double oldUs = (benchSeconds() - t0) * 1e6;
+
+        // The counter already points past the last shot
+        int lookups = 0;
+        t0 = benchSeconds();
+        for (int num = n + 1;; num++) {
+            snprintf(path, sizeof(path), NAME_DIR "/snap%03d.bmp", num);
+            lookups++;
+            if (stat(path, &st) != 0) break;
+        }
+        double newUs = (benchSeconds() - t0) * 1e6;
+        printf("%6d %12d %10.1f %12d %10.1f\n", n, probes, oldUs, lookups, newUs);
+    }
+    for (int i = 1; i <= have; i++) {
+        snprintf(path, sizeof(path), NAME_DIR "/snap%03d.bmp", i);
+        storageRemove(path);
+    }
+    rmdir(NAME_DIR);
+}
+
+void benchScreenshot() {
+    printf("%dx%d frames; old = 24-bit BMP, one write per row (host file, no panel readback)\n", FRAME_W,
+           FRAME_H);
+    printf("%-8s %7s %9s %8s %7s %7s %8s %6s %6s   %s\n", "frame", "colours", "format", "bytes", "of old",
+           "writes", "old wr", "ms", "old ms", "decode");
+    runFrame("home", homeFrame);
+    runFrame("radar", radarFrame);
+    runFrame("photo", photoFrame);
+    storageRemove(SNAP_PATH);
+    filenames();
+}
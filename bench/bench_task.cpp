@@ -0,0 +1,233 @@
+#include <Arduino.h>
+#include <math.h>
+#include <thread>
+
+#include "bench.h"
+#include "config.h"
+#include "ephemeris.h"
+#include "orbit.h"
+#include "orbit_task.h"
+#include "pass_cache.h"
+
+// --- ORBIT WORKER ---
+// Runs the real worker on std::thread and plays the UI side: poll every
+// 20 ms like loop() does. The UI's cost per frame must stay flat while the
+// worker builds a 7 day schedule in the background.
+//
+// Then a "reboot" an hour later, once cold and once with the schedule the
+// first run left in the pass cache, as setup() offers it.
+//
+// Last, the site: how far AOS and LOS move when the observer does, and
+// how often the worker rebuilds its schedule under GPS jitter and after a
+// real move (SITE_MOVE_KM), and whether a satellite pick still gets through
+// a flood of GPS fixes.
+
+static unsigned long benchClockBase = 0;
+static double benchClockStart = 0;
+static const char *CACHE_PATH = "/tmp/iss_bench_passes.bin";
+
+static double benchClock() {
+    return benchClockBase + (benchSeconds() - benchClockStart);
+}
+
+struct WorkerRun {
+    int frames, snapshots;
+    double worstPollUs;
+    double firstPasses;           // s until a finished schedule is visible
+    unsigned long sgp4ToFirst;    // SGP4 calls until then
+};
+
+static WorkerRun runWorker(unsigned long startUnix, double seconds, const PassSchedule *cached) {
+    benchClockBase = startUnix;
+    benchClockStart = benchSeconds();
+    unsigned long fills0 = ephemNodeFills + ephemLiveFills;
+
+    orbitTaskStart(benchClock);
+    orbitRequestSite(BENCH_SITES[0].lat, BENCH_SITES[0].lon);
+    orbitRequestPassParams(DEFAULT_MIN_EL, MAX_PASS_DAYS);
+    TleRecord rec;
+    tleParseText(BENCH_TLES[0], strlen(BENCH_TLES[0]), rec);
+    orbitRequestTLE(rec);
+    if (cached) {
+        orbitRequestCachedPasses(cached, passCacheKey(rec.catalogNumber, (unsigned long)rec.epochUnix,
+                                                      BENCH_SITES[0].lat, BENCH_SITES[0].lon, DEFAULT_MIN_EL));
+    }
+
+    WorkerRun r = {0, 0, 0, -1, 0};
+    double start = benchSeconds();
+    while (benchSeconds() - start < seconds) {
+        double t0 = benchSeconds();
+        bool fresh = orbitPoll();
+        const OrbitSnapshot &o = orbitView();
+        int passes = o.passCount;  // Touch it like a draw would
+        double us = (benchSeconds() - t0) * 1e6;
+        if (us > r.worstPollUs) r.worstPollUs = us;
+
+        if (fresh) r.snapshots++;
+        if (r.firstPasses < 0 && passes > 0 && !o.searching) {
+            r.firstPasses = benchSeconds() - start;
+            r.sgp4ToFirst = ephemNodeFills + ephemLiveFills - fills0;
+        }
+        r.frames++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    orbitTaskStop();
+    return r;
+}
+
+// Worst AOS / LOS shift over a day of passes, site moved `km` north-east
+static void passShift(unsigned long startUnix, double km, long &aosS, long &losS, int &passes) {
+    static PassSchedule a, b;
+    const BenchSite &site = BENCH_SITES[0];
+    double dLat = km / sqrt(2.0) / 111.32;
+    double dLon = dLat / cos(site.lat * DEG_TO_RAD);
+    setupOrbitLocation(site.lat, site.lon);
+    resetPassSchedule(a);
+    updatePassSchedule(a, startUnix, DEFAULT_MIN_EL, 86400);
+    setupOrbitLocation(site.lat + dLat, site.lon + dLon);
+    resetPassSchedule(b);
+    updatePassSchedule(b, startUnix, DEFAULT_MIN_EL, 86400);
+    aosS = losS = 0;
+    passes = a.count < b.count ? a.count : b.count;
+    for (int i = 0; i < passes; i++) {
+        long da = labs((long)a.passes[i].aosUnix - (long)b.passes[i].aosUnix);
+        long dl = labs((long)a.passes[i].losUnix - (long)b.passes[i].losUnix);
+        if (da > aosS) aosS = da;
+        if (dl > losS) losS = dl;
+    }
+}
+
+// The UI side of a GPS: fixes every 100 ms with `jitterM` of noise, then
+// one `moveKm` away, then a manual edit 300 m further. Counts schedule
+// rebuilds (passGen) in each phase.
+static void runJitter(unsigned long startUnix, double jitterM, double moveKm, int &jitterRebuilds, int &moveRebuilds,
+                      int &typedRebuilds) {
+    benchClockBase = startUnix;
+    benchClockStart = benchSeconds();
+    const BenchSite &site = BENCH_SITES[0];
+    orbitTaskStart(benchClock);
+    orbitRequestSite(site.lat, site.lon);
+    orbitRequestPassParams(DEFAULT_MIN_EL, DEFAULT_PASS_DAYS);
+    TleRecord rec;
+    tleParseText(BENCH_TLES[0], strlen(BENCH_TLES[0]), rec);
+    orbitRequestTLE(rec);
+
+    // Settled: a finished schedule for the first site
+    while (true) {
+        orbitPoll();
+        if (orbitView().passCount > 0 && !orbitView().searching) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    uint32_t gen = orbitView().passGen;
+    uint32_t seed = 4242;
+    for (int i = 0; i < 30; i++) {
+        seed = seed * 1664525 + 1013904223;
+        double n = ((int)((seed >> 8) % 2001) - 1000) / 1000.0 * jitterM / 1000 / 111.32;
+        seed = seed * 1664525 + 1013904223;
+        double e = ((int)((seed >> 8) % 2001) - 1000) / 1000.0 * jitterM / 1000 / 111.32;
+        orbitRequestSite(site.lat + n, site.lon + e / cos(site.lat * DEG_TO_RAD));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        orbitPoll();
+    }
+    jitterRebuilds = (int)(orbitView().passGen - gen) / 2;  // Reset, then the new list
+
+    gen = orbitView().passGen;
+    orbitRequestSite(site.lat + moveKm / 111.32, site.lon);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    orbitPoll();
+    moveRebuilds = (int)(orbitView().passGen - gen) / 2;
+
+    // A site typed in 300 m away applies whatever the distance
+    gen = orbitView().passGen;
+    orbitRequestSite(site.lat + (moveKm + 0.3) / 111.32, site.lon, true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    orbitPoll();
+    typedRebuilds = (int)(orbitView().passGen - gen) / 2;
+    orbitTaskStop();
+}
+
+// A GPS streaming fixes while the worker is deep in a 7 day search, then a
+// satellite pick: the pick must still get through and be loaded.
+static void runFlood(unsigned long startUnix, int fixes, bool &queued, double &loadedMs) {
+    benchClockBase = startUnix;
+    benchClockStart = benchSeconds();
+    const BenchSite &site = BENCH_SITES[0];
+    orbitTaskStart(benchClock);
+    orbitRequestSite(site.lat, site.lon);
+    orbitRequestPassParams(0, MAX_PASS_DAYS);
+    TleRecord rec, pick;
+    tleParseText(BENCH_TLES[0], strlen(BENCH_TLES[0]), rec);
+    tleParseText(BENCH_TLES[3], strlen(BENCH_TLES[3]), pick);
+    orbitRequestTLE(rec);
+
+    for (int i = 0; i < fixes; i++) orbitRequestSite(site.lat + i * 1e-7, site.lon);
+    double t0 = benchSeconds();
+    queued = orbitRequestTLE(pick);
+    loadedMs = -1;
+    while (queued && benchSeconds() - t0 < 5) {
+        orbitPoll();
+        if (strcmp(orbitView().name, pick.name) == 0) {
+            loadedMs = (benchSeconds() - t0) * 1000;
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    orbitTaskStop();
+}
+
+void benchTask() {
+    // ISS, from its epoch
+    benchLoadTLE(0);
+    unsigned long epoch = tleEpochUnix;
+
+    WorkerRun r = runWorker(epoch, 3.0, nullptr);
+    const OrbitSnapshot &o = orbitView();
+    printf("\n-- orbit worker (UI polling at 20 ms for 3 s)\n");
+    printf("frames %d, snapshots %d, worst poll %.1f us\n", r.frames, r.snapshots, r.worstPollUs);
+    printf("7 day schedule: %d passes, first visible after %.0f ms\n", o.passCount, r.firstPasses * 1000.0);
+    printf("radar track: %d points, resampled %u times\n", o.trackCount, (unsigned)o.trackGen);
+
+    // What savePassCache() in main.cpp stores
+    static PassSchedule s;
+    s.count = o.passCount;
+    memcpy(s.passes, o.passes, o.passCount * sizeof(PassDetails));
+    s.searchedUntil = o.passSearchedUntil;
+    s.minEl = o.passKey.minEl;
+    s.visibility = o.passVisibility;
+    remove(CACHE_PATH);
+    bool saved = passCacheSave(CACHE_PATH, o.passKey, s, epoch);
+
+    static PassSchedule cached;
+    bool loaded = saved && passCacheLoad(CACHE_PATH, o.passKey, cached);
+    WorkerRun cold = runWorker(epoch + 3600, 1.0, nullptr);
+    int coldCount = orbitView().passCount;
+    WorkerRun warm = runWorker(epoch + 3600, 1.0, loaded ? &cached : nullptr);
+    int warmCount = orbitView().passCount;
+    remove(CACHE_PATH);
+
+    printf("\n-- reboot 1 h later (cache %s)\n", loaded ? "saved and read back" : "FAILED");
+    printf("%-8s %10s %14s %8s\n", "", "first ms", "SGP4 to first", "passes");
+    printf("%-8s %10.0f %14lu %8d\n", "cold", cold.firstPasses * 1000.0, cold.sgp4ToFirst, coldCount);
+    printf("%-8s %10.0f %14lu %8d\n", "cached", warm.firstPasses * 1000.0, warm.sgp4ToFirst, warmCount);
+
+    printf("\n-- site moves (next 24 h, worst shift over the passes)\n");
+    printf("%8s %8s %8s %7s\n", "km", "AOS s", "LOS s", "passes");
+    const double MOVES[] = {0.02, 0.25, SITE_MOVE_KM, 5, 20};
+    for (double km : MOVES) {
+        long aosS, losS;
+        int passes;
+        passShift(epoch, km, aosS, losS, passes);
+        printf("%8.2f %8ld %8ld %7d\n", km, aosS, losS, passes);
+    }
+    int jitterRebuilds, moveRebuilds, typedRebuilds;
+    runJitter(epoch, 20, 5, jitterRebuilds, moveRebuilds, typedRebuilds);
+    printf("30 fixes with 20 m of jitter: %d schedule rebuilds; then a 5 km move: %d (SITE_MOVE_KM %.1f)\n",
+           jitterRebuilds, moveRebuilds, SITE_MOVE_KM);
+    printf("a site typed in 300 m away: %d\n", typedRebuilds);
+
+    bool queued;
+    double loadedMs;
+    runFlood(epoch, 1000, queued, loadedMs);
+    printf("1000 site updates during a 7 day search, then a satellite pick: %s, loaded after %.0f ms\n",
+           queued ? "queued" : "DROPPED", loadedMs);
+}
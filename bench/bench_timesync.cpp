@@ -0,0 +1,223 @@
+#include <Arduino.h>
+#include <math.h>
+#include <string>
+#include <sys/time.h>
+#include <time.h>
+
+#include "bench.h"
+#include "civil.h"
+#include "config.h"
+#include "timesync.h"
+
+// --- GPS TIME ---
+// First the date conversion: unixFromCivil() against timegm() over random
+// dates, and what one conversion costs next to the old TZ swap around
+// mktime() in syncTimeFromGPS() and the year loop the TLE reader used.
+//
+// Then an hour of clock discipline on a simulated clock that drifts 40 ppm
+// and starts 800 ms off. An RMC arrives every second 45 ms after the second
+// it names; loop() sees it up to 20 ms later, sometimes after a stall, and
+// syncs once a minute. Once the old way (step to the whole second, sub-
+// second and age dropped) and once through timesync.cpp, sampling the
+// clock's error every 10 ms.
+
+// --- CONVERSION ---
+static time_t oldTzMktime(struct tm t) {
+    std::string oldTz = getenv("TZ") ? getenv("TZ") : "";
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    time_t utc = mktime(&t);
+    if (oldTz.length() > 0) setenv("TZ", oldTz.c_str(), 1);
+    else unsetenv("TZ");
+    tzset();
+    return utc;
+}
+
+static double oldYearLoop(int year, double dayOfYear) {
+    long days = 0;
+    for (int y = 1970; y < year; y++) days += ((y % 4 == 0 && y % 100 != 0) || y % 400 == 0) ? 366 : 365;
+    return (days + dayOfYear - 1.0) * 86400.0;
+}
+
+static void conversion() {
+    const int N = 200000;
+    static struct tm dates[N];
+    uint32_t seed = 2026;
+    for (int i = 0; i < N; i++) {
+        seed = seed * 1664525 + 1013904223;
+        time_t t = (time_t)((seed >> 1) % 4102444800UL);  // 1970-2099
+        gmtime_r(&t, &dates[i]);
+    }
+
+    int mismatches = 0;
+    for (int i = 0; i < N; i++) {
+        struct tm t = dates[i];
+        int64_t ours = unixFromCivil(t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec);
+        if (ours != (int64_t)timegm(&t)) mismatches++;
+    }
+    printf("unixFromCivil vs timegm, %d dates 1970-2099: %d mismatches\n", N, mismatches);
+
+    volatile int64_t sink = 0;
+    double t0 = benchSeconds();
+    for (int i = 0; i < N; i++) {
+        const struct tm &t = dates[i];
+        sink += unixFromCivil(t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec);
+    }
+    double civilNs = (benchSeconds() - t0) / N * 1e9;
+
+    const int M = 20000;
+    t0 = benchSeconds();
+    for (int i = 0; i < M; i++) sink += oldTzMktime(dates[i]);
+    double tzNs = (benchSeconds() - t0) / M * 1e9;
+
+    t0 = benchSeconds();
+    for (int i = 0; i < N; i++) sink += (int64_t)oldYearLoop(dates[i].tm_year + 1900, dates[i].tm_yday + 1);
+    double loopNs = (benchSeconds() - t0) / N * 1e9;
+
+    printf("ns per conversion: unixFromCivil %.1f, TZ=UTC0 + mktime + restore %.0f, year loop (old TLE epoch) %.1f\n",
+           civilNs, tzNs, loopNs);
+}
+
+// --- DISCIPLINE ---
+#define SIM_SECONDS   3600
+#define SAMPLE_MS     10
+#define DRIFT_PPM     40
+#define START_OFF_S   0.8
+#define RMC_LATE_MS   45      // Sentence end after the second it names
+#define PICKUP_MAX_MS 20      // loop() sees the event within a pass
+#define STALL_MS      300     // Every 7th sync waits behind a stall
+#define SLEW_PER_S    0.1     // The fake clock slews at most this much a second
+
+static double simT = 0;             // True time, s since the run started
+static const double BASE_UNIX = 1773489600;  // 2026-03-14 12:00:00 UTC
+static double sysAtLast = 0, lastT = 0, slewLeft = 0;
+
+static void advance() {
+    double dt = simT - lastT;
+    sysAtLast += dt * (1 + DRIFT_PPM * 1e-6);
+    double step = dt * SLEW_PER_S;
+    if (fabs(slewLeft) <= step) {
+        sysAtLast += slewLeft;
+        slewLeft = 0;
+    } else {
+        sysAtLast += slewLeft > 0 ? step : -step;
+        slewLeft += slewLeft > 0 ? -step : step;
+    }
+    lastT = simT;
+}
+
+static double fakeNow() {
+    advance();
+    return sysAtLast;
+}
+
+static void fakeStep(double unixtime) {
+    advance();
+    sysAtLast = unixtime;
+    slewLeft = 0;
+}
+
+static void fakeSlew(double seconds) {
+    advance();
+    slewLeft = seconds;
+}
+
+static unsigned long simMillis() {
+    return (unsigned long)(simT * 1000);
+}
+
+static const TimeSyncDriver FAKE_CLOCK = {fakeNow, fakeStep, fakeSlew};
+
+struct SyncRun {
+    double maxErrMs, sumErrMs;
+    unsigned long samples;
+    int backwards;
+    double worstBackMs;
+    int steps, slews;
+};
+
+// `mode`: 0 = old whole-second step, 1 = timesync, 2 = timesync with the
+// sentence lateness calibrated out (as GPS_TIME_LAG_MS = RMC_LATE_MS)
+static SyncRun runSync(int mode) {
+    simT = lastT = 0;
+    sysAtLast = BASE_UNIX + START_OFF_S;
+    slewLeft = 0;
+    timeSyncBegin(&FAKE_CLOCK, simMillis);
+    SyncRun r = {};
+    uint32_t seed = 31337;
+    double prevSys = sysAtLast;
+    int syncs = 0;
+
+    // The RMC naming second k, when it arrived and when loop() got to it
+    long k = 0;
+    double arrived = 0, seen = 0;
+    auto nextFix = [&](long second) {
+        k = second;
+        seed = seed * 1664525 + 1013904223;
+        arrived = k + (RMC_LATE_MS + (seed >> 8) % 5) / 1000.0;
+        seen = arrived + ((seed >> 16) % PICKUP_MAX_MS) / 1000.0;
+        if (++syncs % 7 == 0) seen += STALL_MS / 1000.0;
+    };
+    nextFix(1);
+
+    for (long ms = 0; ms <= SIM_SECONDS * 1000L; ms += SAMPLE_MS) {
+        if (ms / 1000.0 >= seen) {
+            simT = seen;
+            if (mode == 0) {
+                fakeStep(BASE_UNIX + k);
+                r.steps++;
+            } else {
+                NmeaFix fix = {};
+                fix.timeValid = true;
+                time_t secs = (time_t)(BASE_UNIX + k);
+                struct tm t;
+                gmtime_r(&secs, &t);
+                fix.year = t.tm_year + 1900;
+                fix.month = t.tm_mon + 1;
+                fix.day = t.tm_mday;
+                fix.hour = t.tm_hour;
+                fix.minute = t.tm_min;
+                fix.second = t.tm_sec;
+                fix.millis = mode == 2 ? RMC_LATE_MS : 0;
+                fix.timeAtMs = (unsigned long)(arrived * 1000);
+                TimeSyncResult res = timeSyncFromGps(fix);
+                if (res == TIMESYNC_STEPPED) r.steps++;
+                if (res == TIMESYNC_SLEWED) r.slews++;
+            }
+            nextFix(k + 60);
+        }
+        simT = ms / 1000.0;
+
+        double sys = fakeNow();
+        if (sys < prevSys) {
+            r.backwards++;
+            double back = (prevSys - sys) * 1000;
+            if (back > r.worstBackMs) r.worstBackMs = back;
+        }
+        prevSys = sys;
+        if (simT > 5) {
+            double err = fabs(sys - (BASE_UNIX + simT)) * 1000;
+            if (err > r.maxErrMs) r.maxErrMs = err;
+            r.sumErrMs += err;
+            r.samples++;
+        }
+    }
+    return r;
+}
+
+static void printSync(const char *name, const SyncRun &r) {
+    printf("%-30s %8.1f %8.1f %6d %6d %10d %9.1f\n", name, r.sumErrMs / r.samples, r.maxErrMs, r.steps, r.slews,
+           r.backwards, r.worstBackMs);
+}
+
+void benchTimeSync() {
+    conversion();
+
+    printf("\n%d s, clock %d ppm fast and %.0f ms off at the start; error after the first 5 s\n", SIM_SECONDS,
+           DRIFT_PPM, START_OFF_S * 1000);
+    printf("%-30s %8s %8s %6s %6s %10s %9s\n", "", "avg ms", "max ms", "steps", "slews", "backwards",
+           "worst ms");
+    printSync("whole-second step (old)", runSync(0));
+    printSync("timesync", runSync(1));
+    printSync("timesync, lag calibrated", runSync(2));
+}
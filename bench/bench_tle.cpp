@@ -0,0 +1,113 @@
+#include <Arduino.h>
+
+#include "bench.h"
+#include "tle_reader.h"
+
+// --- TLE INGEST ---
+// A synthetic CelesTrak group file read two ways:
+//  - "String": the pre-streaming path. readFileFromSD() grew a String one
+//    char at a time, then indexOf/substring/trim/toFloat picked it apart.
+//  - "stream": tle_reader fed 512-byte chunks, as readTLEFromSD() does.
+// Peak heap is measured on top of the catalog text itself.
+
+static const int CATALOG_RECORDS = 20000;
+static const size_t CHUNK = 512;
+
+// Old parseTLEData(), one record at a time from the whole-file String
+struct LegacyElements {
+    float inc, raan, ecc, argp;
+    char line1[130], line2[130];
+};
+
+static int legacyParse(const char *text, size_t len) {
+    String content;
+    for (size_t i = 0; i < len; i++) content += text[i];  // readFileFromSD()
+
+    static LegacyElements el;
+    int records = 0;
+    int pos = 0;
+    for (;;) {
+        int firstNL = content.indexOf('\n', pos);
+        if (firstNL < 0) break;
+        int secondNL = content.indexOf('\n', firstNL + 1);
+        if (secondNL < 0) break;
+        int thirdNL = content.indexOf('\n', secondNL + 1);
+        if (thirdNL < 0) thirdNL = content.length();
+
+        String name = content.substring(pos, firstNL);
+        name.trim();
+        String t1 = content.substring(firstNL + 1, secondNL);
+        String t2 = content.substring(secondNL + 1, thirdNL);
+        t1.trim();
+        t2.trim();
+        pos = thirdNL + 1;
+        if (t1.length() < 69 || t2.length() < 69) continue;
+
+        el.inc  = t2.substring(8, 16).toFloat();
+        el.raan = t2.substring(17, 25).toFloat();
+        el.ecc  = t2.substring(26, 33).toFloat() / 10000000.0f;
+        el.argp = t2.substring(34, 42).toFloat();
+        t1.toCharArray(el.line1, sizeof(el.line1));
+        t2.toCharArray(el.line2, sizeof(el.line2));
+        records++;
+    }
+    return records;
+}
+
+static bool countRecord(const TleRecord &, void *ctx) {
+    (*(int *)ctx)++;
+    return true;
+}
+
+static int streamParse(const char *text, size_t len, TleReader &reader) {
+    int records = 0;
+    tleReaderInit(reader);
+    for (size_t off = 0; off < len; off += CHUNK) {
+        size_t n = (len - off < CHUNK) ? len - off : CHUNK;
+        tleReaderFeed(reader, text + off, n, countRecord, &records);
+    }
+    tleReaderFinish(reader, countRecord, &records);
+    return records;
+}
+
+void benchTle() {
+    size_t len;
+    char *catalog = benchBuildGroupFile(CATALOG_RECORDS, len);
+    printf("\n-- group file ingest (%d records, %.1f MB)\n", CATALOG_RECORDS, len / 1e6);
+    printf("%-8s %10s %12s %12s %10s\n", "path", "records", "records/sec", "peak heap", "allocs");
+
+    {
+        benchResetPeak();
+        BenchHeap h0 = benchHeap();
+        double t0 = benchSeconds();
+        int records = legacyParse(catalog, len);
+        double dt = benchSeconds() - t0;
+        BenchHeap h1 = benchHeap();
+        printf("%-8s %10d %12.0f %12zu %10lu\n", "String", records, records / dt,
+               h1.peak - h0.live, h1.allocs - h0.allocs);
+    }
+    {
+        static TleReader reader;
+        benchResetPeak();
+        BenchHeap h0 = benchHeap();
+        double t0 = benchSeconds();
+        int records = streamParse(catalog, len, reader);
+        double dt = benchSeconds() - t0;
+        BenchHeap h1 = benchHeap();
+        printf("%-8s %10d %12.0f %12zu %10lu\n", "stream", records, records / dt,
+               h1.peak - h0.live, h1.allocs - h0.allocs);
+        printf("reader state %zu bytes, %lu bad checksums, %lu bad lines\n",
+               sizeof(TleReader), reader.badChecksums, reader.badLines);
+    }
+
+    // Corrupt one digit per 100 records: the reader must drop exactly those
+    for (int i = 0; i < CATALOG_RECORDS; i += 100) {
+        char *l2 = catalog;
+        for (int k = 0; k < i * 3 + 2; k++) l2 = strchr(l2, '\n') + 1;
+        l2[18] = (l2[18] == '9') ? '8' : l2[18] + 1;
+    }
+    static TleReader reader;
+    int records = streamParse(catalog, len, reader);
+    printf("with 1%% corrupted: %d records, %lu bad checksums\n", records, reader.badChecksums);
+    free(catalog);
+}
@@ -0,0 +1,21 @@
+#include "Arduino.h"
+#include <chrono>
+#include <thread>
+
+HostSerial Serial;
+
+static const auto hostStart = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - hostStart).count();
+}
+
+unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - hostStart).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
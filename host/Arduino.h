@@ -0,0 +1,55 @@
+#pragma once
+// Minimal Arduino stand-in for the [env:native] host build.
+// Only what orbit.cpp and the SGP4 library actually touch lives here.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+#include <time.h>
+
+#include "WString.h"
+
+#ifndef PI
+#define PI         3.1415926535897932384626433832795
+#endif
+#define HALF_PI    1.5707963267948966192313216916398
+#define TWO_PI     6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+inline long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+template <typename T, typename L, typename H>
+inline T constrain(T x, L lo, H hi) {
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+// Serial goes to stdout so library debug prints still show up.
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+    size_t print(const char *s) { return fputs(s, stdout) >= 0 ? strlen(s) : 0; }
+    size_t print(const String &s) { return print(s.c_str()); }
+    size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t println(const char *s = "") { size_t n = print(s); putchar('\n'); return n + 1; }
+    size_t println(const String &s) { return println(s.c_str()); }
+    size_t println(double v, int digits = 2) { size_t n = print(v, digits); putchar('\n'); return n + 1; }
+    size_t println(long v) { size_t n = print(v); putchar('\n'); return n + 1; }
+    template <typename... Args>
+    size_t printf(const char *fmt, Args... args) { return ::printf(fmt, args...); }
+};
+
+extern HostSerial Serial;
@@ -0,0 +1,99 @@
+#pragma once
+// Heap-backed String matching the Arduino API subset used by the tracker.
+// Allocation behaviour deliberately mirrors the real class (one malloc per
+// copy/concat) so the host benchmark's allocation counts stay meaningful.
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+class String {
+public:
+    String(const char *s = "") { assign(s ? s : "", s ? strlen(s) : 0); }
+    String(const String &o) { assign(o.buf, o.len); }
+    String(char c) { assign(&c, 1); }
+    explicit String(int v) { char t[16]; snprintf(t, sizeof(t), "%d", v); assign(t, strlen(t)); }
+    explicit String(long v) { char t[24]; snprintf(t, sizeof(t), "%ld", v); assign(t, strlen(t)); }
+    explicit String(unsigned long v) { char t[24]; snprintf(t, sizeof(t), "%lu", v); assign(t, strlen(t)); }
+    explicit String(double v, unsigned int digits = 2) {
+        char t[40]; snprintf(t, sizeof(t), "%.*f", (int)digits, v); assign(t, strlen(t));
+    }
+    ~String() { free(buf); }
+
+    String &operator=(const String &o) {
+        if (this != &o) { free(buf); assign(o.buf, o.len); }
+        return *this;
+    }
+    String &operator=(const char *s) { free(buf); assign(s ? s : "", s ? strlen(s) : 0); return *this; }
+
+    String &operator+=(const String &o) { return append(o.buf, o.len); }
+    String &operator+=(const char *s) { return append(s, strlen(s)); }
+    String &operator+=(char c) { return append(&c, 1); }
+    friend String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+    friend String operator+(const String &a, const char *b) { String r(a); r += b; return r; }
+    friend String operator+(const char *a, const String &b) { String r(a); r += b; return r; }
+
+    bool operator==(const String &o) const { return len == o.len && memcmp(buf, o.buf, len) == 0; }
+    bool operator==(const char *s) const { return strcmp(buf, s) == 0; }
+    bool operator!=(const String &o) const { return !(*this == o); }
+    bool operator!=(const char *s) const { return !(*this == s); }
+    char operator[](unsigned int i) const { return i < len ? buf[i] : 0; }
+
+    unsigned int length() const { return len; }
+    bool isEmpty() const { return len == 0; }
+    const char *c_str() const { return buf; }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        if (from >= len) return -1;
+        const char *p = (const char *)memchr(buf + from, c, len - from);
+        return p ? (int)(p - buf) : -1;
+    }
+    String substring(unsigned int from) const { return substring(from, len); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) { unsigned int t = from; from = to; to = t; }
+        if (to > len) to = len;
+        if (from > len) from = len;
+        String r;
+        free(r.buf);
+        r.assign(buf + from, to - from);
+        return r;
+    }
+    void trim() {
+        unsigned int b = 0, e = len;
+        while (b < e && isspace((unsigned char)buf[b])) b++;
+        while (e > b && isspace((unsigned char)buf[e - 1])) e--;
+        memmove(buf, buf + b, e - b);
+        len = e - b;
+        buf[len] = 0;
+    }
+    void remove(unsigned int index) { if (index < len) { len = index; buf[len] = 0; } }
+    long toInt() const { return atol(buf); }
+    float toFloat() const { return (float)atof(buf); }
+    void toCharArray(char *out, unsigned int size) const {
+        if (!size) return;
+        unsigned int n = len < size - 1 ? len : size - 1;
+        memcpy(out, buf, n);
+        out[n] = 0;
+    }
+
+private:
+    char *buf = nullptr;
+    unsigned int len = 0;
+
+    void assign(const char *s, unsigned int n) {
+        buf = (char *)malloc(n + 1);
+        memcpy(buf, s, n);
+        buf[n] = 0;
+        len = n;
+    }
+    String &append(const char *s, unsigned int n) {
+        char *nb = (char *)realloc(buf, len + n + 1);
+        if (!nb) return *this;
+        buf = nb;
+        memcpy(buf + len, s, n);
+        len += n;
+        buf[len] = 0;
+        return *this;
+    }
+};
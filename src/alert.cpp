@@ -0,0 +1,135 @@
+#include "alert.h"
+#include "config.h"
+
+#ifndef NATIVE_BUILD
+#include <M5Cardputer.h>
+#endif
+
+struct AlertTune {
+    const AlertNote *notes;
+    uint8_t count;
+};
+
+static const AlertNote COUNTDOWN_NOTES[] = PRE_AOS_BEEP;
+static const AlertNote LOS_NOTES[] = LOS_TONE;
+static const AlertNote AOS_NOTES[] = AOS_MELODY;
+
+#define TUNE(notes) {notes, sizeof(notes) / sizeof(notes[0])}
+static const AlertTune TUNES[ALERT_COUNT] = {
+    TUNE(COUNTDOWN_NOTES),
+    TUNE(LOS_NOTES),
+    TUNE(AOS_NOTES),
+};
+
+// --- BOARD SPEAKER ---
+#ifndef NATIVE_BUILD
+static void boardTone(uint16_t freqHz, uint32_t ms) {
+    M5Cardputer.Speaker.tone(freqHz, ms);
+}
+
+static void boardStop() {
+    M5Cardputer.Speaker.stop();
+}
+
+static const AlertSpeaker BOARD_SPEAKER = {boardTone, boardStop};
+#endif
+
+// --- SEQUENCER ---
+static const AlertSpeaker *speaker = nullptr;
+static unsigned long (*clockFn)() = nullptr;
+
+static bool playing = false;
+static Alert current;
+static int noteIndex = 0;
+static unsigned long nextAt = 0;      // When the next note (or the end) is due
+
+static Alert queue[ALERT_QUEUE];
+static int queueCount = 0;
+
+static unsigned long now() {
+    return clockFn ? clockFn() : millis();
+}
+
+void alertBegin(const AlertSpeaker *spk, unsigned long (*clock)()) {
+#ifndef NATIVE_BUILD
+    if (!spk) spk = &BOARD_SPEAKER;
+#endif
+    speaker = spk;
+    clockFn = clock;
+    playing = false;
+    queueCount = 0;
+}
+
+static void start(Alert alert) {
+    playing = true;
+    current = alert;
+    noteIndex = 0;
+    nextAt = now();
+}
+
+void alertPlay(Alert alert) {
+    if (!speaker) return;
+    if (!playing) {
+        start(alert);
+        return;
+    }
+    if (alert == current) return;
+    if (alert > current) {
+        speaker->stop();
+        start(alert);
+        return;
+    }
+    for (int i = 0; i < queueCount; i++) {
+        if (queue[i] == alert) return;  // Already coming
+    }
+    if (queueCount == ALERT_QUEUE) return;
+    queue[queueCount++] = alert;
+}
+
+void alertStop() {
+    if (playing && speaker) speaker->stop();
+    playing = false;
+    queueCount = 0;
+}
+
+bool alertBusy() {
+    return playing;
+}
+
+// The most urgent queued alert, taken off the queue
+static bool dequeue(Alert &alert) {
+    if (queueCount == 0) return false;
+    int best = 0;
+    for (int i = 1; i < queueCount; i++) {
+        if (queue[i] > queue[best]) best = i;
+    }
+    alert = queue[best];
+    for (int i = best; i < queueCount - 1; i++) queue[i] = queue[i + 1];
+    queueCount--;
+    return true;
+}
+
+unsigned long alertPoll() {
+    if (!playing) return 0;
+    unsigned long t = now();
+    if ((long)(t - nextAt) < 0) return nextAt - t;
+
+    const AlertTune &tune = TUNES[current];
+    if (noteIndex == tune.count) {
+        Alert next;
+        if (!dequeue(next)) {
+            playing = false;
+            return 0;
+        }
+        start(next);
+        return alertPoll();
+    }
+
+    const AlertNote &n = tune.notes[noteIndex++];
+    if (n.freqHz) speaker->tone(n.freqHz, n.ms);
+    // Timed from when it was due, so a late poll doesn't stretch the tune
+    nextAt += n.ms + n.gapMs;
+    if ((long)(t - nextAt) > 0) nextAt = t;
+    unsigned long left = nextAt - t;
+    return left ? left : 1;
+}
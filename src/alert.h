@@ -0,0 +1,44 @@
+#pragma once
+#include <Arduino.h>
+
+// --- ALERTS ---
+// Tones play as data, one note at a time: alertPoll() starts whatever is
+// due and says when to call it again, so nothing waits on a delay() and
+// the loop keeps drawing while a melody plays. A higher-priority alert
+// cuts the current one off; anything else queues behind it.
+//
+// The speaker sits behind an AlertSpeaker: the Cardputer's on the device,
+// a recorder in the host bench.
+
+#define ALERT_QUEUE 4
+
+// In priority order, lowest first
+enum Alert : uint8_t {
+    ALERT_COUNTDOWN,    // Pre-AOS beep
+    ALERT_LOS,
+    ALERT_AOS,
+    ALERT_COUNT
+};
+
+// freqHz 0 is a rest
+struct AlertNote {
+    uint16_t freqHz;
+    uint16_t ms;
+    uint16_t gapMs;     // Silence after it
+};
+
+// tone() must return at once and play for `ms` on its own
+struct AlertSpeaker {
+    void (*tone)(uint16_t freqHz, uint32_t ms);
+    void (*stop)();
+};
+
+// nullptr = the board's speaker (the host build has none) / millis()
+void alertBegin(const AlertSpeaker *speaker = nullptr, unsigned long (*clock)() = nullptr);
+
+void alertPlay(Alert alert);
+void alertStop();           // Silence, and forget anything queued
+bool alertBusy();
+
+// Starts the notes that are due; ms until the next one, or 0 once silent
+unsigned long alertPoll();
@@ -0,0 +1,232 @@
+#include "catalog.h"
+#include <cmath>
+
+// Coefficient rows. Each is `capacity` floats in one block, so the gather
+// for satellite i reads the same offset in every row.
+enum CatalogCoeff {
+    CC_NO, CC_ECCO, CC_INCLO, CC_BSTAR,
+    CC_CC1, CC_CC4, CC_CC5, CC_D2, CC_D3, CC_D4,
+    CC_T2COF, CC_T3COF, CC_T4COF, CC_T5COF,
+    CC_ETA, CC_DELMO, CC_SINMAO, CC_OMGCOF, CC_XMCOF, CC_NODECF,
+    CC_CON41, CC_X1MTH2, CC_X7THM1, CC_XLCOF, CC_AYCOF,
+    CC_COUNT
+};
+
+static_assert(CC_COUNT == CATALOG_COEFF_COUNT, "one row per coefficient");
+
+float NearEarthCoeffs<float>::*const CATALOG_COEFFS[CATALOG_COEFF_COUNT] = {
+    &NearEarthCoeffs<float>::no,     &NearEarthCoeffs<float>::ecco,   &NearEarthCoeffs<float>::inclo,
+    &NearEarthCoeffs<float>::bstar,  &NearEarthCoeffs<float>::cc1,    &NearEarthCoeffs<float>::cc4,
+    &NearEarthCoeffs<float>::cc5,    &NearEarthCoeffs<float>::d2,     &NearEarthCoeffs<float>::d3,
+    &NearEarthCoeffs<float>::d4,     &NearEarthCoeffs<float>::t2cof,  &NearEarthCoeffs<float>::t3cof,
+    &NearEarthCoeffs<float>::t4cof,  &NearEarthCoeffs<float>::t5cof,  &NearEarthCoeffs<float>::eta,
+    &NearEarthCoeffs<float>::delmo,  &NearEarthCoeffs<float>::sinmao, &NearEarthCoeffs<float>::omgcof,
+    &NearEarthCoeffs<float>::xmcof,  &NearEarthCoeffs<float>::nodecf, &NearEarthCoeffs<float>::con41,
+    &NearEarthCoeffs<float>::x1mth2, &NearEarthCoeffs<float>::x7thm1, &NearEarthCoeffs<float>::xlcof,
+    &NearEarthCoeffs<float>::aycof,
+};
+
+static int capacity = 0;
+static int count = 0;
+static long rejected = 0;
+static void *block = nullptr;
+static size_t blockBytes = 0;
+
+// Secular terms: the first pass only touches these
+static double *epochUnix;
+static float *mo, *mdot, *argpo, *argpdot, *nodeo, *nodedot;
+// ...and writes these for the second
+static float *tsince, *xmdf, *argpdf, *nodedf;
+
+static float *coeffs;         // CC_COUNT rows of `capacity`
+static uint8_t *simple;
+static float *posX, *posY, *posZ;
+static uint8_t *posValid;
+static char (*names)[CATALOG_NAME_MAX];
+
+static double propagatedAt = -1;
+
+static SatElements scratch;   // Only used while compiling; too big for a stack
+
+void catalogEnd() {
+    free(block);
+    block = nullptr;
+    blockBytes = 0;
+    capacity = count = 0;
+    rejected = 0;
+    propagatedAt = -1;
+}
+
+// Hands out `n` bytes of the block, 8-byte aligned
+static void *carve(uint8_t *&cursor, size_t n) {
+    void *p = cursor;
+    cursor += (n + 7) & ~(size_t)7;
+    return p;
+}
+
+bool catalogBegin(int cap) {
+    catalogEnd();
+    if (cap <= 0) return false;
+
+    size_t n = cap;
+    size_t bytes = 0;
+    bytes += (n * sizeof(double) + 7) & ~(size_t)7;
+    bytes += 10 * ((n * sizeof(float) + 7) & ~(size_t)7);
+    bytes += CC_COUNT * n * sizeof(float);
+    bytes += 3 * ((n * sizeof(float) + 7) & ~(size_t)7);
+    bytes += 2 * ((n + 7) & ~(size_t)7);
+    bytes += (n * CATALOG_NAME_MAX + 7) & ~(size_t)7;
+
+    block = malloc(bytes);
+    if (!block) return false;
+    blockBytes = bytes;
+    capacity = cap;
+
+    uint8_t *cursor = (uint8_t *)block;
+    epochUnix = (double *)carve(cursor, n * sizeof(double));
+    mo        = (float *)carve(cursor, n * sizeof(float));
+    mdot      = (float *)carve(cursor, n * sizeof(float));
+    argpo     = (float *)carve(cursor, n * sizeof(float));
+    argpdot   = (float *)carve(cursor, n * sizeof(float));
+    nodeo     = (float *)carve(cursor, n * sizeof(float));
+    nodedot   = (float *)carve(cursor, n * sizeof(float));
+    tsince    = (float *)carve(cursor, n * sizeof(float));
+    xmdf      = (float *)carve(cursor, n * sizeof(float));
+    argpdf    = (float *)carve(cursor, n * sizeof(float));
+    nodedf    = (float *)carve(cursor, n * sizeof(float));
+    coeffs    = (float *)carve(cursor, CC_COUNT * n * sizeof(float));
+    posX      = (float *)carve(cursor, n * sizeof(float));
+    posY      = (float *)carve(cursor, n * sizeof(float));
+    posZ      = (float *)carve(cursor, n * sizeof(float));
+    simple    = (uint8_t *)carve(cursor, n);
+    posValid  = (uint8_t *)carve(cursor, n);
+    names     = (char (*)[CATALOG_NAME_MAX])carve(cursor, n * CATALOG_NAME_MAX);
+    return true;
+}
+
+bool catalogCompile(const TleRecord &rec, CatalogElements &out) {
+    if (!loadElements(scratch, rec.name, rec.line1, rec.line2) || !scratch.nearEarth) return false;
+
+    const elsetrec &r = scratch.rec;
+    out.epochUnix = scratch.epochUnix;
+    out.mo = r.mo;        out.mdot = r.mdot;
+    out.argpo = r.argpo;  out.argpdot = r.argpdot;
+    out.nodeo = r.nodeo;  out.nodedot = r.nodedot;
+    out.coeffs = scratch.coeffsF;
+    return true;
+}
+
+bool catalogAdd(const TleRecord &rec) {
+    if (count >= capacity) return false;
+    CatalogElements el;
+    if (!catalogCompile(rec, el)) {
+        rejected++;
+        return false;
+    }
+    return catalogAddElements(el, rec.name);
+}
+
+bool catalogAddElements(const CatalogElements &el, const char *name) {
+    if (count >= capacity) return false;
+
+    int i = count++;
+    epochUnix[i] = el.epochUnix;
+    mo[i] = el.mo;        mdot[i] = el.mdot;
+    argpo[i] = el.argpo;  argpdot[i] = el.argpdot;
+    nodeo[i] = el.nodeo;  nodedot[i] = el.nodedot;
+    for (int f = 0; f < CC_COUNT; f++) {
+        coeffs[f * capacity + i] = el.coeffs.*CATALOG_COEFFS[f];
+    }
+    simple[i] = el.coeffs.simple;
+    posValid[i] = 0;
+    size_t len = strnlen(name, CATALOG_NAME_MAX - 1);
+    memcpy(names[i], name, len);
+    names[i][len] = 0;
+    return true;
+}
+
+int catalogCount() { return count; }
+int catalogCapacity() { return capacity; }
+long catalogRejected() { return rejected; }
+void catalogNoteRejected(long n) { rejected += n; }
+size_t catalogBytes() { return blockBytes; }
+
+void catalogPropagate(double unixTime) {
+    const float twoPi = (float)TWO_PI;
+
+    // Pass 1: secular angles. The epoch difference is taken in double (unix
+    // seconds don't fit a float); the angles themselves are float, which
+    // costs a few hundred metres along-track on week-old elements -
+    // invisible in an az/el list.
+    for (int i = 0; i < count; i++) {
+        float t = (float)((unixTime - epochUnix[i]) / 60.0);
+        tsince[i] = t;
+        xmdf[i] = fmodf(mo[i] + mdot[i] * t, twoPi);
+        argpdf[i] = fmodf(argpo[i] + argpdot[i] * t, twoPi);
+        nodedf[i] = fmodf(nodeo[i] + nodedot[i] * t, twoPi);
+    }
+
+    // Pass 2: the periodic terms and Kepler solve, one satellite at a time
+    NearEarthCoeffs<float> c;
+    for (int i = 0; i < count; i++) {
+        for (int f = 0; f < CC_COUNT; f++) c.*CATALOG_COEFFS[f] = coeffs[f * capacity + i];
+        c.simple = simple[i];
+
+        float r[3], v[3];
+        posValid[i] = sgp4NearEarthCore<float>(c, xmdf[i], argpdf[i], nodedf[i], tsince[i], r, v);
+        posX[i] = r[0];
+        posY[i] = r[1];
+        posZ[i] = r[2];
+    }
+    propagatedAt = unixTime;
+}
+
+bool catalogPosition(int index, float r[3]) {
+    if (index < 0 || index >= count || !posValid[index]) return false;
+    r[0] = posX[index];
+    r[1] = posY[index];
+    r[2] = posZ[index];
+    return true;
+}
+
+int catalogOverhead(const Observer &obs, float minElDeg, CatalogSighting *out, int max, int &total) {
+    total = 0;
+    if (propagatedAt < 0 || max <= 0) return 0;
+
+    // One TEME frame for every satellite at this instant
+    TopoFrame f = topoFrame(obs, propagatedAt);
+    float sx = f.site[0], sy = f.site[1], sz = f.site[2];
+    float ux = f.up[0], uy = f.up[1], uz = f.up[2];
+    float sinMin = sinf(minElDeg * (float)DEG_TO_RAD);
+
+    int filled = 0;
+    for (int i = 0; i < count; i++) {
+        if (!posValid[i]) continue;
+        float dx = posX[i] - sx, dy = posY[i] - sy, dz = posZ[i] - sz;
+        float up = ux * dx + uy * dy + uz * dz;
+        if (up <= 0 && minElDeg >= 0) continue;  // Below the horizon, the common case
+
+        float range = sqrtf(dx * dx + dy * dy + dz * dz);
+        float sinEl = up / range;
+        if (sinEl < sinMin) continue;
+        total++;
+
+        // Keep the `max` highest, sorted by insertion
+        float el = asinf(sinEl) * (float)RAD_TO_DEG;
+        if (filled == max && el <= out[max - 1].el) continue;
+        int j = filled < max ? filled++ : max - 1;
+        while (j > 0 && out[j - 1].el < el) {
+            out[j] = out[j - 1];
+            j--;
+        }
+
+        float south = (float)f.south[0] * dx + (float)f.south[1] * dy + (float)f.south[2] * dz;
+        float east = (float)f.east[0] * dx + (float)f.east[1] * dy + (float)f.east[2] * dz;
+        float az = atan2f(east, -south) * (float)RAD_TO_DEG;
+        out[j].index = i;
+        memcpy(out[j].name, names[i], CATALOG_NAME_MAX);
+        out[j].az = az < 0 ? az + 360.0f : az;
+        out[j].el = el;
+    }
+    return filled;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <Arduino.h>
+#include "propagator.h"
+#include "tle_reader.h"
+
+// --- SATELLITE CATALOG ---
+// Many element sets propagated together for "what's up right now". Each
+// SGP4 constant is kept as its own array (structure of arrays), so one tick
+// is a tight sweep of the secular terms over every satellite followed by the
+// single-precision near-Earth kernel, instead of a full SatElements (~730
+// bytes, mostly the library record) per satellite. Deep-space objects
+// (period over 225 min) are not taken; the library path is far too slow to
+// run a few hundred of them every second.
+//
+// Filled once at boot, before orbitTaskStart(); from then on only the orbit
+// worker touches it.
+
+#define CATALOG_NAME_MAX 13   // Enough for the list; longer names are cut
+
+struct CatalogSighting {
+    int index;                // Into the catalog
+    char name[CATALOG_NAME_MAX];
+    float az, el;             // deg
+};
+
+// SGP4-ready elements for one satellite, as the batch keeps them. Plain
+// data, so it can be stored pre-computed (see catalog_file.h).
+struct CatalogElements {
+    double epochUnix;
+    float mo, mdot, argpo, argpdot, nodeo, nodedot;  // Secular terms (rad, per minute)
+    NearEarthCoeffs<float> coeffs;
+};
+
+// The coefficients one at a time, in the order the batch keeps its rows
+#define CATALOG_COEFF_COUNT 25
+extern float NearEarthCoeffs<float>::*const CATALOG_COEFFS[CATALOG_COEFF_COUNT];
+
+// Drops any previous catalog and reserves room for `capacity` satellites
+// (~175 bytes each). Returns false if the memory isn't there.
+bool catalogBegin(int capacity);
+void catalogEnd();
+
+// Runs sgp4init for `rec`; false if deep-space or the elements won't init
+bool catalogCompile(const TleRecord &rec, CatalogElements &out);
+
+// Adds one satellite; false if full, deep-space, or the elements won't init
+bool catalogAdd(const TleRecord &rec);
+bool catalogAddElements(const CatalogElements &el, const char *name);
+
+int catalogCount();
+int catalogCapacity();
+long catalogRejected();       // Deep-space or bad records turned away
+void catalogNoteRejected(long n);  // Ones turned away before catalogAdd()
+size_t catalogBytes();        // Heap held by the arrays
+
+// Propagates every satellite to `unixTime` (TEME, km)
+void catalogPropagate(double unixTime);
+bool catalogPosition(int index, float r[3]);
+
+// Satellites at or above `minElDeg` as of the last catalogPropagate(),
+// highest first. Returns how many of the `max` slots were filled and sets
+// `total` to the number above the limit.
+int catalogOverhead(const Observer &obs, float minElDeg, CatalogSighting *out, int max, int &total);
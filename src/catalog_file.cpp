@@ -0,0 +1,246 @@
+#include "catalog_file.h"
+#include "storage.h"
+
+// --- RECORD LAYOUT ---
+static uint8_t *put32(uint8_t *p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+    return p + 4;
+}
+
+static const uint8_t *get32(const uint8_t *p, uint32_t &v) {
+    v = p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+    return p + 4;
+}
+
+static uint8_t *putFloat(uint8_t *p, float f) {
+    uint32_t v;
+    memcpy(&v, &f, 4);
+    return put32(p, v);
+}
+
+static const uint8_t *getFloat(const uint8_t *p, float &f) {
+    uint32_t v;
+    p = get32(p, v);
+    memcpy(&f, &v, 4);
+    return p;
+}
+
+static uint8_t *putDouble(uint8_t *p, double d) {
+    uint64_t v;
+    memcpy(&v, &d, 8);
+    p = put32(p, (uint32_t)v);
+    return put32(p, (uint32_t)(v >> 32));
+}
+
+static const uint8_t *getDouble(const uint8_t *p, double &d) {
+    uint32_t lo, hi;
+    p = get32(p, lo);
+    p = get32(p, hi);
+    uint64_t v = (uint64_t)hi << 32 | lo;
+    memcpy(&d, &v, 8);
+    return p;
+}
+
+static void packRecord(uint8_t *p, long catalogNumber, const char *name, const CatalogElements &el) {
+    p = put32(p, catalogNumber);
+    memset(p, 0, CATALOG_NAME_MAX - 1);
+    memcpy(p, name, strnlen(name, CATALOG_NAME_MAX - 1));
+    p += CATALOG_NAME_MAX - 1;
+    p = putDouble(p, el.epochUnix);
+    p = putFloat(p, el.mo);
+    p = putFloat(p, el.mdot);
+    p = putFloat(p, el.argpo);
+    p = putFloat(p, el.argpdot);
+    p = putFloat(p, el.nodeo);
+    p = putFloat(p, el.nodedot);
+    for (int f = 0; f < CATALOG_COEFF_COUNT; f++) p = putFloat(p, el.coeffs.*CATALOG_COEFFS[f]);
+    *p = el.coeffs.simple;
+}
+
+// `name` gets CATALOG_NAME_MAX bytes
+static void unpackRecord(const uint8_t *p, char *name, CatalogElements &el) {
+    p += 4;  // Catalog number; the batch doesn't keep it
+    memcpy(name, p, CATALOG_NAME_MAX - 1);
+    name[CATALOG_NAME_MAX - 1] = 0;
+    p += CATALOG_NAME_MAX - 1;
+    p = getDouble(p, el.epochUnix);
+    p = getFloat(p, el.mo);
+    p = getFloat(p, el.mdot);
+    p = getFloat(p, el.argpo);
+    p = getFloat(p, el.argpdot);
+    p = getFloat(p, el.nodeo);
+    p = getFloat(p, el.nodedot);
+    for (int f = 0; f < CATALOG_COEFF_COUNT; f++) p = getFloat(p, el.coeffs.*CATALOG_COEFFS[f]);
+    el.coeffs.simple = *p != 0;
+}
+
+// --- CONVERTER ---
+struct BuildState {
+    StorageFile out;
+    const TleReader *reader;
+    CatalogIndexEntry *index;
+    uint32_t count;
+    uint32_t nearEarth;
+    bool failed;
+};
+
+static uint8_t record[CATALOG_RECORD_BYTES];
+
+static bool writeRecord(const TleRecord &rec, void *ctx) {
+    BuildState *b = (BuildState *)ctx;
+    if (b->count >= CATALOG_FILE_MAX) return false;
+
+    // Deep-space objects are only indexed; the batch doesn't take them
+    CatalogElements el;
+    if (catalogCompile(rec, el)) {
+        packRecord(record, rec.catalogNumber, rec.name, el);
+        if (storageWrite(b->out, record, sizeof(record)) != sizeof(record)) {
+            b->failed = true;
+            return false;
+        }
+        b->nearEarth++;
+    }
+    b->index[b->count].catalogNumber = rec.catalogNumber;
+    b->index[b->count].textOffset = b->reader->recordStart;
+    b->count++;
+    return true;
+}
+
+static int compareEntries(const void *a, const void *b) {
+    uint32_t x = ((const CatalogIndexEntry *)a)->catalogNumber;
+    uint32_t y = ((const CatalogIndexEntry *)b)->catalogNumber;
+    return (x > y) - (x < y);
+}
+
+int catalogFileBuild(const char *tlePath, const char *binPath) {
+    CatalogFileHeader h;
+    memset(&h, 0, sizeof(h));
+    if (!storageStat(tlePath, h.sourceSize, h.sourceTime)) return 0;
+
+    StorageFile in = storageOpen(tlePath, STORAGE_READ);
+    if (!storageOk(in)) return 0;
+
+    static TleReader reader;
+    char tmpPath[64];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", binPath);
+    BuildState b = {storageOpen(tmpPath, STORAGE_WRITE), &reader, nullptr, 0, 0, false};
+    b.index = (CatalogIndexEntry *)malloc(CATALOG_FILE_MAX * sizeof(CatalogIndexEntry));
+    if (!storageOk(b.out) || !b.index) {
+        if (storageOk(b.out)) storageClose(b.out);
+        storageClose(in);
+        free(b.index);
+        return 0;
+    }
+
+    // Placeholder header; the real one goes in once the counts are known
+    storageWrite(b.out, &h, sizeof(h));
+
+    static char chunk[512];
+    tleReaderInit(reader);
+    bool more = true;
+    size_t n;
+    while (more && (n = storageRead(in, chunk, sizeof(chunk))) > 0) {
+        more = tleReaderFeed(reader, chunk, n, writeRecord, &b);
+    }
+    if (more) tleReaderFinish(reader, writeRecord, &b);
+    storageClose(in);
+
+    qsort(b.index, b.count, sizeof(CatalogIndexEntry), compareEntries);
+    h.magic = CATALOG_FILE_MAGIC;
+    h.version = CATALOG_FILE_VERSION;
+    h.recordSize = CATALOG_RECORD_BYTES;
+    h.count = b.count;
+    h.nearEarthCount = b.nearEarth;
+    h.indexOffset = sizeof(h) + b.nearEarth * CATALOG_RECORD_BYTES;
+
+    size_t indexBytes = b.count * sizeof(CatalogIndexEntry);
+    b.failed = b.failed || b.count == 0 ||
+               storageWrite(b.out, b.index, indexBytes) != indexBytes ||
+               !storageSeek(b.out, 0) || storageWrite(b.out, &h, sizeof(h)) != sizeof(h);
+    storageClose(b.out);
+    free(b.index);
+
+    if (b.failed || !storageReplace(tmpPath, binPath)) return 0;
+    return b.count;
+}
+
+// --- READER ---
+static bool openCatalog(const char *binPath, StorageFile &f, CatalogFileHeader &h) {
+    f = storageOpen(binPath, STORAGE_READ);
+    if (!storageOk(f)) return false;
+    if (storageRead(f, &h, sizeof(h)) == sizeof(h) && h.magic == CATALOG_FILE_MAGIC &&
+        h.version == CATALOG_FILE_VERSION && h.recordSize == CATALOG_RECORD_BYTES) {
+        return true;
+    }
+    storageClose(f);
+    return false;
+}
+
+bool catalogFileFresh(const char *tlePath, const char *binPath) {
+    uint32_t size, mtime;
+    if (!storageStat(tlePath, size, mtime)) return false;
+
+    StorageFile f;
+    CatalogFileHeader h;
+    if (!openCatalog(binPath, f, h)) return false;
+    storageClose(f);
+    return h.sourceSize == size && h.sourceTime == mtime;
+}
+
+bool catalogFileFind(const char *tlePath, const char *binPath, long catalogNumber, TleRecord &out) {
+    StorageFile f;
+    CatalogFileHeader h;
+    if (!openCatalog(binPath, f, h)) return false;
+
+    // Binary search straight off the card, one 8-byte read per step
+    uint32_t lo = 0, hi = h.count;
+    bool found = false;
+    CatalogIndexEntry e;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (!storageSeek(f, h.indexOffset + mid * sizeof(e)) || storageRead(f, &e, sizeof(e)) != sizeof(e)) break;
+        if (e.catalogNumber == (uint32_t)catalogNumber) {
+            found = true;
+            break;
+        }
+        if (e.catalogNumber < (uint32_t)catalogNumber) lo = mid + 1;
+        else hi = mid;
+    }
+    storageClose(f);
+    if (!found) return false;
+
+    // One record of text; the number is checked again in case the text
+    // changed since the index was built
+    static char text[3 * (TLE_LINE_MAX + 2)];
+    StorageFile in = storageOpen(tlePath, STORAGE_READ);
+    if (!storageOk(in)) return false;
+    size_t n = storageSeek(in, e.textOffset) ? storageRead(in, text, sizeof(text)) : 0;
+    storageClose(in);
+    return n > 0 && tleParseText(text, n, out, catalogNumber);
+}
+
+int catalogFileLoad(const char *binPath, int capacity) {
+    StorageFile f;
+    CatalogFileHeader h;
+    if (!openCatalog(binPath, f, h)) return 0;
+
+    int want = h.nearEarthCount < (uint32_t)capacity ? h.nearEarthCount : capacity;
+    if (want == 0 || !catalogBegin(want)) {
+        storageClose(f);
+        return 0;
+    }
+    // The file only holds records for near-Earth objects
+    catalogNoteRejected(h.count - h.nearEarthCount);
+    CatalogElements el;
+    char name[CATALOG_NAME_MAX];
+    while (catalogCount() < want) {
+        if (storageRead(f, record, sizeof(record)) != sizeof(record)) break;
+        unpackRecord(record, name, el);
+        catalogAddElements(el, name);
+    }
+    storageClose(f);
+    return catalogCount();
+}
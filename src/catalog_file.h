@@ -0,0 +1,62 @@
+#pragma once
+#include <Arduino.h>
+#include "catalog.h"
+#include "tle_reader.h"
+
+// --- COMPILED CATALOG FILE ---
+// Binary form of a TLE group file, built once whenever the text changes:
+//
+//   header | near-Earth records | index (every satellite, by NORAD number)
+//
+// A record carries only what the batch catalog needs: catalog number, a
+// short name, the epoch and the float SGP4 constants, so boot neither
+// parses text nor runs sgp4init. Records are packed byte by byte
+// (little-endian, no padding), so the file is the same whichever compiler
+// wrote it. The index maps each NORAD number, deep-space objects included,
+// to its offset in the source text: looking one satellite up is a binary
+// search on the card followed by a single read of that TLE.
+
+#define CATALOG_FILE_MAGIC   0x43535349UL   // "ISSC"
+#define CATALOG_FILE_VERSION 2
+#define CATALOG_FILE_MAX     8192           // Records; the index is sorted in RAM (8 bytes each)
+
+// catalogNumber u32 | name[CATALOG_NAME_MAX - 1] | epochUnix f64 |
+// 6 secular terms f32 | CATALOG_COEFF_COUNT coefficients f32 | simple u8
+#define CATALOG_RECORD_BYTES (4 + (CATALOG_NAME_MAX - 1) + 8 + 6 * 4 + CATALOG_COEFF_COUNT * 4 + 1)
+
+struct CatalogFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;     // CATALOG_RECORD_BYTES
+    uint32_t count;          // Index entries
+    uint32_t nearEarthCount; // Records
+    uint32_t indexOffset;
+    uint32_t sourceSize;     // Of the text file it was built from
+    uint32_t sourceTime;     // ...and its modification time
+};
+
+struct CatalogIndexEntry {
+    uint32_t catalogNumber;
+    uint32_t textOffset;     // Of the record in the source text
+};
+
+// Fixed-width fields only, so these are the same size on the host and the ESP32
+static_assert(sizeof(CatalogFileHeader) == 28, "header layout");
+static_assert(sizeof(CatalogIndexEntry) == 8, "index layout");
+
+// The converter: reads `tlePath` in chunks and writes `binPath` via a
+// temporary file, so a failed build leaves the previous one in place.
+// Returns the number of satellites indexed (0 on failure).
+int catalogFileBuild(const char *tlePath, const char *binPath);
+
+// True if `binPath` exists, matches this firmware and was built from the
+// current `tlePath`
+bool catalogFileFresh(const char *tlePath, const char *binPath);
+
+// The full TLE for `catalogNumber`, read from `tlePath` at the offset
+// `binPath` indexes
+bool catalogFileFind(const char *tlePath, const char *binPath, long catalogNumber, TleRecord &out);
+
+// Fills the batch catalog with the file's near-Earth records (at most
+// `capacity`). Returns how many were added.
+int catalogFileLoad(const char *binPath, int capacity);
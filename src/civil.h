@@ -0,0 +1,31 @@
+#pragma once
+#include <stdint.h>
+
+// --- CIVIL DATES ---
+// UTC calendar date -> Unix time without mktime(), the TZ variable or a
+// loop over the years: Howard Hinnant's days_from_civil. Each function is
+// a single expression so they stay constexpr under C++11.
+
+// Years counted from March, so the leap day is the last day of the year
+constexpr long civilEra(long y) {
+    return (y >= 0 ? y : y - 399) / 400;
+}
+
+constexpr long civilDays(long era, long yearOfEra, long dayOfYear) {
+    return era * 146097 + yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear - 719468;
+}
+
+// Days since 1970-01-01; month 1-12, day 1-31
+constexpr long daysFromCivil(long y, unsigned month, unsigned day) {
+    return civilDays(civilEra(y - (month <= 2)), y - (month <= 2) - civilEra(y - (month <= 2)) * 400,
+                     (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1);
+}
+
+constexpr int64_t unixFromCivil(long y, unsigned month, unsigned day, unsigned hour, unsigned minute,
+                                unsigned second) {
+    return (int64_t)daysFromCivil(y, month, day) * 86400 + hour * 3600L + minute * 60L + second;
+}
+
+static_assert(daysFromCivil(1970, 1, 1) == 0, "epoch");
+static_assert(daysFromCivil(2000, 3, 1) == 11017, "after a 400-year leap day");
+static_assert(unixFromCivil(2038, 1, 19, 3, 14, 8) == 2147483648LL, "32-bit rollover");
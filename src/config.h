@@ -1,28 +1,20 @@
 #pragma once
 #include <Arduino.h>
-#include <M5Cardputer.h>
-#include <M5GFX.h>
 
 // App Version
 #define APP_VERSION "v2.5.6"
 
-// --- AUDIO CONFIGURATION (AOS MELODY) ---
-// Define a 4-note rising sequence (Sci-Fi style)
-// Frequencies are in Hz, Durations in ms
+// --- AUDIO CONFIGURATION (ALERTS) ---
+// Each alert is a list of {frequency Hz, duration ms, silence after ms};
+// frequency 0 is a rest. Played by alert.cpp without blocking.
 
-#define NOTE_1_FREQ   880   // A5
-#define NOTE_1_DUR    100
-
-#define NOTE_2_FREQ   1109  // C#6
-#define NOTE_2_DUR    100
-
-#define NOTE_3_FREQ   1318  // E6
-#define NOTE_3_DUR    100
-
-#define NOTE_4_FREQ   1760  // A6 (Long finish)
-#define NOTE_4_DUR    400
-
-#define NOTE_GAP      50    // Silence between notes
+// AOS: a 4-note rising sequence (Sci-Fi style), A5 C#6 E6 A6 (long finish)
+#define AOS_MELODY   { {880, 100, 50}, {1109, 100, 50}, {1318, 100, 50}, {1760, 400, 0} }
+// LOS: falling E6 -> A5
+#define LOS_TONE     { {1318, 120, 40}, {880, 250, 0} }
+// Countdown blip before AOS, at each of PRE_AOS_BEEP_SEC seconds out
+#define PRE_AOS_BEEP { {1760, 40, 0} }
+#define PRE_AOS_BEEP_SEC { 30, 10, 3, 2, 1 }
 
 // ---------- Colors ----------
 #define COL_BG        0x0000  // Black
@@ -36,6 +28,7 @@
 #define GPS_RX_PIN      15  // ESP32 RX (Receives from GPS TX)
 #define GPS_TX_PIN      13  // ESP32 TX (Sends to GPS RX)
 #define GPS_BAUD        115200
+#define GPS_TIME_LAG_MS 0   // Receiver's RMC lateness after the second it names, if measured
 
 // Shared Globals
 extern bool useGpsModule; // New config flag
@@ -59,13 +52,37 @@ extern bool useGpsModule; // New config flag
 
 // ---------- Settings ----------
 #define ISS_TLE_PATH "/apps/iss_tracker/iss.tle"
+#define CATALOG_TLE_PATH "/apps/iss_tracker/catalog.tle"  // Any CelesTrak group file
+#define CATALOG_BIN_PATH "/apps/iss_tracker/catalog.bin"  // Compiled from it at boot
+#define PASS_CACHE_PATH  "/apps/iss_tracker/passes.bin"
+#define SCREENSHOT_DIR   "/satscreenshots"
+#define TLE_DIR          "/apps/iss_tracker/tle"          // Refreshed TLEs, one per satellite
+#define TLE_URL_FORMAT   "https://celestrak.org/NORAD/elements/gp.php?CATNR=%ld&FORMAT=TLE"
+#define PASS_CACHE_SAVE_MS 600000  // Re-save a growing schedule at most every 10 min
+#define INPUT_POLL_MS      20      // Keyboard scan period
+#define GPS_SYNC_MS        60000   // System clock from GPS at most this often
+#define STATUS_ERROR_MS    10000   // A failed update's message stays this long
+#define SNAP_MSG_MS        1500    // A screenshot's size and time stay this long
+#define CATALOG_MAX  300   // Near-Earth satellites kept from it (~52 KB)
 #define OBS_ALT_M    15.0
+#define SITE_MOVE_KM 1.0   // Smaller GPS moves (jitter) keep the site and its passes
 #define DEFAULT_MIN_EL 10  // Default to 10 degree passes
+#define DEFAULT_PASS_DAYS 1  // Pass schedule horizon
+#define MAX_PASS_DAYS     7
+#define LIVE_SCALAR       float  // SGP4 precision for the live position (double = library-exact)
+
+// Loop instrumentation and the hidden diagnostics screen ('d' on a
+// dashboard screen); 0 compiles both out
+#ifndef PERF_ENABLED
+#define PERF_ENABLED      1
+#endif
+#define PERF_WINDOW_MS    1000
 
 // Shared Globals (defined in main.cpp)
 extern double obsLatDeg;
 extern double obsLonDeg;
 extern int tzOffsetHours;
 extern int minElevation;   // New Global
+extern int passHorizonDays;
 extern bool tleParsedOK;
 extern String satName;
\ No newline at end of file
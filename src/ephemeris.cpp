@@ -0,0 +1,148 @@
+#include "ephemeris.h"
+#include "config.h"
+
+struct EphemNode {
+    long index;     // floor(t / EPHEM_NODE_STEP_S); -1 = empty slot
+    float r[3];     // km, TEME
+    float v[3];     // km/s, TEME
+};
+
+static EphemNode baseNodes[EPHEM_CACHE_NODES];
+static EphemNode *nodes = baseNodes;   // Or a heap block for a long horizon
+static long nodeCount = EPHEM_CACHE_NODES;
+static SatElements elements;
+static bool ephemValid = false;
+
+unsigned long ephemNodeFills = 0;
+unsigned long ephemLiveFills = 0;
+
+// Live nodes: the two either side of the last time asked for
+static SatState liveA, liveB;
+static long liveIndex = -1;
+
+void ephemLoad(const SatElements &el) {
+    elements = el;
+    for (long i = 0; i < nodeCount; i++) nodes[i].index = -1;
+    liveIndex = -1;
+    ephemValid = true;
+}
+
+bool ephemReserve(unsigned long spanSecs) {
+    long want = (long)((spanSecs + EPHEM_SPAN_MARGIN_S) / EPHEM_NODE_STEP_S) + 2;
+    if (want < EPHEM_CACHE_NODES) want = EPHEM_CACHE_NODES;
+    if (want == nodeCount) return true;
+
+    EphemNode *grown = baseNodes;
+    if (want > EPHEM_CACHE_NODES) {
+        grown = (EphemNode *)malloc(want * sizeof(EphemNode));
+        if (!grown) return false;
+    }
+
+    // Carry the filled nodes over to their slots in the new ring; when it
+    // shrinks, a collision just leaves one node to be filled again
+    EphemNode *old = nodes;
+    long oldCount = nodeCount;
+    for (long i = 0; i < want; i++) grown[i].index = -1;
+    for (long i = 0; i < oldCount; i++) {
+        if (old[i].index >= 0) grown[old[i].index % want] = old[i];
+    }
+    if (old != baseNodes) free(old);
+    nodes = grown;
+    nodeCount = want;
+    return true;
+}
+
+// Cubic Hermite on position, and its derivative for velocity.
+// `s` is the fraction of the node step `h` past node a.
+template <typename S>
+static void hermite(double s, double h, const S ra[3], const S va[3], const S rb[3], const S vb[3], SatState &out) {
+    double s2 = s * s, s3 = s2 * s;
+    double h00 = 2 * s3 - 3 * s2 + 1;
+    double h10 = s3 - 2 * s2 + s;
+    double h01 = -2 * s3 + 3 * s2;
+    double h11 = s3 - s2;
+    double d00 = (6 * s2 - 6 * s) / h;
+    double d10 = 3 * s2 - 4 * s + 1;
+    double d01 = (-6 * s2 + 6 * s) / h;
+    double d11 = 3 * s2 - 2 * s;
+
+    for (int i = 0; i < 3; i++) {
+        out.r[i] = h00 * ra[i] + h10 * h * va[i] + h01 * rb[i] + h11 * h * vb[i];
+        out.v[i] = d00 * ra[i] + d10 * va[i] + d01 * rb[i] + d11 * vb[i];
+    }
+    out.valid = true;
+}
+
+static const EphemNode *nodeAt(long index) {
+    EphemNode &slot = nodes[index % nodeCount];
+    if (slot.index == index) return &slot;
+
+    SatState s = propagate(elements, index * (double)EPHEM_NODE_STEP_S);
+    ephemNodeFills++;
+    if (!s.valid) return nullptr;
+
+    slot.index = index;
+    for (int i = 0; i < 3; i++) {
+        slot.r[i] = (float)s.r[i];
+        slot.v[i] = (float)s.v[i];
+    }
+    return &slot;
+}
+
+void ephemFill(double fromUnix, double toUnix) {
+    if (!ephemValid || fromUnix < 0) return;
+    long first = (long)(fromUnix / EPHEM_NODE_STEP_S);
+    long last = (long)(toUnix / EPHEM_NODE_STEP_S) + 1;
+    if (last - first >= nodeCount) last = first + nodeCount - 1;
+    for (long k = first; k <= last; k++) nodeAt(k);
+}
+
+SatState ephemState(double unixTime) {
+    SatState out;
+    out.valid = false;
+    out.unixTime = unixTime;
+    if (!ephemValid || unixTime < 0) return out;
+
+    long k = (long)(unixTime / EPHEM_NODE_STEP_S);
+    const EphemNode *a = nodeAt(k);
+    const EphemNode *b = nodeAt(k + 1);
+    // Consecutive indices never share a slot, so `a` is still intact
+    if (!a || !b) return out;
+
+    const double h = EPHEM_NODE_STEP_S;
+    hermite((unixTime - k * h) / h, h, a->r, a->v, b->r, b->v, out);
+    return out;
+}
+
+LookAngles ephemLookAngles(double unixTime, const Observer &obs) {
+    return lookAngles(ephemState(unixTime), obs);
+}
+
+// --- LIVE INTERPOLATOR ---
+static SatState liveNode(long index) {
+    ephemLiveFills++;
+    return propagate<LIVE_SCALAR>(elements, index * (double)LIVE_NODE_STEP_S);
+}
+
+SatState ephemLiveState(double unixTime) {
+    SatState out;
+    out.valid = false;
+    out.unixTime = unixTime;
+    if (!ephemValid || unixTime < 0) return out;
+
+    // Time normally moves forward one step at a time, so slide the pair
+    long k = (long)(unixTime / LIVE_NODE_STEP_S);
+    if (k == liveIndex + 1 && liveIndex >= 0) {
+        liveA = liveB;
+        liveB = liveNode(k + 1);
+    } else if (k != liveIndex) {
+        liveA = liveNode(k);
+        liveB = liveNode(k + 1);
+    }
+    liveIndex = k;
+    if (!liveA.valid || !liveB.valid) return out;
+
+    const double h = LIVE_NODE_STEP_S;
+    hermite((unixTime - k * h) / h, h, liveA.r, liveA.v, liveB.r, liveB.v, out);
+    return out;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <Arduino.h>
+#include "propagator.h"
+
+// --- EPHEMERIS CACHE ---
+// SGP4 state vectors (TEME) sampled on a fixed time grid, cached per TLE.
+// They don't depend on the observer, so a site change only redoes the
+// cheap topocentric step. Positions between nodes come from cubic
+// Hermite interpolation (position + velocity), good to tens of metres.
+
+#define EPHEM_NODE_STEP_S   180
+#define EPHEM_CACHE_NODES   512   // ~25h of contiguous coverage, ~14 KB
+#define EPHEM_SPAN_MARGIN_S 7200  // An hour behind now and an hour past the horizon
+
+// The cache holds EPHEM_CACHE_NODES in static memory. A longer pass horizon
+// moves it to the heap, sized to the horizon (7 days is ~95 KB); going back
+// to a day or less frees that again. If the heap can't give it, the smaller
+// cache stays and a site change re-propagates whatever no longer fits.
+// The pass search fills every node up to its horizon first, so a search
+// for another site finds them all, wherever its skips land. Only a pass
+// running more than an hour past the horizon (Molniya) reaches new ones.
+
+// Live view: same idea over a short horizon, with nodes close enough that
+// 10 Hz updates at millisecond resolution cost one SGP4 call per node step.
+#define LIVE_NODE_STEP_S    10
+
+extern unsigned long ephemNodeFills;   // SGP4 evaluations done to fill the cache
+extern unsigned long ephemLiveFills;   // ...and the live nodes
+
+void ephemLoad(const SatElements &el);
+// Sizes the cache to cover `spanSecs` ahead; false if it couldn't grow
+bool ephemReserve(unsigned long spanSecs);
+// Fills any missing nodes from `fromUnix` to `toUnix` (as many as fit)
+void ephemFill(double fromUnix, double toUnix);
+SatState ephemState(double unixTime);
+LookAngles ephemLookAngles(double unixTime, const Observer &obs);
+SatState ephemLiveState(double unixTime);
@@ -0,0 +1,226 @@
+#include "gps.h"
+#include "config.h"
+#include <atomic>
+
+#ifdef NATIVE_BUILD
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#else
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#define GPS_TASK_STACK    4096
+#define GPS_TASK_CORE     0     // With the orbit worker, above it
+#define GPS_TASK_PRIORITY 2
+
+// --- RING ---
+// One producer (the UART callback), one consumer (the parser). Each side
+// only writes its own index, so neither ever waits on the other.
+static uint8_t ring[GPS_RING_SIZE];
+static std::atomic<uint32_t> ringHead(0);
+static std::atomic<uint32_t> ringTail(0);
+
+static std::atomic<unsigned long> bytesIn(0);
+static std::atomic<unsigned long> ringDropped(0);
+static std::atomic<unsigned long> uartOverflows(0);
+static std::atomic<uint32_t> ringPeak(0);
+
+// --- FIX HANDOFF ---
+// Same triple buffer as the orbit snapshot: the parser publishes whole
+// fixes, the UI swaps in the newest one when it polls
+struct GpsSlot {
+    NmeaFix fix;
+    unsigned long sentences, badChecksums, badLines;
+};
+
+static GpsSlot slots[3];
+static const uint32_t SLOT_FRESH = 0x4;
+static std::atomic<uint32_t> middleSlot(1);
+static uint32_t backSlot = 2;   // Parser side
+static uint32_t frontSlot = 0;  // UI side
+
+static std::atomic<uint32_t> pendingEvents(0);
+static void (*wakeFn)() = nullptr;
+static unsigned long (*clockFn)() = nullptr;
+
+static unsigned long now() {
+    return clockFn ? clockFn() : millis();
+}
+
+static void publish(const GpsSlot &s, uint32_t events) {
+    slots[backSlot] = s;
+    backSlot = middleSlot.exchange(backSlot | SLOT_FRESH) & 0x3;
+    if (!events) return;
+    pendingEvents.fetch_or(events);
+    if (wakeFn) wakeFn();
+}
+
+// --- PLATFORM GLUE ---
+#ifdef NATIVE_BUILD
+static std::mutex parserLock;
+static std::condition_variable parserSignal;
+static bool stopping = false;
+static std::thread parser;
+
+static void signalParser() {
+    std::lock_guard<std::mutex> lock(parserLock);
+    parserSignal.notify_one();
+}
+
+// False once gpsStop() has been called
+static bool waitForBytes() {
+    std::unique_lock<std::mutex> lock(parserLock);
+    parserSignal.wait(lock, [] { return stopping || ringHead.load() != ringTail.load(); });
+    return !stopping;
+}
+#else
+static HardwareSerial gpsSerial(1);  // UART 1
+static TaskHandle_t parserHandle = nullptr;
+static volatile bool stopping = false;
+
+static void signalParser() {
+    if (parserHandle) xTaskNotifyGive(parserHandle);
+}
+
+static bool waitForBytes() {
+    while (!stopping && ringHead.load() == ringTail.load()) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return !stopping;
+}
+
+// Runs on the UART driver's event task whenever bytes arrive
+static void uartReceived() {
+    uint8_t buf[128];
+    size_t n;
+    while ((n = gpsSerial.read(buf, sizeof(buf))) > 0) gpsFeed(buf, n);
+}
+
+static void uartError(hardwareSerial_error_t err) {
+    if (err == UART_BUFFER_FULL_ERROR || err == UART_FIFO_OVF_ERROR) uartOverflows++;
+}
+#endif
+
+void gpsFeed(const uint8_t *data, size_t len) {
+    uint32_t head = ringHead.load(std::memory_order_relaxed);
+    uint32_t room = GPS_RING_SIZE - (head - ringTail.load(std::memory_order_acquire));
+    size_t n = len < room ? len : room;
+    for (size_t i = 0; i < n; i++) ring[(head + i) & (GPS_RING_SIZE - 1)] = data[i];
+    ringHead.store(head + n, std::memory_order_release);
+    bytesIn += len;
+    if (n < len) ringDropped += len - n;
+    if (n) signalParser();
+}
+
+// --- PARSER ---
+static void parserLoop() {
+    NmeaReader reader;
+    GpsSlot s;
+    nmeaReaderInit(reader);
+    memset(&s, 0, sizeof(s));
+    bool detected = false;
+
+    while (waitForBytes()) {
+        uint32_t tail = ringTail.load(std::memory_order_relaxed);
+        uint32_t head = ringHead.load(std::memory_order_acquire);
+        uint32_t fill = head - tail;
+        if (fill > ringPeak.load(std::memory_order_relaxed)) ringPeak.store(fill);
+
+        // At most two contiguous runs: up to the end of the ring, then the rest
+        int changed = 0;
+        while (tail != head) {
+            uint32_t at = tail & (GPS_RING_SIZE - 1);
+            uint32_t run = head - tail;
+            if (run > GPS_RING_SIZE - at) run = GPS_RING_SIZE - at;
+            changed |= nmeaReaderFeed(reader, (const char *)ring + at, run, s.fix);
+            tail += run;
+            ringTail.store(tail, std::memory_order_release);
+        }
+
+        unsigned long t = now();
+        uint32_t events = 0;
+        if (changed & NMEA_LOCATION) {
+            s.fix.locationAtMs = t;
+            events |= GPS_EV_LOCATION;
+        }
+        if (changed & NMEA_TIME) {
+            s.fix.timeAtMs = t;
+            events |= GPS_EV_TIME;
+        }
+        if (!detected && reader.sentences > 0) {
+            detected = true;
+            events |= GPS_EV_DETECTED;
+        }
+        s.sentences = reader.sentences;
+        s.badChecksums = reader.badChecksums;
+        s.badLines = reader.badLines;
+        publish(s, events);
+    }
+}
+
+// --- PUBLIC API ---
+void gpsBegin(void (*wake)(), unsigned long (*clock)()) {
+    wakeFn = wake;
+    clockFn = clock;
+    ringHead = 0;
+    ringTail = 0;
+    bytesIn = 0;
+    ringDropped = 0;
+    uartOverflows = 0;
+    ringPeak = 0;
+    pendingEvents = 0;
+    memset(slots, 0, sizeof(slots));
+    middleSlot = 1;
+    backSlot = 2;
+    frontSlot = 0;
+    stopping = false;
+#ifdef NATIVE_BUILD
+    parser = std::thread(parserLoop);
+#else
+    xTaskCreatePinnedToCore([](void *) { parserLoop(); parserHandle = nullptr; vTaskDelete(nullptr); },
+                            "gps", GPS_TASK_STACK, nullptr, GPS_TASK_PRIORITY, &parserHandle, GPS_TASK_CORE);
+    gpsSerial.setRxBufferSize(GPS_UART_BUFFER);  // Before begin()
+    gpsSerial.begin(GPS_BAUD, SERIAL_8N1, GPS_RX_PIN, GPS_TX_PIN);
+    gpsSerial.onReceiveError(uartError);
+    gpsSerial.onReceive(uartReceived);
+#endif
+}
+
+void gpsStop() {
+#ifdef NATIVE_BUILD
+    {
+        std::lock_guard<std::mutex> lock(parserLock);
+        stopping = true;
+        parserSignal.notify_one();
+    }
+    if (parser.joinable()) parser.join();
+#else
+    gpsSerial.onReceive(nullptr);
+    stopping = true;
+    signalParser();
+#endif
+}
+
+uint32_t gpsPoll() {
+    // Events first: the fix they announce was published before them
+    uint32_t events = pendingEvents.exchange(0);
+    if (middleSlot.load() & SLOT_FRESH) frontSlot = middleSlot.exchange(frontSlot) & 0x3;
+    return events;
+}
+
+const NmeaFix &gpsFix() {
+    return slots[frontSlot].fix;
+}
+
+GpsStats gpsStats() {
+    const GpsSlot &s = slots[frontSlot];
+    GpsStats st;
+    st.bytes = bytesIn;
+    st.sentences = s.sentences;
+    st.badChecksums = s.badChecksums;
+    st.badLines = s.badLines;
+    st.ringDropped = ringDropped;
+    st.uartOverflows = uartOverflows;
+    st.ringPeak = ringPeak;
+    return st;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <Arduino.h>
+#include "nmea.h"
+
+// --- GPS INGEST ---
+// NMEA never waits on loop(). The UART's receive callback copies whatever
+// arrived into a lock-free ring, and a parser task (std::thread on the
+// host) turns it into sentences and publishes the latest fix. loop() only
+// picks up events: a redraw, a stalled keyboard scan or a melody can no
+// longer overrun the UART buffer. Whatever still doesn't fit is counted,
+// not silently lost.
+
+#define GPS_RING_SIZE   2048    // Power of two; ~180 ms at 115200 baud
+#define GPS_UART_BUFFER 1024    // Driver RX buffer in front of the ring
+
+// gpsPoll() events, OR'd together
+#define GPS_EV_DETECTED 0x1     // First sentence with a good checksum
+#define GPS_EV_LOCATION 0x2     // gpsFix() has a new position
+#define GPS_EV_TIME     0x4     // gpsFix() has a new date and time
+
+struct GpsStats {
+    unsigned long bytes;        // Taken off the UART
+    unsigned long sentences;
+    unsigned long badChecksums;
+    unsigned long badLines;
+    unsigned long ringDropped;  // Bytes that didn't fit in the ring
+    unsigned long uartOverflows;// Driver / FIFO overflow reports
+    size_t ringPeak;            // Most bytes ever waiting in the ring
+};
+
+// Opens the UART (the host build has none; the bench calls gpsFeed).
+// `wake` is called on the parser task after each event (to wake loop()).
+// nullptr clock = millis(), used to stamp the fix.
+void gpsBegin(void (*wake)() = nullptr, unsigned long (*clock)() = nullptr);
+void gpsStop();
+
+// Producer side: bytes as they come off the UART. Never blocks.
+void gpsFeed(const uint8_t *data, size_t len);
+
+// Events since the last call. gpsFix() stays stable until the next poll.
+uint32_t gpsPoll();
+const NmeaFix &gpsFix();
+GpsStats gpsStats();
@@ -1,15 +1,26 @@
 #include <M5Cardputer.h>
 #include <WiFi.h>
-#include <HTTPClient.h>
 #include <SD.h>
 #include <Preferences.h>
 #include <time.h>
 #include <Adafruit_NeoPixel.h>
-#include <TinyGPS++.h>
 
 #include "config.h"
 #include "orbit.h"
+#include "orbit_task.h"
+#include "catalog_file.h"
+#include "pass_cache.h"
+#include "net.h"
+#include "tle_refresh.h"
 #include "ui.h"
+#include "render.h"
+#include "perf.h"
+#include "scheduler.h"
+#include "alert.h"
+#include "gps.h"
+#include "timesync.h"
+#include "screenshot.h"
+#include "storage.h"
 #include "credentials.h"
 #include "iss_icon.h" 
 
@@ -26,6 +37,7 @@ int wifiScanCount = 0;
 double obsLatDeg = 30.22; 
 double obsLonDeg = -92.02;
 int minElevation = DEFAULT_MIN_EL;
+int passHorizonDays = DEFAULT_PASS_DAYS;
 int tzOffsetHours = -6; 
 String satName = "";
 int satCatNumber = 25544;
@@ -34,16 +46,24 @@ bool isTimeSet = false; // New flag to track if clock is valid
 bool soundEnabled = true; // Default to ON
 
 
-TinyGPSPlus gps;
-HardwareSerial gpsSerial(1); // Use UART 1
 bool useGpsModule = false;
 
 // --- LED State Variables ---
 bool wasVisible = false;       // Tracks state from previous loop
-bool losTimerActive = false;   // Are we currently showing the Red LOS light?
-unsigned long losStartTime = 0; // When did LOS start?
 const int LOS_DURATION_MS = 5000; // How long to stay red (5 seconds)
 
+// --- LOOP TIMERS (scheduler.h) ---
+enum LoopTimer {
+    TIMER_INPUT,      // Keyboard scan (the matrix has no interrupt)
+    TIMER_NET,        // netPoll() while the radio is busy
+    TIMER_GPS_SYNC,   // Pending = the clock was synced from GPS recently
+    TIMER_LOS_LED,    // Red LED after LOS goes off
+    TIMER_STATUS,     // A failed update's footer message expires
+    TIMER_PERF,       // Closes the diagnostics window
+    TIMER_AUDIO,      // Next note of the playing alert
+    TIMER_SNAP        // A screenshot's report on the panel expires
+};
+
 // --- UI State ---
 enum Screen {
     // --- DASHBOARD SCREENS (Cycled with Button G0) ---
@@ -51,6 +71,8 @@ enum Screen {
     SCREEN_LIVE,
     SCREEN_RADAR,
     SCREEN_PASS,
+    SCREEN_PASS_LIST,
+    SCREEN_OVERHEAD,
     
     // --- MENU SCREENS (Accessed via 'c') ---
     SCREEN_MENU_MAIN,
@@ -61,13 +83,20 @@ enum Screen {
     SCREEN_MENU_LOC,
     SCREEN_GPS_INFO,
     SCREEN_MENU_AUDIO,
+
+    SCREEN_DIAG,      // Hidden: 'd' on a dashboard screen (PERF_ENABLED)
     
     SCREEN_COUNT // Keep this for the G0 cycling logic
 };
 
 Screen currentScreen = SCREEN_HOME;
-bool needsRedraw = true;
-unsigned long lastOrbitUpdateMs = 0;
+bool needsRedraw = true;   // Full frame
+bool needsUpdate = false;  // Only the fields that changed (live screens)
+uint32_t lastPassGen = 0;
+uint32_t lastOverheadGen = 0;
+uint32_t savedPassGen = 0;
+PassCacheKey savedPassKey = {};
+unsigned long lastPassSaveMs = 0;
 unsigned long unixtime = 0;
 
 // --- SATELLITE PRESETS ---
@@ -92,93 +121,109 @@ const SatPreset SAT_FAVORITES[] = {
 const int SAT_FAV_COUNT = sizeof(SAT_FAVORITES)/sizeof(SAT_FAVORITES[0]);
 
 int satMenuOffset = 0; // Tracks the scroll position
+int passListOffset = 0; // Pass schedule scroll position
 
 // --- HELPER FUNCTIONS ---
 
-String readFileFromSD(const char *path) {
-    File file = SD.open(path);
-    if (!file) return "ERROR";
-    String content;
-    while (file.available()) content += (char)file.read();
-    file.close();
-    return content;
+// Streams a TLE file through the reader in small chunks; works the same for
+// a single-satellite file or a whole CelesTrak group file.
+// catalogNumber 0 = first valid record.
+struct TleFileFind {
+    TleRecord *out;
+    long catalogNumber;
+    bool found;
+};
+
+static bool takeTleRecord(const TleRecord &rec, void *ctx) {
+    TleFileFind *f = (TleFileFind *)ctx;
+    if (f->catalogNumber != 0 && rec.catalogNumber != f->catalogNumber) return true;
+    *f->out = rec;
+    f->found = true;
+    return false;
 }
 
-bool connectWiFiAndTime() {
-    if (wifiSsid.isEmpty()) return false;
-    WiFi.begin(wifiSsid.c_str(), wifiPass.c_str());
-    unsigned long s = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - s < 8000) delay(200);
-    if (WiFi.status() != WL_CONNECTED) return false;
-    
-    configTime(tzOffsetHours * 3600, 0, "pool.ntp.org");
-    struct tm t;
-    return getLocalTime(&t, 2000);
+bool readTLEFromSD(const char *path, long catalogNumber, TleRecord &out) {
+    StorageFile file = storageOpen(path, STORAGE_READ);
+    if (!storageOk(file)) return false;
+
+    static TleReader reader;   // Off the loop task's stack
+    static char chunk[512];
+    TleFileFind find = {&out, catalogNumber, false};
+    tleReaderInit(reader);
+    bool more = true;
+    size_t n;
+    while (more && (n = storageRead(file, chunk, sizeof(chunk))) > 0) {
+        more = tleReaderFeed(reader, chunk, n, takeTleRecord, &find);
+    }
+    if (more) tleReaderFinish(reader, takeTleRecord, &find);
+    storageClose(file);
+    return find.found;
 }
 
-// --- NEW FUNCTION: GPS TIME SYNC (Corrected) ---
-void syncTimeFromGPS() {
-    // Only sync if we have valid date/time and it is fresh (<1s old)
-    if (gps.date.isValid() && gps.time.isValid() && gps.time.age() < 1000) {
-        
-        struct tm t = {0};
-        t.tm_year = gps.date.year() - 1900;
-        t.tm_mon  = gps.date.month() - 1;
-        t.tm_mday = gps.date.day();
-        t.tm_hour = gps.time.hour();
-        t.tm_min  = gps.time.minute();
-        t.tm_sec  = gps.time.second();
-        
-        // Standard portable replacement for timegm:
-        // 1. Save current TZ environment variable
-        String oldTz = getenv("TZ") ? getenv("TZ") : "";
-        
-        // 2. Set TZ to UTC temporarily. 
-        // This forces mktime() to treat the struct tm as UTC.
-        setenv("TZ", "UTC0", 1);
-        tzset();
-        
-        // 3. Convert to time_t
-        time_t utcTime = mktime(&t);
-        
-        // 4. Restore original TZ
-        if (oldTz.length() > 0) {
-            setenv("TZ", oldTz.c_str(), 1);
-        } else {
-            unsetenv("TZ");
-        }
-        tzset(); // Apply the restore
+// Makes `rec` the satellite loaded at boot. Written aside and swapped in,
+// so the previous one survives a failed write.
+void saveTLEToSD(const TleRecord &rec) {
+    storageMakeDir("/apps/iss_tracker");
+    char text[TLE_NAME_MAX + 2 * TLE_LINE_LEN + 4];
+    int len = snprintf(text, sizeof(text), "%s\n%s\n%s\n", rec.name, rec.line1, rec.line2);
+    StorageFile f = storageOpen(ISS_TLE_PATH ".tmp", STORAGE_WRITE);
+    if (!storageOk(f)) return;
+    bool ok = storageWrite(f, text, len) == (size_t)len;
+    storageClose(f);
+    if (ok) storageReplace(ISS_TLE_PATH ".tmp", ISS_TLE_PATH);
+}
 
-        // 5. Set System Time
-        struct timeval tv = { .tv_sec = utcTime, .tv_usec = 0 };
-        settimeofday(&tv, NULL);
-        
-        isTimeSet = true;
+// Switches to `catalogNumber` if a refresh or the compiled catalog left it
+// on the card (the newer of the two), without a download. Becomes the boot
+// satellite too.
+bool selectStored(long catalogNumber) {
+    TleRecord rec, other;
+    bool have = tleRefreshLoad(catalogNumber, rec);
+    if (catalogFileFind(CATALOG_TLE_PATH, CATALOG_BIN_PATH, catalogNumber, other) && (!have || other.epochUnix > rec.epochUnix)) {
+        rec = other;
+        have = true;
+    }
+    if (!have) return false;
+    if (!orbitRequestTLE(rec)) {
+        Serial.println("Orbit worker busy, TLE not loaded");
+        return false;
     }
+    saveTLEToSD(rec);
+    return true;
 }
 
-bool downloadTLE() {
-    if (WiFi.status() != WL_CONNECTED) return false;
-        HTTPClient http;
-        String url = "https://celestrak.org/NORAD/elements/gp.php?CATNR=" + String(satCatNumber) + "&FORMAT=TLE";    
-    
-    if (!http.begin(url)) return false;
-        
-    if (http.GET() != HTTP_CODE_OK) return false;
-        String payload = http.getString();
-        http.end();
+// --- GPS TIME SYNC ---
+// Millisecond time from the last RMC, slewed in (timesync.h)
+bool syncTimeFromGPS() {
+    if (timeSyncFromGps(gpsFix()) == TIMESYNC_STALE) return false;
+    isTimeSet = true;
+    return true;
+}
 
-    // Delete old file first so we don't append
-    if (SD.exists(ISS_TLE_PATH)) {
-        SD.remove(ISS_TLE_PATH);
+// --- TLE REFRESH ---
+// Downloads land in TLE_DIR, one file per satellite (see tle_refresh.h)
+static void tleUpdated(const TleRecord &rec) {
+    if (rec.catalogNumber == satCatNumber && !orbitRequestTLE(rec)) {
+        Serial.println("Orbit worker busy, downloaded TLE not loaded");
     }
-    
-    SD.mkdir("/apps/iss_tracker");
-    File f = SD.open(ISS_TLE_PATH, FILE_WRITE);
-    if (f) { f.print(payload); f.close(); }
-    
-    parseTLEData(payload);
-    return true;
+}
+
+// Refreshes whatever is due among the favorites and the tracked satellite,
+// or just `only` regardless of age. Runs in the background from loop().
+bool startTLERefresh(long only = 0) {
+    long ids[SAT_FAV_COUNT + 1];
+    int n = 0;
+    if (only) {
+        ids[n++] = only;
+    } else {
+        ids[n++] = satCatNumber;
+        for (int i = 0; i < SAT_FAV_COUNT; i++) ids[n++] = SAT_FAVORITES[i].id;
+    }
+    tleRefreshSet(ids, n, only != 0);
+
+    // With the clock already right (GPS), skip the radio if nothing is due
+    if (!only && isTimeSet && !tleRefreshAnyDue((long)time(nullptr))) return false;
+    return tleRefreshStart(wifiSsid.c_str(), wifiPass.c_str(), tzOffsetHours * 3600L);
 }
 
 String textInput(const String &initial, const char *prompt) {
@@ -247,13 +292,39 @@ void setup() {
     obsLatDeg = prefs.getDouble("lat", obsLatDeg);
     obsLonDeg = prefs.getDouble("lon", obsLonDeg);
     minElevation = prefs.getInt("minEl", DEFAULT_MIN_EL);
+    passHorizonDays = prefs.getInt("passDays", DEFAULT_PASS_DAYS);
+    satCatNumber = prefs.getInt("satCat", satCatNumber);
     tzOffsetHours = prefs.getInt("tzOffset", -6); 
     soundEnabled = prefs.getBool("sound", true); // Load saved setting
     prefs.end();
 
     configTime(tzOffsetHours * 3600, 0, "pool.ntp.org");
 
-    // --- BOOT SCREEN & GPS CHECK ---
+    // Batch catalog for "Overhead Now", if there is one. The text is only
+    // parsed when it has changed since the last compile.
+    if (SD.exists(CATALOG_TLE_PATH) && !catalogFileFresh(CATALOG_TLE_PATH, CATALOG_BIN_PATH)) {
+        canvas.fillScreen(COL_BG);
+        canvas.drawString("Compiling catalog...", 10, 10);
+        canvas.pushSprite(0,0);
+        catalogFileBuild(CATALOG_TLE_PATH, CATALOG_BIN_PATH);
+    }
+    catalogFileLoad(CATALOG_BIN_PATH, CATALOG_MAX);
+
+    // Loop timers; the worker wakes loop() with each snapshot
+    schedBegin();
+    schedEvery(TIMER_INPUT, INPUT_POLL_MS);
+#if PERF_ENABLED
+    schedEvery(TIMER_PERF, PERF_WINDOW_MS);
+#endif
+    alertBegin();
+    timeSyncBegin();
+
+    // Orbit worker: gets the site and filters before any TLE arrives
+    orbitTaskStart(nullptr, schedWake);
+    orbitRequestSite(obsLatDeg, obsLonDeg);
+    orbitRequestPassParams(minElevation, passHorizonDays);
+
+    // --- BOOT SCREEN & GPS ---
     canvas.fillScreen(COL_BG);
     canvas.setTextDatum(middle_center);
     canvas.setTextColor(COL_HEADER);
@@ -263,193 +334,193 @@ void setup() {
     int iconX = (canvas.width() / 2) - 16;
     canvas.pushImage(iconX, 68, 32, 32, ISS_ICON_32x32);
 
-    // --- NEW GPS DETECTION ---
-    canvas.setTextDatum(bottom_center);
-    canvas.setTextColor(COL_ACCENT);
-    canvas.drawString("Checking GPS Hardware...", canvas.width()/2, 125);
     canvas.pushSprite(0,0);
 
-    // Always init Serial to check
-    gpsSerial.begin(GPS_BAUD, SERIAL_8N1, GPS_RX_PIN, GPS_TX_PIN);
-    
-    unsigned long startCheck = millis();
-    bool gpsFound = false;
-    // Listen for 1.5 seconds for ANY data
-    while (millis() - startCheck < 1500) {
-        if (gpsSerial.available()) {
-            gpsFound = true;
-            break;
-        }
-    }
-
-    // Clear the "Checking" text area
-    canvas.fillRect(0, 110, 240, 25, COL_BG);
-
-    if (gpsFound) {
-        useGpsModule = true;
-        canvas.setTextColor(COL_SAT_PATH); // Green
-        canvas.drawString("GPS Module Detected!", canvas.width()/2, 125);
-    } else {
-        useGpsModule = false;
-        canvas.setTextColor(COL_SAT_NOW); // Red/Orange
-        canvas.drawString("No GPS Found - Manual Mode", canvas.width()/2, 125);
-    }
-    canvas.pushSprite(0,0);
-    delay(1000); 
+    // GPS detection is asynchronous: the first good NMEA sentence switches
+    // the location source to the module (GPS_EV_DETECTED in loop())
+    gpsBegin(schedWake);
     canvas.setTextDatum(top_left);
     // -----------------------
 
-    // Load TLE
-    String localTle = readFileFromSD(ISS_TLE_PATH);
-    if (localTle != "ERROR") {
-        parseTLEData(localTle);
+    // Load TLE: whichever of the last download, the last pick and the
+    // catalog is newest
+    tleRefreshBegin(TLE_DIR, TLE_URL_FORMAT, tleUpdated);
+    TleRecord localTle, otherTle;
+    bool haveLocal = readTLEFromSD(ISS_TLE_PATH, satCatNumber, localTle) ||
+                     readTLEFromSD(ISS_TLE_PATH, 0, localTle);
+    if (tleRefreshLoad(satCatNumber, otherTle) && (!haveLocal || otherTle.epochUnix > localTle.epochUnix)) {
+        localTle = otherTle;
+        haveLocal = true;
     }
-    
-    if (connectWiFiAndTime()) {
-         isTimeSet = true; // Mark time as set via NTP
-         downloadTLE();
-         WiFi.disconnect(true);
-         WiFi.mode(WIFI_OFF);
+    if (catalogFileFind(CATALOG_TLE_PATH, CATALOG_BIN_PATH, satCatNumber, otherTle) &&
+        (!haveLocal || otherTle.epochUnix > localTle.epochUnix)) {
+        localTle = otherTle;
+        haveLocal = true;
+    }
+    if (haveLocal && orbitRequestTLE(localTle)) {
+        // Passes from the last run, if they were for this TLE, site and filter
+        static PassSchedule cachedPasses;
+        PassCacheKey key = passCacheKey(localTle.catalogNumber, (unsigned long)localTle.epochUnix,
+                                        obsLatDeg, obsLonDeg, minElevation);
+        if (passCacheLoad(PASS_CACHE_PATH, key, cachedPasses)) {
+            orbitRequestCachedPasses(&cachedPasses, key);
+        }
     }
+    
+    netBegin();
+    startTLERefresh();  // Syncs the clock; downloads only what's stale
+}
 
-    setupOrbitLocation(obsLatDeg, obsLonDeg);
+// Saves the worker's pass schedule once its first search is done, then as it
+// grows (rate-limited, it's an SD write). Needs a real clock: a schedule
+// searched from 1970 is no use to the next boot.
+void savePassCache(const OrbitSnapshot &o) {
+    if (!isTimeSet || !o.ready || o.searching || o.passSearchedUntil == 0) return;
+    if (o.passGen == savedPassGen) return;
+    bool sameKey = passCacheKeyEqual(o.passKey, savedPassKey);
+    if (sameKey && millis() - lastPassSaveMs < PASS_CACHE_SAVE_MS) return;
+
+    static PassSchedule s;
+    s.count = o.passCount;
+    memcpy(s.passes, o.passes, o.passCount * sizeof(PassDetails));
+    s.searchedUntil = o.passSearchedUntil;
+    s.minEl = o.passKey.minEl;
+    s.visibility = o.passVisibility;
+    passCacheSave(PASS_CACHE_PATH, o.passKey, s, (unsigned long)o.unixtime);
+
+    savedPassGen = o.passGen;
+    savedPassKey = o.passKey;
+    lastPassSaveMs = millis();
 }
 
 // --- SCREENSHOT FUNCTIONALITY ---
 
-// Helper: Find the next available screenshot filename
+// Next free name from a counter kept in prefs: one SD lookup per shot,
+// more only if the counter was lost (e.g. NVS erased) and files remain
 String getNextScreenshotFileName() {
-    if (!SD.exists("/satscreenshots")) {
-        SD.mkdir("/satscreenshots");
-    }
-
-    int num = 1;
-    String fileName;
-    while (true) {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "/satscreenshots/snap%03d.bmp", num);
-        fileName = String(buf);
-        if (!SD.exists(fileName)) {
-            break;
-        }
-        num++;
+    storageMakeDir(SCREENSHOT_DIR);
+    prefs.begin("iss_cfg", false);
+    uint32_t num = prefs.getUInt("snapNext", 1);
+    char buf[40];
+    for (;;) {
+        snprintf(buf, sizeof(buf), SCREENSHOT_DIR "/snap%03lu.bmp", (unsigned long)num++);
+        if (!SD.exists(buf)) break;
     }
-    return fileName;
+    prefs.putUInt("snapNext", num);
+    prefs.end();
+    return String(buf);
 }
 
 void takeScreenshot() {
     // 1. Visual Queue: Draw a white flash or text to know it triggered
     // We draw directly to Display, bypassing the canvas sprite for a moment
     M5Cardputer.Display.setTextDatum(top_right);
-    M5Cardputer.Display.setTextColor(TFT_RED); // Red text so it's visible on black
+    M5Cardputer.Display.setTextColor(TFT_RED, COL_BG); // Red text so it's visible on black
     M5Cardputer.Display.drawString("SNAP!", 235, 5);
 
-    // 2. Prepare File
+    // 2. Encode the frame straight from the canvas (what the panel shows)
+    unsigned long start = millis();
     String fileName = getNextScreenshotFileName();
-    File file = SD.open(fileName, FILE_WRITE);
-    if (!file) {
-        Serial.println("Failed to open file for writing");
-        return;
-    }
-
-    // 3. BMP Header Construction (240x135 24-bit)
-    int w = 240;
-    int h = 135;
-    int rowSize = (w * 3 + 3) & ~3; // Align to 4 bytes
-    int imageSize = rowSize * h;
-    int fileSize = 54 + imageSize;
-    
-    // Header (54 bytes)
-    uint8_t header[54] = {
-        'B', 'M',  // Signature
-        (uint8_t)(fileSize), (uint8_t)(fileSize >> 8), (uint8_t)(fileSize >> 16), (uint8_t)(fileSize >> 24), // File Size
-        0, 0, 0, 0, // Reserved
-        54, 0, 0, 0, // Offset to data
-        40, 0, 0, 0, // Header size
-        (uint8_t)(w), (uint8_t)(w >> 8), (uint8_t)(w >> 16), (uint8_t)(w >> 24), // Width
-        (uint8_t)(h), (uint8_t)(h >> 8), (uint8_t)(h >> 16), (uint8_t)(h >> 24), // Height (positive = bottom-up)
-        1, 0, // Planes
-        24, 0, // BPP
-        0, 0, 0, 0, // Compression
-        0, 0, 0, 0, // Image size (can be 0)
-        0, 0, 0, 0, // X ppm
-        0, 0, 0, 0, // Y ppm
-        0, 0, 0, 0, // Colors used
-        0, 0, 0, 0  // Important colors
-    };
-    file.write(header, 54);
-
-    // 4. Read Pixel Data
-    // BMP is stored bottom-to-top, BGR format
-    uint8_t *lineBuffer = (uint8_t*)malloc(rowSize);
-    if (!lineBuffer) {
-        file.close();
-        return;
-    }
-
-    // Read from Hardware Display (not Sprite) line by line
-    for (int y = h - 1; y >= 0; y--) {
-        M5Cardputer.Display.readRectRGB(0, y, w, 1, lineBuffer);
-        
-        // Convert RGB to BGR in place
-        for (int x = 0; x < w; x++) {
-            uint8_t r = lineBuffer[x * 3];
-            uint8_t b = lineBuffer[x * 3 + 2];
-            lineBuffer[x * 3] = b;
-            lineBuffer[x * 3 + 2] = r;
-        }
-        file.write(lineBuffer, rowSize);
-    }
-
-    free(lineBuffer);
-    file.close();
-    
-    // Clear the "SNAP!" text by forcing a redraw next loop
-    needsRedraw = true; 
+    ScreenshotInfo info;
+    bool ok = screenshotWriteBmp(fileName.c_str(), (const uint16_t *)canvas.getBuffer(), canvas.width(),
+                                 canvas.height(), true, info);
+    unsigned long ms = millis() - start;
+
+    // 3. Report, until TIMER_SNAP redraws over it
+    char msg[32];
+    if (ok) snprintf(msg, sizeof(msg), "%lu KB %lu ms", (unsigned long)(info.bytes + 1023) / 1024, ms);
+    else snprintf(msg, sizeof(msg), "SNAP FAILED");
+    Serial.printf("Screenshot %s: %s, %lu bytes, %d colours, %lu ms\n", fileName.c_str(), ok ? "ok" : "FAILED",
+                  (unsigned long)info.bytes, info.colors, ms);
+    M5Cardputer.Display.drawString(msg, 235, 5);
+    M5Cardputer.Display.setTextDatum(top_left);
+    schedIn(TIMER_SNAP, SNAP_MSG_MS);
 }
 
-void playAosSequence() {
-    // Note 1
-    M5Cardputer.Speaker.tone(NOTE_1_FREQ, NOTE_1_DUR);
-    delay(NOTE_1_DUR + NOTE_GAP);
-
-    // Note 2
-    M5Cardputer.Speaker.tone(NOTE_2_FREQ, NOTE_2_DUR);
-    delay(NOTE_2_DUR + NOTE_GAP);
+// Alerts advance on TIMER_AUDIO; this starts one (or queues it)
+void startAlert(Alert a) {
+    alertPlay(a);
+    schedIn(TIMER_AUDIO, 0);
+}
 
-    // Note 3
-    M5Cardputer.Speaker.tone(NOTE_3_FREQ, NOTE_3_DUR);
-    delay(NOTE_3_DUR + NOTE_GAP);
+// One countdown blip as the next AOS passes each of PRE_AOS_BEEP_SEC
+void countdownToAos(const OrbitSnapshot &o) {
+    static const int BEEP_SECS[] = PRE_AOS_BEEP_SEC;
+    static long lastToAos = -1;
 
-    // Note 4
-    M5Cardputer.Speaker.tone(NOTE_4_FREQ, NOTE_4_DUR);
-    // No delay needed after the last note
+    long toAos = -1;
+    for (int i = 0; i < o.passCount; i++) {
+        if (o.passes[i].aosUnix > o.unixtime) {
+            toAos = (long)ceil(o.passes[i].aosUnix - o.unixtime);
+            break;
+        }
+    }
+    // Only a clock running down, not a new schedule or a jump in time
+    if (soundEnabled && toAos >= 0 && lastToAos > toAos && lastToAos - toAos <= 2) {
+        for (int s : BEEP_SECS) {
+            if (lastToAos > s && toAos <= s) {
+                startAlert(ALERT_COUNTDOWN);
+                break;
+            }
+        }
+    }
+    lastToAos = toAos;
 }
 
 void loop() {
-    M5Cardputer.update();
-
-    // --- GPS PARSING ---
-    if (useGpsModule) {
-        while (gpsSerial.available() > 0) {
-            gps.encode(gpsSerial.read());
-        }
-        if (gps.location.isUpdated()) {
-            obsLatDeg = gps.location.lat();
-            obsLonDeg = gps.location.lng();
-            setupOrbitLocation(obsLatDeg, obsLonDeg);
-            
-            // --- TIME SYNC LOGIC ---
-            // Sync from GPS every 60 seconds to keep the system clock accurate
-            static unsigned long lastTimeSync = 0;
-            if (millis() - lastTimeSync > 60000) { 
-                syncTimeFromGPS();
-                lastTimeSync = millis();
+    // Sleep until a timer is due or the orbit worker / GPS UART wakes us
+    PERF_BEGIN(PERF_IDLE);
+    schedWait();
+    PERF_END(PERF_IDLE);
+
+    PERF_BEGIN(PERF_LOOP);
+    bool inputDue = false;
+    for (int id = schedNextFired(); id >= 0; id = schedNextFired()) {
+        switch (id) {
+            case TIMER_INPUT: inputDue = true; break;
+            case TIMER_LOS_LED: pixels.setPixelColor(0, 0); pixels.show(); break;
+            case TIMER_STATUS: if (currentScreen == SCREEN_MENU_SAT) needsRedraw = true; break;
+            case TIMER_SNAP: needsRedraw = true; break;
+            case TIMER_AUDIO: {
+                unsigned long ms = alertPoll();
+                if (ms) schedIn(TIMER_AUDIO, ms);
+                break;
             }
+            default: break;  // The rest only wake the loop
         }
     }
 
-if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
+    PERF_BEGIN(PERF_INPUT);
+    if (inputDue) M5Cardputer.update();
+    PERF_END(PERF_INPUT);
+
+    // --- GPS PARSING ---
+    PERF_BEGIN(PERF_GPS);
+    uint32_t gpsEvents = gpsPoll();
+    if (gpsEvents & GPS_EV_DETECTED) {
+        useGpsModule = true;
+        if (currentScreen == SCREEN_MENU_LOC) needsRedraw = true;
+    }
+    if (useGpsModule && (gpsEvents & GPS_EV_LOCATION)) {
+        obsLatDeg = gpsFix().lat;
+        obsLonDeg = gpsFix().lon;
+        orbitRequestSite(obsLatDeg, obsLonDeg);
+    }
+
+    // --- TIME SYNC LOGIC ---
+    // Sync from GPS every GPS_SYNC_MS to keep the system clock accurate,
+    // right as a new RMC comes in and only once the receiver has a fix
+    if (useGpsModule && (gpsEvents & GPS_EV_TIME) && gpsFix().locationValid && !schedPending(TIMER_GPS_SYNC)) {
+        if (syncTimeFromGPS()) schedIn(TIMER_GPS_SYNC, GPS_SYNC_MS);
+    }
+    if (gpsEvents && (currentScreen == SCREEN_MENU_LOC || currentScreen == SCREEN_GPS_INFO)) {
+        needsRedraw = true;
+    }
+    PERF_END(PERF_GPS);
+
+    // Key state only changes on a scan; between scans it's last scan's
+    PERF_BEGIN(PERF_KEYS);
+if (inputDue && M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
         Keyboard_Class::KeysState k = M5Cardputer.Keyboard.keysState();
 
         // --- BACK / ESCAPE LOGIC ---
@@ -470,7 +541,7 @@ if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
             else if (currentScreen == SCREEN_GPS_INFO) {
                 currentScreen = SCREEN_MENU_LOC;
             }
-            else if (currentScreen == SCREEN_MENU_MAIN) {
+            else if (currentScreen == SCREEN_MENU_MAIN || currentScreen == SCREEN_DIAG) {
                 currentScreen = SCREEN_HOME;
             }
             needsRedraw = true;
@@ -495,16 +566,22 @@ if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
             for (auto c : k.word) {
                 if (c == '/' || c == '>') { // Right
                     int next = (int)currentScreen + 1;
-                    if (next > (int)SCREEN_PASS) next = SCREEN_HOME;
+                    if (next > (int)SCREEN_OVERHEAD) next = SCREEN_HOME;
                     currentScreen = (Screen)next;
                     needsRedraw = true;
                 }
                 if (c == ',' || c == '<') { // Left
                     int prev = (int)currentScreen - 1;
-                    if (prev < 0) prev = SCREEN_PASS;
+                    if (prev < 0) prev = SCREEN_OVERHEAD;
                     currentScreen = (Screen)prev;
                     needsRedraw = true;
                 }
+#if PERF_ENABLED
+                if (c == 'd' || c == 'D') {
+                    currentScreen = SCREEN_DIAG;
+                    needsRedraw = true;
+                }
+#endif
             }
         }
 
@@ -536,15 +613,8 @@ if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
             // WIFI MENU
             else if (currentScreen == SCREEN_MENU_WIFI) {
                 for (auto c : k.word) {
-                    if (c == '1') { // Scan
-                        canvas.fillScreen(COL_BG);
-                        canvas.setCursor(20, 50);
-                        canvas.setTextSize(1);
-                        canvas.println("Scanning WiFi...");
-                        canvas.pushSprite(0,0);
-                        WiFi.mode(WIFI_STA);
-                        WiFi.disconnect();
-                        wifiScanCount = WiFi.scanNetworks();
+                    if (c == '1' && netStartScan()) { // Scan
+                        wifiScanCount = 0;
                         currentScreen = SCREEN_WIFI_SCAN;
                         needsRedraw = true;
                     }
@@ -571,6 +641,21 @@ if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
                     }
                 }
             }
+            // PASS SCHEDULE (scroll + horizon)
+            else if (currentScreen == SCREEN_PASS_LIST) {
+                for (auto c : k.word) {
+                    if (c == ';' && passListOffset > 0) { passListOffset--; needsRedraw = true; }
+                    if (c == '.') { passListOffset++; needsRedraw = true; } // Clamped when drawn
+                    if ((c == '-' || c == '_') && passHorizonDays > 1) { passHorizonDays--; needsRedraw = true; }
+                    if ((c == '=' || c == '+') && passHorizonDays < MAX_PASS_DAYS) { passHorizonDays++; needsRedraw = true; }
+                    if (c == '-' || c == '_' || c == '=' || c == '+') {
+                        prefs.begin("iss_cfg", false);
+                        prefs.putInt("passDays", passHorizonDays);
+                        prefs.end();
+                        orbitRequestPassParams(minElevation, passHorizonDays);
+                    }
+                }
+            }
             // ... ADD THIS NEW BLOCK for Audio Menu ...
             else if (currentScreen == SCREEN_MENU_AUDIO) {
                 for (auto c : k.word) {
@@ -579,13 +664,25 @@ if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
                         prefs.begin("iss_cfg", false);
                         prefs.putBool("sound", soundEnabled);
                         prefs.end();
+                        if (!soundEnabled) alertStop();
                         needsRedraw = true;
                     }
                     if (c == '2') {
-                        playAosSequence(); // Much cleaner!
+                        startAlert(ALERT_AOS);
                     }
                 }
             }            
+#if PERF_ENABLED
+            // DIAGNOSTICS ('s' streams the reports over USB serial)
+            else if (currentScreen == SCREEN_DIAG) {
+                for (auto c : k.word) {
+                    if (c == 's' || c == 'S') {
+                        perfStream(!perfStreaming());
+                        needsRedraw = true;
+                    }
+                }
+            }
+#endif
             // SATELLITE MENU
             else if (currentScreen == SCREEN_MENU_SAT) {
                 for (auto c : k.word) {
@@ -595,6 +692,7 @@ if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
                         prefs.begin("iss_cfg", false);
                         prefs.putInt("minEl", minElevation);
                         prefs.end();
+                        orbitRequestPassParams(minElevation, passHorizonDays);
                         needsRedraw = true;
                     }
                     if (c == '2') { // Favorites
@@ -610,20 +708,12 @@ if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
                             prefs.begin("iss_cfg", false);
                             prefs.putInt("satCat", satCatNumber);
                             prefs.end();
-                            // Force update logic...
-                            needsRedraw = true; // Simplified for brevity
+                            selectStored(satCatNumber);  // Else wait for Force Update
+                            needsRedraw = true;
                         }
                     }
                     if (c == '4') { // Force Update
-                        canvas.fillScreen(COL_BG);
-                        canvas.drawString("Updating...", 50, 50);
-                        canvas.pushSprite(0,0);
-                        if (connectWiFiAndTime()) {
-                            isTimeSet = true;
-                            downloadTLE(); 
-                            WiFi.disconnect(true);
-                            WiFi.mode(WIFI_OFF);
-                        }
+                        startTLERefresh(satCatNumber);
                         needsRedraw = true;
                     }
                 }
@@ -662,19 +752,11 @@ if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
                             prefs.putInt("satCat", satCatNumber);
                             prefs.end();
                             
-                            canvas.fillScreen(COL_BG);
-                            canvas.setCursor(20, 50);
-                            canvas.setTextSize(1);
-                            canvas.printf("Downloading TLE...\n    %s", SAT_FAVORITES[realIndex].name);
-                            canvas.pushSprite(0,0);
-                            
-                            if (connectWiFiAndTime()) {
-                                isTimeSet = true;
-                                downloadTLE();
-                                WiFi.disconnect(true);
-                                WiFi.mode(WIFI_OFF);
+                            // Usually already on the card from a refresh
+                            if (!selectStored(satCatNumber)) {
+                                startTLERefresh(satCatNumber);  // Progress shows on the sat menu
                             }
-                            
+
                             currentScreen = SCREEN_MENU_SAT;
                             needsRedraw = true;
                         }
@@ -690,14 +772,14 @@ if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
                         String l = textInput(String(obsLatDeg), "Lat:");
                         obsLatDeg = l.toFloat();
                         prefs.begin("iss_cfg", false); prefs.putDouble("lat", obsLatDeg); prefs.end();
-                        setupOrbitLocation(obsLatDeg, obsLonDeg);
+                        orbitRequestSite(obsLatDeg, obsLonDeg, true);
                         needsRedraw = true;
                     }
                     if (c == '3' && !useGpsModule) {
                         String lo = textInput(String(obsLonDeg), "Lon:");
                         obsLonDeg = lo.toFloat();
                         prefs.begin("iss_cfg", false); prefs.putDouble("lon", obsLonDeg); prefs.end();
-                        setupOrbitLocation(obsLatDeg, obsLonDeg);
+                        orbitRequestSite(obsLatDeg, obsLonDeg, true);
                         needsRedraw = true;
                     }
                     if (c == '4' && useGpsModule) {
@@ -710,70 +792,113 @@ if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
     }
 
     // --- 2. BUTTON INPUT (G0) ---
-    if (M5Cardputer.BtnA.wasPressed()) {
+    if (inputDue && M5Cardputer.BtnA.wasPressed()) {
         if (currentScreen >= SCREEN_MENU_MAIN) {
             currentScreen = SCREEN_HOME;
         } else {
             int next = (int)currentScreen + 1;
-            if (next > (int)SCREEN_PASS) next = SCREEN_HOME;
+            if (next > (int)SCREEN_OVERHEAD) next = SCREEN_HOME;
             currentScreen = (Screen)next;
         }
         needsRedraw = true;
     }
 
+    PERF_END(PERF_KEYS);
+
     // --- 3. BACKGROUND TASKS ---
-    unsigned long now = millis();
-    if (now - lastOrbitUpdateMs >= 1000) {
+    // WiFi, NTP and downloads advance a step per pass
+    PERF_BEGIN(PERF_NET);
+    switch (netPoll()) {
+        case NET_EV_NONE: break;
+        case NET_EV_TIME_SET: isTimeSet = true; needsRedraw = true; break;
+        case NET_EV_SCAN_DONE: wifiScanCount = netProgress().scanCount; needsRedraw = true; break;
+        default: needsRedraw = true; break;
+    }
+    // Steps without an event (bytes arriving, NTP giving up) still show
+    static NetState lastNetState = NET_IDLE;
+    static size_t lastNetBytes = 0;
+    const NetProgress &np = netProgress();
+    if (currentScreen == SCREEN_MENU_SAT && (np.state != lastNetState || np.bytes != lastNetBytes)) {
+        needsRedraw = true;
+    }
+    if (lastNetState != NET_IDLE && np.state == NET_IDLE && np.error) {
+        schedIn(TIMER_STATUS, STATUS_ERROR_MS);
+    }
+    // Steady polls while the radio is busy; idle, it needs no wakes
+    if (!netBusy()) schedCancel(TIMER_NET);
+    else if (!schedPending(TIMER_NET)) schedEvery(TIMER_NET, NET_POLL_MS);
+    lastNetState = np.state;
+    lastNetBytes = np.bytes;
+    PERF_END(PERF_NET);
+
+    // The orbit worker publishes a fresh snapshot ten times a second
+    PERF_BEGIN(PERF_ORBIT);
+    if (orbitPoll()) {
+        const OrbitSnapshot &o = orbitView();
         time_t t = time(nullptr);
         unixtime = (unsigned long)t;
-        updateSatellitePos(unixtime);
-        lastOrbitUpdateMs = now;
         
         // LED Logic
-        bool currentlyVisible = (sat.satEl > 0);
+        bool currentlyVisible = o.ready && (o.el > 0);
 
         // CHECK FOR AOS (Rise)
         if (currentlyVisible && !wasVisible) {
             if (soundEnabled) {
-                playAosSequence();
+                startAlert(ALERT_AOS);
             }
         }
+        countdownToAos(o);
 
         if (currentlyVisible) {
             pixels.setPixelColor(0, pixels.Color(0, 255, 0)); 
-            losTimerActive = false; 
-        } else {
-            if (wasVisible) { losTimerActive = true; losStartTime = millis(); }
-
-            if (losTimerActive) {
-                if (millis() - losStartTime < LOS_DURATION_MS) pixels.setPixelColor(0, pixels.Color(255, 0, 0)); 
-                else { pixels.setPixelColor(0, 0); losTimerActive = false; }
-            } else {
-                pixels.setPixelColor(0, 0); 
-            }
+            schedCancel(TIMER_LOS_LED);
+        } else if (wasVisible) {
+            // Red until TIMER_LOS_LED turns it off
+            pixels.setPixelColor(0, pixels.Color(255, 0, 0)); 
+            schedIn(TIMER_LOS_LED, LOS_DURATION_MS);
+            if (soundEnabled) startAlert(ALERT_LOS);
+        } else if (!schedPending(TIMER_LOS_LED)) {
+            pixels.setPixelColor(0, 0); 
         }
         
         pixels.show();
         wasVisible = currentlyVisible;
 
         if (currentScreen == SCREEN_LIVE || currentScreen == SCREEN_RADAR) {
+            needsUpdate = true;
+        }
+        if ((currentScreen == SCREEN_PASS || currentScreen == SCREEN_PASS_LIST) && o.passGen != lastPassGen) {
+            needsRedraw = true;
+        }
+        lastPassGen = o.passGen;
+        savePassCache(o);
+        if (currentScreen == SCREEN_OVERHEAD && o.overheadGen != lastOverheadGen) {
             needsRedraw = true;
         }
+        lastOverheadGen = o.overheadGen;
     } 
+    PERF_END(PERF_ORBIT);
 
-    if (needsRedraw) {
-        canvas.fillScreen(COL_BG);
-        
-        time_t t = time(nullptr);
-        struct tm *tm = localtime(&t);
+#if PERF_ENABLED
+    if (perfPoll(renderPixelsPerSec()) && currentScreen == SCREEN_DIAG) needsUpdate = true;
+#endif
+
+    if (needsRedraw) renderInvalidate();
+    if (needsRedraw || needsUpdate) {
+        PERF_BEGIN(PERF_DRAW);
+        if (renderFull()) canvas.fillScreen(COL_BG);
 
         switch (currentScreen) {
             case SCREEN_HOME:   drawHomeScreen(canvas); break;
-            case SCREEN_LIVE:   drawLiveScreen(canvas, tm->tm_year+1900, tm->tm_mon+1, tm->tm_mday, tm->tm_hour, tm->tm_min); break;
-            case SCREEN_RADAR:  drawRadarScreen(canvas, unixtime); break;
+            case SCREEN_LIVE:   drawLiveScreen(canvas); break;
+            case SCREEN_RADAR:  drawRadarScreen(canvas); break;
             case SCREEN_PASS:   
-                drawPassScreen(canvas, unixtime, minElevation, obsLatDeg, obsLonDeg); 
+                drawPassScreen(canvas, unixtime, minElevation, passHorizonDays); 
                 break;            
+            case SCREEN_PASS_LIST:
+                drawPassListScreen(canvas, unixtime, minElevation, passHorizonDays, passListOffset);
+                break;
+            case SCREEN_OVERHEAD: drawOverheadScreen(canvas); break;
             case SCREEN_MENU_MAIN: drawMainMenu(canvas); break;
             case SCREEN_MENU_WIFI: drawWifiMenu(canvas, wifiSsid); break;
             case SCREEN_WIFI_SCAN: drawWifiScanResults(canvas, wifiScanCount); break;
@@ -790,18 +915,23 @@ if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
                 }
                 break;
             case SCREEN_MENU_LOC:  
-                drawLocationMenu(canvas, obsLatDeg, obsLonDeg, useGpsModule, gps.location.isValid(), gps.satellites.value()); 
+                drawLocationMenu(canvas, obsLatDeg, obsLonDeg, useGpsModule, gpsFix().locationValid, gpsFix().sats); 
                 break;         
-            case SCREEN_GPS_INFO:  drawGpsInfoScreen(canvas, gps); break;
+            case SCREEN_GPS_INFO:  drawGpsInfoScreen(canvas, gpsFix(), gpsStats()); break;
             case SCREEN_MENU_AUDIO: drawAudioMenu(canvas, soundEnabled); break;
+#if PERF_ENABLED
+            case SCREEN_DIAG: drawDiagScreen(canvas); break;
+#endif
             default: break;
             
         }
-        canvas.pushSprite(0,0);
-        needsRedraw = false;
+        PERF_END(PERF_DRAW);
+        PERF_BEGIN(PERF_PUSH);
+        renderPush(canvas, M5Cardputer.Display);
+        PERF_END(PERF_PUSH);
+        needsRedraw = needsUpdate = false;
     }
-    
-    delay(20);
+    PERF_END(PERF_LOOP);
 }
 
 
@@ -0,0 +1,312 @@
+#include "net.h"
+
+#ifndef NATIVE_BUILD
+#include <WiFi.h>
+#include <esp_crt_bundle.h>
+#include <esp_http_client.h>
+#include <esp_sntp.h>
+#endif
+
+// --- BOARD DRIVER ---
+#ifndef NATIVE_BUILD
+static void boardWifiBegin(const char *ssid, const char *pass) {
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(ssid, pass);
+}
+
+static NetLink boardWifiStatus() {
+    switch (WiFi.status()) {
+        case WL_CONNECTED:      return NET_LINK_UP;
+        case WL_CONNECT_FAILED:
+        case WL_NO_SSID_AVAIL:  return NET_LINK_FAILED;
+        default:                return NET_LINK_CONNECTING;
+    }
+}
+
+static void boardWifiOff() {
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+}
+
+static bool boardScanStart() {
+    WiFi.mode(WIFI_STA);
+    WiFi.disconnect();
+    return WiFi.scanNetworks(true) == WIFI_SCAN_RUNNING;
+}
+
+static int boardScanDone() {
+    int n = WiFi.scanComplete();
+    if (n == WIFI_SCAN_RUNNING) return NET_SCAN_RUNNING;
+    return (n < 0) ? NET_SCAN_FAILED : n;
+}
+
+static void boardTimeStart(long utcOffsetSec) {
+    sntp_set_sync_status(SNTP_SYNC_STATUS_RESET);
+    configTime(utcOffsetSec, 0, "pool.ntp.org");
+}
+
+static bool boardTimeSynced() {
+    return sntp_get_sync_status() == SNTP_SYNC_STATUS_COMPLETED;
+}
+
+// esp_http_client in async mode: perform() returns EAGAIN instead of
+// blocking, and the body arrives through the event handler. The handle
+// (and with it the TLS connection) stays open between requests to the
+// same host until httpEnd(false).
+static esp_http_client_handle_t http = nullptr;
+static NetSinkFn httpSink = nullptr;
+static void *httpCtx = nullptr;
+static bool httpAborted = false;
+static char httpEtag[48];
+static char httpLastModified[32];
+
+static void copyHeader(char *dst, size_t size, const char *value) {
+    strncpy(dst, value, size - 1);
+    dst[size - 1] = 0;
+}
+
+static esp_err_t boardHttpEvent(esp_http_client_event_t *e) {
+    if (e->event_id == HTTP_EVENT_ON_HEADER) {
+        if (strcasecmp(e->header_key, "ETag") == 0) {
+            copyHeader(httpEtag, sizeof(httpEtag), e->header_value);
+        } else if (strcasecmp(e->header_key, "Last-Modified") == 0) {
+            copyHeader(httpLastModified, sizeof(httpLastModified), e->header_value);
+        }
+    } else if (e->event_id == HTTP_EVENT_ON_DATA && !httpAborted) {
+        httpAborted = !httpSink((const char *)e->data, e->data_len, httpCtx);
+    }
+    return ESP_OK;
+}
+
+static void setValidator(const char *header, const char *value) {
+    if (value && value[0]) esp_http_client_set_header(http, header, value);
+    else esp_http_client_delete_header(http, header);
+}
+
+static bool boardHttpStart(const char *url, const char *etag, const char *lastModified,
+                           NetSinkFn sink, void *ctx) {
+    if (http) {
+        if (esp_http_client_set_url(http, url) != ESP_OK) return false;
+    } else {
+        esp_http_client_config_t cfg = {};
+        cfg.url = url;
+        cfg.event_handler = boardHttpEvent;
+        cfg.is_async = true;
+        cfg.timeout_ms = NET_HTTP_TIMEOUT_MS;
+        cfg.crt_bundle_attach = esp_crt_bundle_attach;
+        http = esp_http_client_init(&cfg);
+        if (!http) return false;
+    }
+    setValidator("If-None-Match", etag);
+    setValidator("If-Modified-Since", lastModified);
+    httpSink = sink;
+    httpCtx = ctx;
+    httpAborted = false;
+    httpEtag[0] = httpLastModified[0] = 0;
+    return true;
+}
+
+static NetHttp boardHttpPoll() {
+    esp_err_t err = esp_http_client_perform(http);
+    if (err == ESP_ERR_HTTP_EAGAIN) return NET_HTTP_PENDING;
+    return (err == ESP_OK && !httpAborted) ? NET_HTTP_DONE : NET_HTTP_ERROR;
+}
+
+static int boardHttpStatus() {
+    return http ? esp_http_client_get_status_code(http) : 0;
+}
+
+static const char *boardHttpEtag() { return httpEtag; }
+static const char *boardHttpLastModified() { return httpLastModified; }
+
+static void boardHttpEnd(bool keepAlive) {
+    if (keepAlive || !http) return;
+    esp_http_client_cleanup(http);
+    http = nullptr;
+}
+
+static const NetDriver BOARD_DRIVER = {
+    boardWifiBegin, boardWifiStatus, boardWifiOff,
+    boardScanStart, boardScanDone,
+    boardTimeStart, boardTimeSynced,
+    boardHttpStart, boardHttpPoll, boardHttpStatus,
+    boardHttpEtag, boardHttpLastModified, boardHttpEnd,
+};
+#endif
+
+// --- STATE MACHINE ---
+static const NetDriver *drv = nullptr;
+static NetProgress progress = {NET_IDLE, 0, 0, 0, 0, 0, nullptr};
+static bool wantTime = false;
+static bool httpOpen = false;      // A connection may be open
+static NetNextFn nextFn = nullptr;
+static NetDoneFn doneFn = nullptr;
+static void *sessionCtx = nullptr;
+static NetRequest request;
+static char errorText[32];
+static unsigned long lastDataMs = 0;  // A download times out only once it stalls
+
+void netBegin(const NetDriver *driver) {
+#ifndef NATIVE_BUILD
+    if (!driver) driver = &BOARD_DRIVER;
+#endif
+    drv = driver;
+}
+
+static void enter(NetState s) {
+    progress.state = s;
+    progress.stateSinceMs = millis();
+}
+
+static bool timedOut(unsigned long limitMs) {
+    return millis() - progress.stateSinceMs > limitMs;
+}
+
+// Back to idle with the radio off
+static void finish() {
+    if (httpOpen) drv->httpEnd(false);
+    httpOpen = false;
+    drv->wifiOff();
+    enter(NET_IDLE);
+}
+
+static NetEvent fail(const char *why) {
+    progress.error = why;
+    finish();
+    return NET_EV_FAILED;
+}
+
+bool netBusy() {
+    return progress.state != NET_IDLE;
+}
+
+const NetProgress &netProgress() {
+    return progress;
+}
+
+bool netStartScan() {
+    if (!drv || netBusy()) return false;
+    progress.error = nullptr;
+    if (!drv->scanStart()) {
+        progress.error = "Scan failed";
+        return false;
+    }
+    enter(NET_SCANNING);
+    return true;
+}
+
+bool netStartOnline(const char *ssid, const char *pass, long utcOffsetSec,
+                    NetNextFn next, NetDoneFn done, void *ctx) {
+    if (!drv || netBusy() || !ssid || !ssid[0]) return false;
+    progress.error = nullptr;
+    progress.bytes = 0;
+    progress.requests = 0;
+    progress.httpStatus = 0;
+
+    nextFn = next;
+    doneFn = done;
+    sessionCtx = ctx;
+    wantTime = true;
+
+    drv->wifiBegin(ssid, pass);
+    drv->timeStart(utcOffsetSec);  // SNTP starts once the link is up
+    enter(NET_CONNECTING);
+    return true;
+}
+
+// Counts bytes on their way to the request's sink
+static bool countingSink(const char *data, size_t len, void *) {
+    progress.bytes += len;
+    lastDataMs = millis();
+    return request.sink(data, len, request.ctx);
+}
+
+// After the link is up, the clock has been dealt with or a request is
+// done: the next job, if any
+static NetEvent nextJob(NetEvent ev) {
+    if (wantTime) {
+        enter(NET_SYNCING_TIME);
+        return ev;
+    }
+    memset(&request, 0, sizeof(request));
+    if (!nextFn || !nextFn(request, sessionCtx)) {
+        finish();
+        return ev;
+    }
+    httpOpen = true;
+    if (!drv->httpStart(request.url, request.etag, request.lastModified, countingSink, nullptr)) {
+        if (doneFn) doneFn(0, "", "", sessionCtx);
+        return fail("Download failed");
+    }
+    progress.httpStatus = 0;
+    enter(NET_DOWNLOADING);
+    lastDataMs = progress.stateSinceMs;
+    return ev;
+}
+
+// No answer: tell the caller, then give up on the session
+static NetEvent requestFailed(const char *why) {
+    if (doneFn) doneFn(0, "", "", sessionCtx);
+    return fail(why);
+}
+
+NetEvent netPoll() {
+    if (!drv) return NET_EV_NONE;
+
+    switch (progress.state) {
+        case NET_IDLE:
+            return NET_EV_NONE;
+
+        case NET_SCANNING: {
+            int n = drv->scanDone();
+            if (n == NET_SCAN_RUNNING) {
+                if (!timedOut(NET_SCAN_TIMEOUT_MS)) return NET_EV_NONE;
+                n = NET_SCAN_FAILED;
+            }
+            if (n < 0) return fail("Scan failed");
+            progress.scanCount = n;
+            enter(NET_IDLE);  // Leave the radio on: WiFi.SSID(i) reads the results
+            return NET_EV_SCAN_DONE;
+        }
+
+        case NET_CONNECTING: {
+            NetLink link = drv->wifiStatus();
+            if (link == NET_LINK_UP) return nextJob(NET_EV_CONNECTED);
+            if (link == NET_LINK_FAILED) return fail("WiFi connect failed");
+            if (timedOut(NET_CONNECT_TIMEOUT_MS)) return fail("WiFi timed out");
+            return NET_EV_NONE;
+        }
+
+        case NET_SYNCING_TIME:
+            if (drv->timeSynced()) {
+                wantTime = false;
+                return nextJob(NET_EV_TIME_SET);
+            }
+            if (timedOut(NET_TIME_TIMEOUT_MS)) {
+                wantTime = false;  // Carry on without it
+                return nextJob(NET_EV_NONE);
+            }
+            return NET_EV_NONE;
+
+        case NET_DOWNLOADING: {
+            NetHttp r = drv->httpPoll();
+            progress.httpStatus = drv->httpStatus();
+            if (r == NET_HTTP_PENDING) {
+                bool stalled = millis() - lastDataMs > NET_HTTP_TIMEOUT_MS;
+                return stalled ? requestFailed("Download timed out") : NET_EV_NONE;
+            }
+            if (r == NET_HTTP_ERROR) return requestFailed("Download failed");
+
+            int status = progress.httpStatus;
+            if (status != 200 && status != 304) {
+                snprintf(errorText, sizeof(errorText), "HTTP %d", status);
+                progress.error = errorText;
+            }
+            progress.requests++;
+            if (doneFn) doneFn(status, drv->httpEtag(), drv->httpLastModified(), sessionCtx);
+            drv->httpEnd(true);
+            return nextJob(NET_EV_DOWNLOAD_DONE);
+        }
+    }
+    return NET_EV_NONE;
+}
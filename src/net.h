@@ -0,0 +1,125 @@
+#pragma once
+#include <Arduino.h>
+
+// --- NETWORK ---
+// WiFi connect, NTP sync, network scans and the TLE download as one
+// cooperative state machine. loop() calls netPoll() every pass; each call
+// does a bounded slice of work and returns at most one event, so the UI
+// keeps drawing and reading keys while the radio is busy.
+//
+// The radio and HTTP sit behind a NetDriver: the board's WiFi and the
+// ESP-IDF async HTTP client on the device, fakes and a local stub server
+// in the host bench.
+
+#define NET_CONNECT_TIMEOUT_MS 10000
+#define NET_TIME_TIMEOUT_MS    5000    // Not fatal: the download still runs
+#define NET_SCAN_TIMEOUT_MS    10000
+#define NET_HTTP_TIMEOUT_MS    20000   // With no data arriving; a slow download can run longer
+#define NET_URL_MAX            160
+#define NET_POLL_MS            10      // netPoll() period while busy
+
+enum NetLink : uint8_t {
+    NET_LINK_CONNECTING,
+    NET_LINK_UP,
+    NET_LINK_FAILED
+};
+
+// scanDone() results besides a network count
+#define NET_SCAN_RUNNING -1
+#define NET_SCAN_FAILED  -2
+
+// httpPoll() results
+enum NetHttp : int8_t {
+    NET_HTTP_PENDING,
+    NET_HTTP_DONE,      // Whole body delivered
+    NET_HTTP_ERROR
+};
+
+// Receives the body as it arrives; return false to abort the download
+typedef bool (*NetSinkFn)(const char *data, size_t len, void *ctx);
+
+// Every call must return promptly; anything slow is started here and
+// checked on later calls
+struct NetDriver {
+    void (*wifiBegin)(const char *ssid, const char *pass);
+    NetLink (*wifiStatus)();
+    void (*wifiOff)();
+
+    bool (*scanStart)();
+    int (*scanDone)();                  // NET_SCAN_*, else networks found
+
+    void (*timeStart)(long utcOffsetSec);
+    bool (*timeSynced)();
+
+    // A GET, reusing the connection left open by the last one when it can.
+    // `etag` / `lastModified` (nullptr = none) go out as If-None-Match /
+    // If-Modified-Since.
+    bool (*httpStart)(const char *url, const char *etag, const char *lastModified,
+                      NetSinkFn sink, void *ctx);
+    NetHttp (*httpPoll)();              // Body goes to the sink from in here
+    int (*httpStatus)();                // 0 until the headers are in
+    const char *(*httpEtag)();          // Response validators, "" if none
+    const char *(*httpLastModified)();
+    void (*httpEnd)(bool keepAlive);    // false also drops the connection
+};
+
+// One GET of an online session
+struct NetRequest {
+    char url[NET_URL_MAX];
+    const char *etag;
+    const char *lastModified;
+    NetSinkFn sink;
+    void *ctx;
+};
+
+// Asked for the next request once the clock is synced, and again after
+// each one: fill in `req` and return true, or false when there is nothing
+// (more) to fetch
+typedef bool (*NetNextFn)(NetRequest &req, void *ctx);
+
+// How each request went: the HTTP status (304 = not modified, 0 = no
+// response) and the response's validators
+typedef void (*NetDoneFn)(int status, const char *etag, const char *lastModified, void *ctx);
+
+enum NetState : uint8_t {
+    NET_IDLE,
+    NET_SCANNING,
+    NET_CONNECTING,
+    NET_SYNCING_TIME,
+    NET_DOWNLOADING
+};
+
+enum NetEvent : uint8_t {
+    NET_EV_NONE,
+    NET_EV_SCAN_DONE,      // netProgress().scanCount networks
+    NET_EV_CONNECTED,
+    NET_EV_TIME_SET,
+    NET_EV_DOWNLOAD_DONE,  // One request answered (NetDoneFn has been called)
+    NET_EV_FAILED          // netProgress().error says why; WiFi is off again
+};
+
+struct NetProgress {
+    NetState state;
+    unsigned long stateSinceMs;
+    size_t bytes;          // Downloaded so far this session
+    int requests;          // Answered so far this session
+    int httpStatus;
+    int scanCount;
+    const char *error;     // Last failure, or nullptr
+};
+
+// nullptr = the board's radio (the host build has none)
+void netBegin(const NetDriver *driver = nullptr);
+
+// Each returns false if something else is already running
+bool netStartScan();
+// Connects, syncs the clock, runs the requests `next` hands out over one
+// connection (none if `next` is nullptr) and turns WiFi off again. An HTTP
+// error status moves on to the next request; no response at all ends the
+// session.
+bool netStartOnline(const char *ssid, const char *pass, long utcOffsetSec,
+                    NetNextFn next, NetDoneFn done, void *ctx);
+
+NetEvent netPoll();
+bool netBusy();
+const NetProgress &netProgress();
@@ -0,0 +1,166 @@
+#include "nmea.h"
+
+// --- FIELD PARSING ---
+// Fields are split in place: each ',' becomes a terminator and `field[i]`
+// points at the text after it (empty when the receiver has nothing yet)
+#define NMEA_FIELDS_MAX 24
+
+static int splitFields(char *body, char **field) {
+    int n = 0;
+    field[n++] = body;
+    for (char *p = body; *p; p++) {
+        if (*p != ',') continue;
+        *p = 0;
+        if (n == NMEA_FIELDS_MAX) break;
+        field[n++] = p + 1;
+    }
+    return n;
+}
+
+static int digits2(const char *s) {
+    return (s[0] - '0') * 10 + (s[1] - '0');
+}
+
+static bool allDigits(const char *s, int n) {
+    for (int i = 0; i < n; i++) {
+        if (s[i] < '0' || s[i] > '9') return false;
+    }
+    return true;
+}
+
+// "ddmm.mmmm" / "dddmm.mmmm" + hemisphere -> signed degrees
+static bool parseCoord(const char *value, const char *hemi, double &deg) {
+    if (!value[0] || !hemi[0]) return false;
+    double raw = strtod(value, nullptr);
+    int whole = (int)(raw / 100);
+    deg = whole + (raw - whole * 100) / 60.0;
+    if (hemi[0] == 'S' || hemi[0] == 'W') deg = -deg;
+    return true;
+}
+
+// "hhmmss.ss"
+static bool parseTime(const char *s, NmeaFix &fix) {
+    if (strlen(s) < 6 || !allDigits(s, 6)) return false;
+    fix.hour = digits2(s);
+    fix.minute = digits2(s + 2);
+    fix.second = digits2(s + 4);
+    fix.millis = s[6] == '.' ? (int)(strtod(s + 6, nullptr) * 1000 + 0.5) : 0;
+    return true;
+}
+
+// "ddmmyy"
+static bool parseDate(const char *s, NmeaFix &fix) {
+    if (strlen(s) != 6 || !allDigits(s, 6)) return false;
+    fix.day = digits2(s);
+    fix.month = digits2(s + 2);
+    fix.year = 2000 + digits2(s + 4);
+    return true;
+}
+
+// $--RMC,time,status,lat,N,lon,E,knots,course,date,...
+static int parseRMC(char **f, int n, NmeaFix &fix) {
+    if (n < 10) return 0;
+    int changed = 0;
+    NmeaFix t = fix;
+    if (parseTime(f[1], t) && parseDate(f[9], t)) {
+        t.timeValid = true;
+        fix = t;
+        changed |= NMEA_TIME;
+    }
+    double lat, lon;
+    if (f[2][0] == 'A' && parseCoord(f[3], f[4], lat) && parseCoord(f[5], f[6], lon)) {
+        fix.lat = lat;
+        fix.lon = lon;
+        fix.locationValid = true;
+        changed |= NMEA_LOCATION;
+    }
+    return changed;
+}
+
+// $--GGA,time,lat,N,lon,E,quality,sats,hdop,alt,M,...
+static int parseGGA(char **f, int n, NmeaFix &fix) {
+    if (n < 10) return 0;
+    if (f[7][0]) fix.sats = atoi(f[7]);
+    if (f[8][0]) fix.hdop = strtof(f[8], nullptr);
+    double lat, lon;
+    if (atoi(f[6]) == 0 || !parseCoord(f[2], f[3], lat) || !parseCoord(f[4], f[5], lon)) return 0;
+    fix.lat = lat;
+    fix.lon = lon;
+    if (f[9][0]) fix.altM = strtof(f[9], nullptr);
+    fix.locationValid = true;
+    return NMEA_LOCATION;
+}
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// --- LINE ASSEMBLY ---
+void nmeaReaderInit(NmeaReader &r) {
+    memset(&r, 0, sizeof(r));
+}
+
+static int handleLine(NmeaReader &r, NmeaFix &fix) {
+    int n = r.lineLen;
+    while (n > 0 && (r.line[n - 1] == '\r' || r.line[n - 1] == ' ')) n--;
+    r.line[n] = 0;
+    bool overflow = r.lineOverflow;
+    r.lineLen = 0;
+    r.lineOverflow = false;
+    if (n == 0) return 0;
+
+    // '$' body '*' hh
+    if (overflow || r.line[0] != '$' || n < 4 || r.line[n - 3] != '*') {
+        r.badLines++;
+        return 0;
+    }
+    int hi = hexDigit(r.line[n - 2]), lo = hexDigit(r.line[n - 1]);
+    uint8_t sum = 0;
+    for (int i = 1; i < n - 3; i++) sum ^= (uint8_t)r.line[i];
+    if (hi < 0 || lo < 0 || sum != (hi << 4 | lo)) {
+        r.badChecksums++;
+        return 0;
+    }
+    r.sentences++;
+    r.line[n - 3] = 0;
+
+    char *field[NMEA_FIELDS_MAX];
+    int count = splitFields(r.line + 1, field);
+    const char *type = field[0];
+    if (strlen(type) != 5) return 0;
+    if (strcmp(type + 2, "RMC") == 0) return parseRMC(field, count, fix);
+    if (strcmp(type + 2, "GGA") == 0) return parseGGA(field, count, fix);
+    return 0;
+}
+
+int nmeaReaderFeed(NmeaReader &r, const char *data, size_t len, NmeaFix &fix) {
+    int changed = 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c == '\n') {
+            changed |= handleLine(r, fix);
+        } else if (c == '$' && r.lineLen > 0) {
+            // A sentence cut short (dropped bytes) runs into the next one
+            r.badLines++;
+            r.lineLen = 0;
+            r.lineOverflow = false;
+            r.line[r.lineLen++] = c;
+        } else if (r.lineLen < NMEA_LINE_MAX) {
+            r.line[r.lineLen++] = c;
+        } else {
+            r.lineOverflow = true;
+        }
+    }
+    return changed;
+}
+
+size_t nmeaFinish(char *sentence, size_t size) {
+    size_t n = strlen(sentence);
+    uint8_t sum = 0;
+    for (size_t i = 1; i < n; i++) sum ^= (uint8_t)sentence[i];
+    snprintf(sentence + n, size - n, "*%02X\r\n", sum);
+    return strlen(sentence);
+}
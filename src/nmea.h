@@ -0,0 +1,50 @@
+#pragma once
+#include <Arduino.h>
+
+// --- STREAMING NMEA READER ---
+// Parses NMEA 0183 text fed in chunks of any size, the way tle_reader.cpp
+// reads TLEs: fixed line buffer, every sentence checked against its XOR
+// checksum, fields read in place. Only what the tracker uses is decoded:
+// RMC (date, time, position) and GGA (position, altitude, satellites,
+// HDOP), from any talker (GP, GN, GL...).
+
+#define NMEA_LINE_MAX 96   // The standard says 82; longer lines are dropped
+
+// nmeaReaderFeed() results, OR'd together
+#define NMEA_LOCATION 0x1
+#define NMEA_TIME     0x2
+
+struct NmeaFix {
+    bool locationValid;
+    double lat, lon;            // Degrees, north / east positive
+    float altM;                 // Above mean sea level (GGA)
+    float hdop;
+    int sats;                   // In use (GGA)
+
+    bool timeValid;             // UTC date and time of day (RMC)
+    int year, month, day;
+    int hour, minute, second, millis;
+
+    // Stamped by the caller: millis() when the last update arrived
+    unsigned long locationAtMs;
+    unsigned long timeAtMs;
+};
+
+struct NmeaReader {
+    char line[NMEA_LINE_MAX + 1];
+    int lineLen;
+    bool lineOverflow;
+
+    unsigned long sentences;    // Checksum OK (decoded or not)
+    unsigned long badChecksums;
+    unsigned long badLines;     // Overlong, or no '$' / '*hh' framing
+};
+
+void nmeaReaderInit(NmeaReader &r);
+
+// Updates `fix` from each complete sentence; NMEA_* flags for what changed
+int nmeaReaderFeed(NmeaReader &r, const char *data, size_t len, NmeaFix &fix);
+
+// Appends "*hh\r\n" to a sentence body starting with '$'; for tests and
+// generated logs. Returns the new length.
+size_t nmeaFinish(char *sentence, size_t size);
@@ -1,19 +1,21 @@
 #include "orbit.h"
 #include "config.h"
-#include <Sgp4.h>
+#include "ephemeris.h"
+#include <limits.h>
 
-// The SGP4 object
-Sgp4 sat;
+// Current elements and observer; both are plain values, so readers never
+// see a half-updated propagator
+static SatElements elements;
+static Observer observer;
 bool sgp4Ready = false;
 
-char tleLine1Buf[130];
-char tleLine2Buf[130];
-
 // Orbital elements for display
 float tleIncDeg = 0;
 float tleRAANDeg = 0;
 float tleEcc = 0;
 float tleArgPerDeg = 0;
+unsigned long tleEpochUnix = 0;
+long tleCatalogNumber = 0;
 
 void initOrbitSystem() {
     // Placeholder if needed
@@ -23,111 +25,401 @@ bool isOrbitReady() {
     return sgp4Ready && tleParsedOK;
 }
 
-void updateSatellitePos(unsigned long unixtime) {
-    if (isOrbitReady()) {
-        sat.findsat(unixtime);
-    }
+SatPosition satellitePosition(double unixtime) {
+    SatPosition p = {false, 0, 0, 0, 0, -90};
+    if (!isOrbitReady()) return p;
+
+    SatState s = ephemLiveState(unixtime);
+    if (!s.valid) return p;
+
+    GeoPoint g = subSatellitePoint(s);
+    LookAngles la = lookAngles(s, observer);
+    p.valid = true;
+    p.lat = g.latDeg;
+    p.lon = g.lonDeg;
+    p.altKm = g.altKm;
+    p.az = la.az;
+    p.el = la.el;
+    return p;
 }
 
+LookAngles satelliteLookAngles(double unixtime) {
+    return ephemLookAngles(unixtime, observer);
+}
+
+// Last site handed to setupOrbitLocation(), re-applied after a TLE load
+static double siteLatDeg = -999;
+static double siteLonDeg = -999;
+
+static void setupCulling();
+static int visMinEl = INT_MIN;    // minEl that the cached visibility class was worked out for
+
 void setupOrbitLocation(double lat, double lon) {
-    sat.site(lat, lon, OBS_ALT_M);
+    observer = makeObserver(lat, lon, OBS_ALT_M);
+
+    // Passes are observer-specific
+    if (lat != siteLatDeg || lon != siteLonDeg) {
+        resetPassSchedule(passSchedule);
+        visMinEl = INT_MIN;
+        siteLatDeg = lat;
+        siteLonDeg = lon;
+    }
 }
 
-void parseTLEData(const String &rawTLE) {
+bool loadTLERecord(const TleRecord &rec) {
     // Reset flags
     sgp4Ready = false;
     tleParsedOK = false;
+    resetPassSchedule(passSchedule);
     satName = "Invalid/No Data";
 
-    int firstNL = rawTLE.indexOf('\n');
-    if (firstNL < 0) return;
-    int secondNL = rawTLE.indexOf('\n', firstNL + 1);
-    if (secondNL < 0) return;
-
-    satName = rawTLE.substring(0, firstNL);
-    satName.trim();
-
-    String t1 = rawTLE.substring(firstNL + 1, secondNL);
-    String t2 = rawTLE.substring(secondNL + 1);
-    t1.trim(); 
-    t2.trim();
-
-    if (t1.length() < 69 || t2.length() < 69) return;
-
     // Extract visual data
-    tleIncDeg    = t2.substring(8, 16).toFloat();
-    tleRAANDeg   = t2.substring(17, 25).toFloat();
-    tleEcc       = t2.substring(26, 33).toFloat() / 10000000.0f; // Correct decimal
-    tleArgPerDeg = t2.substring(34, 42).toFloat();
-
-    // Prepare buffers for SGP4
-    t1.toCharArray(tleLine1Buf, sizeof(tleLine1Buf));
-    t2.toCharArray(tleLine2Buf, sizeof(tleLine2Buf));
+    tleIncDeg    = rec.incDeg;
+    tleRAANDeg   = rec.raanDeg;
+    tleEcc       = rec.ecc;
+    tleArgPerDeg = rec.argPerDeg;
+    tleEpochUnix = (unsigned long)rec.epochUnix;
+    tleCatalogNumber = rec.catalogNumber;
 
     // Init SGP4
-    sat.init(satName.c_str(), tleLine1Buf, tleLine2Buf);
+    if (!loadElements(elements, rec.name, rec.line1, rec.line2)) return false;
+    satName = rec.name;
+    ephemLoad(elements);
+    setupCulling();
+    visMinEl = INT_MIN;
     tleParsedOK = true;
     sgp4Ready = true;
     
     // Apply current location
-    setupOrbitLocation(obsLatDeg, obsLonDeg);
+    setupOrbitLocation(siteLatDeg, siteLonDeg);
+    return true;
 }
 
 // --- PREDICTION ENGINE ---
-// Looks ahead up to 24 hours to find the next AOS > minElThreshold
-bool predictNextPass(unsigned long startUnix, PassDetails &pass, int minElThreshold) {
-    if (!isOrbitReady()) return false;
+// Step sizes (seconds). Below the horizon the step grows with how far down the
+// satellite is; crossings and the culmination are then refined to PASS_REFINE_S.
+static const unsigned long PASS_MIN_STEP_S = 20;
+static const unsigned long PASS_MAX_STEP_S = 1800;
+static const unsigned long PASS_REFINE_S   = 1;
+static const unsigned long PASS_MAX_TRACK_S = 24 * 3600;     // Give up on a pass that never sets
+static const unsigned long PASS_EXTEND_SLACK_S = 3600;       // Extend the schedule in >= 1h slices
 
-    unsigned long t = startUnix;
-    unsigned long step = 30; // check every 30 seconds for speed
-    unsigned long maxSearch = startUnix + (24 * 3600);
+// The search runs on the ephemeris cache, so a site change re-uses the
+// already propagated nodes.
+static SatState lastState;
+static double lastAltKm = 0;
 
-    bool inPass = false;
-    double maxEl = -999;
-    unsigned long aosTime = 0;
+static double elevationAt(unsigned long t) {
+    lastState = ephemState(t);
+    LookAngles la = lookAngles(lastState, observer);
+    lastAltKm = la.altKm;
+    return la.el;
+}
 
-    // Initial check to fast forward if we are currently IN a pass
-    sat.findsat(t);
-    if (sat.satEl > 0) {
-        while(t < maxSearch) {
-            sat.findsat(t);
-            if (sat.satEl < 0) break;
-            t += step;
+// --- VISIBILITY CULLING ---
+// The satellite can only be up while the observer is inside its footprint,
+// so both the angle to the satellite and the angle to the orbit plane have to
+// come down to the footprint radius first. Each changes no faster than a
+// known rate, which turns "how far outside" into a pass-free interval.
+static const double EARTH_ROTATION_RAD_S = 7.2921158553e-5;
+static const double CULL_MARGIN_RAD = 1.0 * DEG_TO_RAD;   // Covers short-period wobble of the plane
+static const double CULL_RATE_MARGIN = 1.1;
+static const int GEO_SAMPLES = 24;                        // Hourly over a day
+
+static double cullFootprint = 0;  // Horizon footprint at apogee (rad)
+static double cullSatRate = 0;    // Fastest the site-satellite angle can close (rad/s)
+static double cullPlaneRate = 0;  // Fastest the site-plane angle can close (rad/s)
+
+static PassVisibility visClass = PASS_VIS_NORMAL;
+
+static void setupCulling() {
+    double n = elements.rec.no / 60.0;
+    double e = elements.rec.ecco;
+    cullFootprint = footprintAngle(elements.apogeeKm, 0) + CULL_MARGIN_RAD;
+    cullSatRate = (n * (1 + e) * (1 + e) / pow(1 - e * e, 1.5) + EARTH_ROTATION_RAD_S) * CULL_RATE_MARGIN;
+    cullPlaneRate = (EARTH_ROTATION_RAD_S + fabs(elements.rec.nodedot) / 60.0) * CULL_RATE_MARGIN;
+}
+
+// Seconds from the last elevationAt() sample during which the satellite
+// certainly stays below the horizon
+static unsigned long horizonSkip() {
+    SiteAngles a = siteAngles(lastState, observer);
+    double skip = (a.toSat - cullFootprint) / cullSatRate;
+    double planeSkip = (a.toPlane - cullFootprint) / cullPlaneRate;
+    if (planeSkip > skip) skip = planeSkip;
+    return (skip > 0) ? (unsigned long)skip : 0;
+}
+
+static bool isGeosynchronous() {
+    return fabs(elements.periodMin - 1436.07) < 15 && elements.rec.ecco < 0.05;
+}
+
+static PassVisibility classifyVisibility(int minEl, unsigned long nowUnix) {
+    // The ground track stays within +-inclination of the equator
+    double inc = elements.rec.inclo;
+    if (inc > PI / 2) inc = PI - inc;
+    double reach = footprintAngle(elements.apogeeKm, minEl) + CULL_MARGIN_RAD;
+    if (fabs(observer.latDeg) * DEG_TO_RAD - inc > reach) return PASS_VIS_NEVER;
+
+    // A geosynchronous sub-satellite point only wanders a little over a day
+    if (isGeosynchronous()) {
+        double lo = 90, hi = -90;
+        for (int i = 0; i < GEO_SAMPLES; i++) {
+            double el = elevationAt(nowUnix + i * (86400UL / GEO_SAMPLES));
+            if (el < lo) lo = el;
+            if (el > hi) hi = el;
         }
+        if (hi < minEl - 0.5) return PASS_VIS_NEVER;
+        if (lo > 0.5 && hi >= minEl) return PASS_VIS_ALWAYS_UP;
+    }
+    return PASS_VIS_NORMAL;
+}
+
+PassVisibility passVisibility(int minEl, unsigned long nowUnix) {
+    if (!isOrbitReady()) return PASS_VIS_NORMAL;
+    if (minEl != visMinEl) {
+        visClass = classifyVisibility(minEl, nowUnix);
+        visMinEl = minEl;
+    }
+    return visClass;
+}
+
+// Altitude factor from gpredict's AOS search: higher orbits sweep the sky slower
+static double skyRateFactor() {
+    return lastAltKm / 8400.0 + 0.46;
+}
+
+// How far we can jump while `el` degrees below the horizon without
+// stepping over a rise (elevation climbs < 0.06 deg/s for LEO)
+static unsigned long belowHorizonStep(double el) {
+    double s = PASS_MIN_STEP_S + 20.0 * (-el) * skyRateFactor();
+    if (s > PASS_MAX_STEP_S) s = PASS_MAX_STEP_S;
+    return (unsigned long)s;
+}
+
+// Sampling step while above the horizon (~60 s for LEO)
+static unsigned long aboveHorizonStep() {
+    double s = 120.0 * skyRateFactor();
+    if (s < PASS_MIN_STEP_S) s = PASS_MIN_STEP_S;
+    if (s > 600) s = 600;
+    return (unsigned long)s;
+}
+
+// Bisect a horizon crossing: `lo`/`hi` bracket the change of sign.
+// Returns the first second on the `hi` side.
+static unsigned long refineCrossing(unsigned long lo, unsigned long hi, bool rising) {
+    while (hi - lo > PASS_REFINE_S) {
+        unsigned long mid = lo + (hi - lo) / 2;
+        bool up = elevationAt(mid) > 0;
+        if (up == rising) hi = mid; else lo = mid;
+    }
+    return hi;
+}
+
+// Golden-section search for the culmination inside [lo, hi]
+static double refineMaxElevation(unsigned long lo, unsigned long hi) {
+    const double invPhi = 0.6180339887;
+    double a = lo, b = hi;
+    double c = b - (b - a) * invPhi;
+    double d = a + (b - a) * invPhi;
+    double fc = elevationAt((unsigned long)c);
+    double fd = elevationAt((unsigned long)d);
+    while (b - a > PASS_REFINE_S * 2) {
+        if (fc > fd) {
+            b = d; d = c; fd = fc;
+            c = b - (b - a) * invPhi;
+            fc = elevationAt((unsigned long)c);
+        } else {
+            a = c; c = d; fc = fd;
+            d = a + (b - a) * invPhi;
+            fd = elevationAt((unsigned long)d);
+        }
+    }
+    return (fc > fd) ? fc : fd;
+}
+
+// If the satellite is up at `t`, step forward to the first sample after it sets
+static unsigned long skipCurrentPass(unsigned long t, unsigned long endUnix) {
+    while (t < endUnix && elevationAt(t) > 0) {
+        t += aboveHorizonStep();
     }
+    return t;
+}
+
+// Finds the first pass with AOS in [startUnix, endUnix) peaking at or above
+// minElThreshold. A satellite already up at startUnix counts as rising there.
+// resumeUnix gets a time (at or below the horizon) from which searching can
+// continue without missing anything.
+static bool searchPass(unsigned long startUnix, unsigned long endUnix, int minElThreshold,
+                       PassDetails &pass, unsigned long &resumeUnix) {
+    unsigned long t = startUnix;
+    double el = elevationAt(t);
 
-    // Search loop
-    while (t < maxSearch) {
-        sat.findsat(t);
-        
-        if (!inPass && sat.satEl > 0) {
-            // Pass started
-            inPass = true;
-            aosTime = t;
-            maxEl = sat.satEl;
-        } else if (inPass && sat.satEl > 0) {
-            // Tracking max elevation
-            if (sat.satEl > maxEl) maxEl = sat.satEl;
-        } else if (inPass && sat.satEl < 0) {
-            // Pass ended. CHECK THRESHOLD.
-            if (maxEl >= minElThreshold) {
-                // Good pass found!
-                pass.aosUnix = aosTime;
-                pass.losUnix = t;
-                pass.maxElevation = maxEl;
-                pass.durationMins = (t - aosTime) / 60.0;
-                
-                updateSatellitePos(startUnix); 
-                return true;
-            } else {
-                // Pass was too low. Reset and keep searching.
-                inPass = false;
-                maxEl = -999;
+    while (t < endUnix) {
+        unsigned long aosTime = t;
+        unsigned long prev = t;
+
+        if (el <= 0) {
+            // Coarse search for the next rise, jumping whole intervals where
+            // the geometry rules a rise out
+            unsigned long step = belowHorizonStep(el);
+            unsigned long skip = horizonSkip();
+            t += (skip > step) ? skip : step;
+            el = elevationAt(t);
+            if (el <= 0) continue;
+
+            aosTime = refineCrossing(prev, t, true);
+            if (aosTime >= endUnix) {
+                resumeUnix = prev;
+                return false;
             }
         }
-        t += step;
+
+        // Track the pass until it sets, remembering the highest sample
+        unsigned long step = aboveHorizonStep();
+        unsigned long peakT = t;
+        double peakEl = el;
+        while (el > 0 && t - aosTime < PASS_MAX_TRACK_S) {
+            prev = t;
+            t += step;
+            el = elevationAt(t);
+            if (el > peakEl) { peakEl = el; peakT = t; }
+        }
+        // Never set: report LOS as the end of tracking
+        unsigned long losTime = (el > 0) ? t : refineCrossing(prev, t, false);
+
+        unsigned long lo = (peakT - step > aosTime) ? peakT - step : aosTime;
+        unsigned long hi = (peakT + step < losTime) ? peakT + step : losTime;
+        double maxEl = refineMaxElevation(lo, hi);
+        if (peakEl > maxEl) maxEl = peakEl;
+
+        // Pass ended. CHECK THRESHOLD.
+        if (maxEl >= minElThreshold) {
+            pass.aosUnix = aosTime;
+            pass.losUnix = losTime;
+            pass.maxElevation = maxEl;
+            pass.durationMins = (losTime - aosTime) / 60.0;
+            resumeUnix = losTime;
+            return true;
+        }
+        // Pass was too low. Keep searching from its LOS.
     }
-    
-    updateSatellitePos(startUnix);
+
+    resumeUnix = t;
     return false;
-}
\ No newline at end of file
+}
+
+// Looks ahead up to 24 hours to find the next AOS > minElThreshold
+bool predictNextPass(unsigned long startUnix, PassDetails &pass, int minElThreshold) {
+    if (!isOrbitReady()) return false;
+    if (passVisibility(minElThreshold, startUnix) != PASS_VIS_NORMAL) return false;
+
+    unsigned long maxSearch = startUnix + (24 * 3600);
+    unsigned long resume;
+
+    // If we are currently IN a pass, it doesn't count as "next"
+    unsigned long t = skipCurrentPass(startUnix, maxSearch);
+    return searchPass(t, maxSearch, minElThreshold, pass, resume);
+}
+
+bool passInProgress(unsigned long t, PassDetails &pass) {
+    if (!isOrbitReady() || elevationAt(t) <= 0) return false;
+    unsigned long step = aboveHorizonStep();
+
+    // Walk out both ways to the horizon, then refine the crossings
+    unsigned long lo = t;
+    while (t - lo < PASS_MAX_TRACK_S && elevationAt(lo - step) > 0) lo -= step;
+    unsigned long aosTime = refineCrossing(lo - step, lo, true);
+
+    unsigned long hi = t;
+    while (hi - t < PASS_MAX_TRACK_S && elevationAt(hi + step) > 0) hi += step;
+    unsigned long losTime = refineCrossing(hi, hi + step, false);
+
+    pass.aosUnix = aosTime;
+    pass.losUnix = losTime;
+    pass.maxElevation = refineMaxElevation(aosTime, losTime);
+    pass.durationMins = (losTime - aosTime) / 60.0;
+    return true;
+}
+
+// --- PASS SCHEDULE ---
+PassSchedule passSchedule;
+
+void resetPassSchedule(PassSchedule &s) {
+    s.count = 0;
+    s.searchedUntil = 0;
+    s.visibility = PASS_VIS_NORMAL;
+}
+
+bool passScheduleNeedsWork(const PassSchedule &s, unsigned long nowUnix, int minEl, unsigned long horizonSecs) {
+    if (!isOrbitReady()) return false;
+    if (s.searchedUntil == 0 || s.minEl != minEl) return true;
+    if (s.count >= PASS_SCHEDULE_MAX) return false;
+    // Only extend once a worthwhile slice of new time has opened up
+    return s.searchedUntil + PASS_EXTEND_SLACK_S < nowUnix + horizonSecs;
+}
+
+bool updatePassSchedule(PassSchedule &s, unsigned long nowUnix, int minEl, unsigned long horizonSecs) {
+    if (!isOrbitReady()) {
+        bool had = s.count > 0;
+        resetPassSchedule(s);
+        return had;
+    }
+
+    bool changed = false;
+    unsigned long endUnix = nowUnix + horizonSecs;
+    // A site change only skips SGP4 if the whole horizon stays cached
+    ephemReserve(horizonSecs);
+
+    if (s.searchedUntil == 0 || s.minEl != minEl) {
+        // Full rebuild: a pass already in progress doesn't count
+        s.count = 0;
+        s.minEl = minEl;
+        s.visibility = passVisibility(minEl, nowUnix);
+        s.searchedUntil = (s.visibility == PASS_VIS_NORMAL) ? skipCurrentPass(nowUnix, endUnix) : endUnix;
+        changed = true;
+    }
+
+    // Drop passes that have finished
+    int done = 0;
+    while (done < s.count && s.passes[done].losUnix <= nowUnix) done++;
+    if (done > 0) {
+        memmove(s.passes, s.passes + done, (s.count - done) * sizeof(PassDetails));
+        s.count -= done;
+        changed = true;
+    }
+
+    // Horizon shortened: passes beyond it go, and the search picks up from it
+    int keep = s.count;
+    while (keep > 0 && s.passes[keep - 1].aosUnix >= endUnix) keep--;
+    if (keep < s.count) {
+        s.count = keep;
+        changed = true;
+    }
+    if (s.searchedUntil > endUnix) {
+        unsigned long lastLos = s.count ? s.passes[s.count - 1].losUnix : 0;
+        s.searchedUntil = lastLos > endUnix ? lastLos : endUnix;
+    }
+
+    if (!changed && !passScheduleNeedsWork(s, nowUnix, minEl, horizonSecs)) return false;
+
+    // Nothing to find: just keep the window moving
+    if (s.visibility != PASS_VIS_NORMAL) {
+        s.searchedUntil = endUnix;
+        return changed;
+    }
+
+    // Only search the time we haven't covered yet
+    if (s.searchedUntil < nowUnix) s.searchedUntil = nowUnix;
+    ephemFill(s.searchedUntil, endUnix + EPHEM_SPAN_MARGIN_S / 2);
+    while (s.count < PASS_SCHEDULE_MAX && s.searchedUntil < endUnix) {
+        PassDetails p;
+        unsigned long resume;
+        bool found = searchPass(s.searchedUntil, endUnix, minEl, p, resume);
+        s.searchedUntil = resume;
+        if (!found) break;
+        s.passes[s.count++] = p;
+        changed = true;
+    }
+    return changed;
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <Arduino.h>
-#include <Sgp4.h>
+#include "propagator.h"
+#include "tle_reader.h"
 
 struct PassDetails {
     unsigned long aosUnix;
@@ -9,15 +10,53 @@ struct PassDetails {
     double durationMins;
 };
 
-extern Sgp4 sat;
+// Where the satellite is at a given moment, as seen from the current site
+struct SatPosition {
+    bool valid;
+    double lat, lon, altKm;
+    double az, el;
+};
+
+// Whether a search can find anything at all for this TLE, site and minimum
+// elevation (settled from the orbit geometry before any stepping)
+enum PassVisibility : uint8_t {
+    PASS_VIS_NORMAL,     // Rises and sets
+    PASS_VIS_NEVER,      // Never gets above the minimum elevation here
+    PASS_VIS_ALWAYS_UP   // Geosynchronous and never sets
+};
+
+// Upcoming passes, extended forward incrementally as time advances. A low
+// filter on a low orbit can fill the schedule before the horizon; it then
+// ends at searchedUntil.
+#define PASS_SCHEDULE_MAX 32
+
+struct PassSchedule {
+    PassDetails passes[PASS_SCHEDULE_MAX];
+    int count;
+    unsigned long searchedUntil; // 0 = needs a full rebuild
+    int minEl;
+    PassVisibility visibility;
+};
+
+extern PassSchedule passSchedule;
+
 extern float tleIncDeg;
 extern float tleRAANDeg;
 extern float tleEcc;
 extern float tleArgPerDeg;
+extern unsigned long tleEpochUnix;
+extern long tleCatalogNumber;
 
 void initOrbitSystem();
 bool isOrbitReady();
 void setupOrbitLocation(double lat, double lon);
-void parseTLEData(const String &rawTLE);
-void updateSatellitePos(unsigned long unixtime);
-bool predictNextPass(unsigned long startUnix, PassDetails &pass, int minElThreshold);
\ No newline at end of file
+bool loadTLERecord(const TleRecord &rec);
+SatPosition satellitePosition(double unixtime);  // Sub-second resolution, interpolated
+LookAngles satelliteLookAngles(double unixtime);  // From the ephemeris cache
+bool predictNextPass(unsigned long startUnix, PassDetails &pass, int minElThreshold);
+PassVisibility passVisibility(int minEl, unsigned long nowUnix);
+bool passInProgress(unsigned long t, PassDetails &pass);  // Any elevation
+
+void resetPassSchedule(PassSchedule &s);
+bool passScheduleNeedsWork(const PassSchedule &s, unsigned long nowUnix, int minEl, unsigned long horizonSecs);
+bool updatePassSchedule(PassSchedule &s, unsigned long nowUnix, int minEl, unsigned long horizonSecs);
\ No newline at end of file
@@ -0,0 +1,398 @@
+#include "orbit_task.h"
+#include "config.h"
+#include <atomic>
+#include <sys/time.h>
+
+#ifdef NATIVE_BUILD
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#else
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#endif
+
+#define ORBIT_LIVE_PERIOD_MS 100   // 10 Hz live position
+#define ORBIT_QUEUE_DEPTH    8
+#define ORBIT_TASK_STACK     12288
+#define ORBIT_TASK_CORE      0     // Arduino loop() runs on core 1
+
+enum OrbitCommandType : uint8_t {
+    CMD_LOAD_TLE,
+    CMD_CACHED_PASSES,
+    CMD_STOP
+};
+
+struct OrbitCommand {
+    uint8_t type;
+    TleRecord tle;
+    const PassSchedule *cached;
+    PassCacheKey key;
+};
+
+// Site and filter changes only matter as their newest value, so they wait
+// in a slot beside the queue instead of in it: a stream of GPS fixes can't
+// crowd out a TLE load. Guarded by the queue lock.
+struct LatestRequests {
+    bool site;
+    bool siteForced;        // A forced site stays forced until taken
+    double lat, lon;
+    bool params;
+    int minEl, horizonDays;
+};
+
+static LatestRequests latest;
+
+// --- SNAPSHOT HANDOFF ---
+// Triple buffer: the worker always owns one slot, the UI owns another, and
+// the third is swapped between them atomically. Neither side ever waits and
+// the UI always sees a complete snapshot.
+static OrbitSnapshot slots[3];
+static const uint32_t SLOT_FRESH = 0x4;
+static std::atomic<uint32_t> middleSlot(1);
+static uint32_t backSlot = 2;   // Worker side
+static uint32_t frontSlot = 0;  // UI side
+
+static void (*publishedFn)() = nullptr;
+
+static void publishSnapshot(const OrbitSnapshot &snap) {
+    slots[backSlot] = snap;
+    backSlot = middleSlot.exchange(backSlot | SLOT_FRESH) & 0x3;
+    if (publishedFn) publishedFn();
+}
+
+bool orbitPoll() {
+    if (!(middleSlot.load() & SLOT_FRESH)) return false;
+    frontSlot = middleSlot.exchange(frontSlot) & 0x3;
+    return true;
+}
+
+const OrbitSnapshot &orbitView() {
+    return slots[frontSlot];
+}
+
+// --- PLATFORM GLUE ---
+#ifdef NATIVE_BUILD
+static std::mutex queueLock;
+static std::condition_variable queueSignal;   // Work for the worker
+static std::condition_variable spaceSignal;   // Room in the queue
+static OrbitCommand queueItems[ORBIT_QUEUE_DEPTH];
+static int queueHead = 0, queueCount = 0;
+static std::thread worker;
+
+static bool sendCommand(const OrbitCommand &cmd) {
+    std::unique_lock<std::mutex> lock(queueLock);
+    if (!spaceSignal.wait_for(lock, std::chrono::milliseconds(ORBIT_SEND_WAIT_MS),
+                              [] { return queueCount < ORBIT_QUEUE_DEPTH; })) {
+        return false;
+    }
+    queueItems[(queueHead + queueCount) % ORBIT_QUEUE_DEPTH] = cmd;
+    queueCount++;
+    queueSignal.notify_one();
+    return true;
+}
+
+static void lockLatest() { queueLock.lock(); }
+static void unlockLatest() { queueLock.unlock(); }
+static void wakeWorker() { queueSignal.notify_one(); }
+
+// Returns once there is a command or a latest-value request, or after `waitMs`
+static void waitForRequest(unsigned long waitMs) {
+    std::unique_lock<std::mutex> lock(queueLock);
+    queueSignal.wait_for(lock, std::chrono::milliseconds(waitMs),
+                         [] { return queueCount > 0 || latest.site || latest.params; });
+}
+
+static bool receiveCommand(OrbitCommand &cmd) {
+    std::lock_guard<std::mutex> lock(queueLock);
+    if (queueCount == 0) return false;
+    cmd = queueItems[queueHead];
+    queueHead = (queueHead + 1) % ORBIT_QUEUE_DEPTH;
+    queueCount--;
+    spaceSignal.notify_all();
+    return true;
+}
+#else
+static QueueHandle_t commandQueue = nullptr;
+static TaskHandle_t workerHandle = nullptr;
+static portMUX_TYPE latestMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void lockLatest() { portENTER_CRITICAL(&latestMux); }
+static void unlockLatest() { portEXIT_CRITICAL(&latestMux); }
+
+static void wakeWorker() {
+    if (workerHandle) xTaskNotifyGive(workerHandle);
+}
+
+static bool sendCommand(const OrbitCommand &cmd) {
+    if (!commandQueue || xQueueSend(commandQueue, &cmd, pdMS_TO_TICKS(ORBIT_SEND_WAIT_MS)) != pdTRUE) return false;
+    wakeWorker();
+    return true;
+}
+
+// Every send and post also notifies the worker, so a wake that lands
+// between the check and the wait isn't lost
+static void waitForRequest(unsigned long waitMs) {
+    if (uxQueueMessagesWaiting(commandQueue) > 0) return;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+}
+
+static bool receiveCommand(OrbitCommand &cmd) {
+    return xQueueReceive(commandQueue, &cmd, 0) == pdTRUE;
+}
+#endif
+
+// Hands the worker whatever is pending and clears the slot
+static LatestRequests takeLatest() {
+    lockLatest();
+    LatestRequests l = latest;
+    latest.site = latest.siteForced = latest.params = false;
+    unlockLatest();
+    return l;
+}
+
+// --- WORKER ---
+static double defaultClock() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static double (*orbitClock)() = defaultClock;
+static unsigned long trackUntil = 0;   // Radar track is good until then (0 = stale)
+static unsigned long overheadAt = 0;   // Second of the last catalog sweep
+
+static void sampleLive(OrbitSnapshot &snap, double now) {
+    snap.ready = isOrbitReady();
+    snap.unixtime = now;
+    satName.toCharArray(snap.name, sizeof(snap.name));
+    if (!snap.ready) return;
+
+    SatPosition p = satellitePosition(now);
+    snap.lat = p.lat;
+    snap.lon = p.lon;
+    snap.altKm = p.altKm;
+    snap.az = p.az;
+    snap.el = p.el;
+}
+
+// Radar track for the pass in progress, or the next scheduled one. Kept
+// until that pass's LOS; the UI projects it to screen points only when
+// trackGen changes.
+static void updateTrack(OrbitSnapshot &snap, unsigned long now) {
+    if (trackUntil != 0 && now < trackUntil) return;
+
+    PassDetails p;
+    bool have = snap.ready && passInProgress(now, p);
+    for (int i = 0; !have && i < passSchedule.count; i++) {
+        if (passSchedule.passes[i].aosUnix > now) {
+            p = passSchedule.passes[i];
+            have = true;
+        }
+    }
+
+    snap.trackGen++;
+    if (!have) {
+        snap.trackCount = 0;
+        trackUntil = now + 60;  // Look again in a minute
+        return;
+    }
+
+    unsigned long span = p.losUnix - p.aosUnix;
+    for (int i = 0; i < RADAR_TRACK_POINTS; i++) {
+        LookAngles la = satelliteLookAngles(p.aosUnix + (double)span * i / (RADAR_TRACK_POINTS - 1));
+        snap.trackAz[i] = la.az;
+        snap.trackEl[i] = la.el;
+    }
+    snap.trackCount = RADAR_TRACK_POINTS;
+    trackUntil = p.losUnix;
+}
+
+// One batch propagation of the whole catalog per second
+static void updateOverhead(OrbitSnapshot &snap, unsigned long now, const Observer *site) {
+    snap.catalogCount = catalogCount();
+    snap.catalogSkipped = catalogRejected();
+    if (snap.catalogCount == 0 || !site || now == overheadAt) return;
+    overheadAt = now;
+
+    catalogPropagate(now);
+    snap.overheadCount = catalogOverhead(*site, 0, snap.overhead, OVERHEAD_MAX, snap.overheadTotal);
+    snap.overheadGen++;
+}
+
+static PassCacheKey currentPassKey(double siteLat, double siteLon, int minEl) {
+    return passCacheKey(tleCatalogNumber, tleEpochUnix, siteLat, siteLon, minEl);
+}
+
+static void copyPasses(OrbitSnapshot &snap) {
+    trackUntil = 0;  // The next pass may have changed
+    snap.passGen++;
+    snap.passVisibility = passSchedule.visibility;
+    snap.passCount = passSchedule.count;
+    memcpy(snap.passes, passSchedule.passes, passSchedule.count * sizeof(PassDetails));
+}
+
+static void workerLoop() {
+    static OrbitSnapshot snap;  // Too big for the task stack
+    memset(&snap, 0, sizeof(snap));
+
+    double siteLat = 0, siteLon = 0;
+    Observer site;
+    bool haveSite = false;
+    int minEl = DEFAULT_MIN_EL;
+    unsigned long horizonSecs = DEFAULT_PASS_DAYS * 86400UL;
+    unsigned long lastLiveMs = millis() - ORBIT_LIVE_PERIOD_MS;
+
+    for (;;) {
+        // Sleep until the next live sample is due or a request arrives
+        unsigned long elapsed = millis() - lastLiveMs;
+        unsigned long waitMs = elapsed >= ORBIT_LIVE_PERIOD_MS ? 0 : ORBIT_LIVE_PERIOD_MS - elapsed;
+
+        waitForRequest(waitMs);
+        bool stop = false;
+        bool passesReset = false;
+        bool passesCached = false;
+
+        // The newest site and filter first, then the queue in order
+        LatestRequests req = takeLatest();
+        // GPS jitter: the site geometry and passes stand until it really moves
+        bool jitter = haveSite && !req.siteForced && observerDistanceKm(site, req.lat, req.lon) < SITE_MOVE_KM;
+        if (req.site && !jitter) {
+            siteLat = req.lat;
+            siteLon = req.lon;
+            setupOrbitLocation(siteLat, siteLon);
+            site = makeObserver(siteLat, siteLon, OBS_ALT_M);
+            haveSite = true;
+            trackUntil = 0;
+            overheadAt = 0;
+            passesReset = passSchedule.searchedUntil == 0;
+        }
+        if (req.params) {
+            passesReset = passesReset || req.minEl != minEl;
+            minEl = req.minEl;
+            horizonSecs = req.horizonDays * 86400UL;
+        }
+
+        OrbitCommand cmd;
+        while (receiveCommand(cmd)) {
+            switch (cmd.type) {
+                case CMD_LOAD_TLE:
+                    loadTLERecord(cmd.tle);
+                    passesReset = true;
+                    trackUntil = 0;
+                    break;
+                case CMD_CACHED_PASSES:
+                    // Only for what is loaded now; the search fills in the rest
+                    if (isOrbitReady() && passCacheKeyEqual(cmd.key, currentPassKey(siteLat, siteLon, minEl))) {
+                        passSchedule = *cmd.cached;
+                        passesCached = true;
+                    }
+                    break;
+                case CMD_STOP:
+                    stop = true;
+                    break;
+            }
+        }
+        if (stop) break;
+
+        double nowPrecise = orbitClock();
+        unsigned long now = (unsigned long)nowPrecise;
+        lastLiveMs = millis();
+        sampleLive(snap, nowPrecise);
+        snap.minEl = minEl;
+
+        if (passesReset) {
+            snap.passCount = 0;
+            snap.passGen++;
+        }
+        if (passesCached) copyPasses(snap);
+
+        if (passScheduleNeedsWork(passSchedule, now, minEl, horizonSecs)) {
+            // Let the UI say "Calculating..." while we search
+            snap.searching = true;
+            publishSnapshot(snap);
+            updatePassSchedule(passSchedule, now, minEl, horizonSecs);
+            copyPasses(snap);
+        } else if (updatePassSchedule(passSchedule, now, minEl, horizonSecs)) {
+            copyPasses(snap);
+        }
+        snap.searching = false;
+        snap.passSearchedUntil = passSchedule.searchedUntil;
+        snap.passKey = currentPassKey(siteLat, siteLon, passSchedule.minEl);
+        updateTrack(snap, now);
+        updateOverhead(snap, now, haveSite ? &site : nullptr);
+        publishSnapshot(snap);
+    }
+}
+
+// --- PUBLIC API ---
+void orbitTaskStart(double (*clock)(), void (*published)()) {
+    if (clock) orbitClock = clock;
+    publishedFn = published;
+    // Start from an empty handoff, as on a fresh boot
+    memset(slots, 0, sizeof(slots));
+    memset(&latest, 0, sizeof(latest));
+    middleSlot = 1;
+    backSlot = 2;
+    frontSlot = 0;
+#ifdef NATIVE_BUILD
+    worker = std::thread(workerLoop);
+#else
+    commandQueue = xQueueCreate(ORBIT_QUEUE_DEPTH, sizeof(OrbitCommand));
+    xTaskCreatePinnedToCore([](void *) { workerLoop(); vTaskDelete(nullptr); },
+                            "orbit", ORBIT_TASK_STACK, nullptr, 1, &workerHandle, ORBIT_TASK_CORE);
+#endif
+}
+
+void orbitTaskStop() {
+    OrbitCommand cmd = {};
+    cmd.type = CMD_STOP;
+    sendCommand(cmd);
+#ifdef NATIVE_BUILD
+    if (worker.joinable()) worker.join();
+#endif
+}
+
+uint32_t orbitTaskStackFree() {
+#ifdef NATIVE_BUILD
+    return 0;
+#else
+    return workerHandle ? uxTaskGetStackHighWaterMark(workerHandle) : 0;
+#endif
+}
+
+bool orbitRequestTLE(const TleRecord &rec) {
+    OrbitCommand cmd = {};
+    cmd.type = CMD_LOAD_TLE;
+    cmd.tle = rec;
+    return sendCommand(cmd);
+}
+
+void orbitRequestSite(double lat, double lon, bool force) {
+    lockLatest();
+    latest.site = true;
+    latest.siteForced = latest.siteForced || force;
+    latest.lat = lat;
+    latest.lon = lon;
+    unlockLatest();
+    wakeWorker();
+}
+
+bool orbitRequestCachedPasses(const PassSchedule *cached, const PassCacheKey &key) {
+    OrbitCommand cmd = {};
+    cmd.type = CMD_CACHED_PASSES;
+    cmd.cached = cached;
+    cmd.key = key;
+    return sendCommand(cmd);
+}
+
+void orbitRequestPassParams(int minEl, int horizonDays) {
+    lockLatest();
+    latest.params = true;
+    latest.minEl = minEl;
+    latest.horizonDays = horizonDays;
+    unlockLatest();
+    wakeWorker();
+}
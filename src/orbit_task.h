@@ -0,0 +1,75 @@
+#pragma once
+#include <Arduino.h>
+#include "orbit.h"
+#include "catalog.h"
+#include "pass_cache.h"
+
+// --- ORBIT WORKER ---
+// All propagation and pass searching runs on a worker task (pinned to core 0
+// on the device, std::thread on the host build). The UI never touches the
+// loaded elements or the pass schedule directly: it posts requests and reads
+// the latest published snapshot, so a long search can't stall a frame.
+
+#define RADAR_TRACK_POINTS 32   // AOS to LOS, evenly spaced
+#define OVERHEAD_MAX       5    // Rows on the "Overhead Now" screen
+#define ORBIT_SEND_WAIT_MS 200  // A queued request waits this long for room
+
+struct OrbitSnapshot {
+    bool ready;                 // TLE loaded and SGP4 initialised
+    char name[25];
+
+    // Live state at `unixtime` (sub-second)
+    double unixtime;
+    double lat, lon, altKm;
+    double az, el;
+
+    // Radar track: the pass in progress, else the next scheduled one.
+    // Sampled once per pass; trackGen changes whenever it is resampled.
+    uint32_t trackGen;
+    int trackCount;
+    float trackAz[RADAR_TRACK_POINTS];
+    float trackEl[RADAR_TRACK_POINTS];
+
+    // Pass schedule (bumps passGen whenever the list changes)
+    bool searching;
+    uint32_t passGen;
+    int minEl;
+    PassVisibility passVisibility;
+    int passCount;
+    PassDetails passes[PASS_SCHEDULE_MAX];
+    unsigned long passSearchedUntil;  // 0 while there is no schedule
+    PassCacheKey passKey;             // What the schedule was searched for
+
+    // Catalog satellites above the horizon, highest first. Refreshed once
+    // a second; overheadGen changes with each refresh.
+    uint32_t overheadGen;
+    int catalogCount;
+    long catalogSkipped;  // Deep-space objects left out of the catalog
+    int overheadTotal;
+    int overheadCount;
+    CatalogSighting overhead[OVERHEAD_MAX];
+};
+
+// `published` is called on the worker after each new snapshot (to wake the UI)
+void orbitTaskStart(double (*clock)() = nullptr, void (*published)() = nullptr);
+void orbitTaskStop();
+// Worker stack never used so far, bytes (0 on the host)
+uint32_t orbitTaskStackFree();
+
+// Requests (UI side). A site or filter change replaces any still pending
+// and never blocks. TLE loads and cached schedules queue; if the queue stays
+// full for ORBIT_SEND_WAIT_MS they return false and the request is dropped.
+bool orbitRequestTLE(const TleRecord &rec);
+// Ignored while within SITE_MOVE_KM of the site in use (GPS jitter),
+// unless `force`: a site typed in always applies
+void orbitRequestSite(double lat, double lon, bool force = false);
+void orbitRequestPassParams(int minEl, int horizonDays);
+// Offers a schedule read back from the pass cache. It's used only if `key`
+// still matches the loaded TLE, site and minimum elevation once the requests
+// before it are applied; `cached` must stay untouched after the call.
+bool orbitRequestCachedPasses(const PassSchedule *cached, const PassCacheKey &key);
+
+// Snapshot (UI side). orbitPoll() picks up the newest published snapshot and
+// returns true if there was one; orbitView() stays stable until the next poll.
+bool orbitPoll();
+const OrbitSnapshot &orbitView();
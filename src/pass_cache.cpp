@@ -0,0 +1,127 @@
+#include "pass_cache.h"
+#include "storage.h"
+#include <limits.h>
+#include <math.h>
+#include <stddef.h>
+
+#define PASS_CACHE_MAGIC   0x50535349UL   // "ISSP"
+#define PASS_CACHE_VERSION 1
+
+struct PassCacheHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entrySize;      // Changes with the firmware's struct layout
+};
+
+struct PassCacheEntry {
+    uint32_t used;
+    uint32_t savedAt;
+    PassCacheKey key;
+    PassSchedule schedule;
+    uint32_t check;          // FNV-1a over everything above; catches torn writes
+};
+
+static PassCacheEntry entry;  // Shared scratch; too big for a task stack
+
+static uint32_t entryCheck(const PassCacheEntry &e) {
+    const uint8_t *p = (const uint8_t *)&e;
+    uint32_t h = 2166136261UL;
+    for (size_t i = 0; i < offsetof(PassCacheEntry, check); i++) {
+        h = (h ^ p[i]) * 16777619UL;
+    }
+    return h;
+}
+
+static uint32_t entryOffset(int slot) {
+    return sizeof(PassCacheHeader) + slot * sizeof(PassCacheEntry);
+}
+
+PassCacheKey passCacheKey(long catalogNumber, unsigned long epochUnix, double lat, double lon, int minEl) {
+    PassCacheKey k;
+    k.catalogNumber = catalogNumber;
+    k.epochUnix = epochUnix;
+    k.latBucket = (int32_t)lround(lat / PASS_CACHE_SITE_BUCKET);
+    k.lonBucket = (int32_t)lround(lon / PASS_CACHE_SITE_BUCKET);
+    k.minEl = minEl;
+    return k;
+}
+
+bool passCacheKeyEqual(const PassCacheKey &a, const PassCacheKey &b) {
+    return a.catalogNumber == b.catalogNumber && a.epochUnix == b.epochUnix &&
+           a.latBucket == b.latBucket && a.lonBucket == b.lonBucket && a.minEl == b.minEl;
+}
+
+static bool headerOK(StorageFile &f) {
+    PassCacheHeader h;
+    return storageRead(f, &h, sizeof(h)) == sizeof(h) && h.magic == PASS_CACHE_MAGIC &&
+           h.version == PASS_CACHE_VERSION && h.entrySize == sizeof(PassCacheEntry);
+}
+
+bool passCacheLoad(const char *path, const PassCacheKey &key, PassSchedule &out) {
+    StorageFile f = storageOpen(path, STORAGE_READ);
+    if (!storageOk(f)) return false;
+
+    bool found = false;
+    if (headerOK(f)) {
+        for (int i = 0; i < PASS_CACHE_SLOTS && !found; i++) {
+            if (storageRead(f, &entry, sizeof(entry)) != sizeof(entry)) break;
+            found = entry.used && passCacheKeyEqual(entry.key, key) && entry.check == entryCheck(entry) &&
+                    entry.schedule.count >= 0 && entry.schedule.count <= PASS_SCHEDULE_MAX;
+        }
+    }
+    storageClose(f);
+    if (found) out = entry.schedule;
+    return found;
+}
+
+// Writes a header and empty slots
+static bool createCache(const char *path) {
+    StorageFile f = storageOpen(path, STORAGE_WRITE);
+    if (!storageOk(f)) return false;
+    PassCacheHeader h = {PASS_CACHE_MAGIC, PASS_CACHE_VERSION, sizeof(PassCacheEntry)};
+    bool ok = storageWrite(f, &h, sizeof(h)) == sizeof(h);
+    memset(&entry, 0, sizeof(entry));
+    for (int i = 0; ok && i < PASS_CACHE_SLOTS; i++) {
+        ok = storageWrite(f, &entry, sizeof(entry)) == sizeof(entry);
+    }
+    storageClose(f);
+    return ok;
+}
+
+bool passCacheSave(const char *path, const PassCacheKey &key, const PassSchedule &s, unsigned long nowUnix) {
+    StorageFile f = storageOpen(path, STORAGE_UPDATE);
+    if (storageOk(f) && !headerOK(f)) storageClose(f);
+    if (!storageOk(f)) {
+        if (!createCache(path)) return false;
+        f = storageOpen(path, STORAGE_UPDATE);
+        if (!storageOk(f) || !headerOK(f)) {
+            if (storageOk(f)) storageClose(f);
+            return false;
+        }
+    }
+
+    // Same key, else an empty or torn slot, else the oldest
+    int slot = -1, spare = -1, oldest = 0;
+    uint32_t oldestAt = UINT32_MAX;
+    for (int i = 0; i < PASS_CACHE_SLOTS && slot < 0; i++) {
+        if (storageRead(f, &entry, sizeof(entry)) != sizeof(entry)) break;
+        bool intact = entry.used && entry.check == entryCheck(entry);
+        if (intact && passCacheKeyEqual(entry.key, key)) slot = i;
+        else if (!intact && spare < 0) spare = i;
+        else if (intact && entry.savedAt < oldestAt) {
+            oldestAt = entry.savedAt;
+            oldest = i;
+        }
+    }
+    if (slot < 0) slot = (spare >= 0) ? spare : oldest;
+
+    memset(&entry, 0, sizeof(entry));
+    entry.used = 1;
+    entry.savedAt = nowUnix;
+    entry.key = key;
+    entry.schedule = s;
+    entry.check = entryCheck(entry);
+    bool ok = storageSeek(f, entryOffset(slot)) && storageWrite(f, &entry, sizeof(entry)) == sizeof(entry);
+    storageClose(f);
+    return ok;
+}
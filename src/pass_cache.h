@@ -0,0 +1,28 @@
+#pragma once
+#include <Arduino.h>
+#include "orbit.h"
+
+// --- PASS CACHE ---
+// Computed pass schedules kept on SD so a reboot can show the PASS screens
+// straight away and only search the time past what was already covered.
+// A schedule is only valid for the exact TLE, site and minimum elevation it
+// was searched with; the site is bucketed so GPS jitter doesn't miss.
+
+#define PASS_CACHE_SLOTS        4
+#define PASS_CACHE_SITE_BUCKET  0.01    // deg (~1 km, a few seconds of AOS)
+
+struct PassCacheKey {
+    int32_t catalogNumber;
+    uint32_t epochUnix;      // TLE epoch (s)
+    int32_t latBucket, lonBucket;
+    int32_t minEl;
+};
+
+PassCacheKey passCacheKey(long catalogNumber, unsigned long epochUnix, double lat, double lon, int minEl);
+bool passCacheKeyEqual(const PassCacheKey &a, const PassCacheKey &b);
+
+// False if nothing intact is stored under `key`
+bool passCacheLoad(const char *path, const PassCacheKey &key, PassSchedule &out);
+
+// Stores `s` under `key`, over the same key or else the oldest slot
+bool passCacheSave(const char *path, const PassCacheKey &key, const PassSchedule &s, unsigned long nowUnix);
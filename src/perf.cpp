@@ -0,0 +1,132 @@
+#include "perf.h"
+
+#if PERF_ENABLED
+#include "orbit_task.h"
+
+#ifndef NATIVE_BUILD
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+struct PerfHistogram {
+    uint16_t bucket[PERF_BUCKETS];
+    uint32_t count;
+    uint32_t sum;
+    uint32_t minUs, maxUs;
+};
+
+static const char *const PHASE_NAMES[PERF_PHASES] = {
+    "loop", "input", "gps", "keys", "net", "orbit", "draw", "push", "idle"
+};
+
+static PerfHistogram hist[PERF_PHASES];
+static PerfReport report;
+static unsigned long windowStart = 0;
+static bool streaming = false;
+
+// 0-15 one bucket per microsecond, then 4 per power of two
+static int bucketOf(uint32_t us) {
+    if (us < 16) return us;
+    int octave = 31 - __builtin_clz(us);
+    int b = 16 + (octave - 4) * 4 + ((us >> (octave - 2)) & 3);
+    return b < PERF_BUCKETS ? b : PERF_BUCKETS - 1;
+}
+
+// The largest value that lands in bucket `b`
+static uint32_t bucketTop(int b) {
+    if (b < 16) return b;
+    int octave = 4 + (b - 16) / 4;
+    int sub = (b - 16) % 4;
+    return ((uint32_t)(5 + sub) << (octave - 2)) - 1;
+}
+
+void perfRecord(PerfPhase phase, uint32_t us) {
+    PerfHistogram &h = hist[phase];
+    uint16_t &n = h.bucket[bucketOf(us)];
+    if (n < UINT16_MAX) n++;
+    if (h.count == 0 || us < h.minUs) h.minUs = us;
+    if (us > h.maxUs) h.maxUs = us;
+    h.count++;
+    h.sum += us;
+}
+
+static void summarise(const PerfHistogram &h, PerfPhaseStats &s) {
+    s.count = h.count;
+    if (h.count == 0) {
+        s.minUs = s.avgUs = s.p99Us = s.maxUs = 0;
+        return;
+    }
+    s.minUs = h.minUs;
+    s.maxUs = h.maxUs;
+    s.avgUs = h.sum / h.count;
+
+    uint32_t target = h.count - h.count / 100;  // 99% of samples at or below
+    uint32_t seen = 0;
+    s.p99Us = h.maxUs;
+    for (int b = 0; b < PERF_BUCKETS; b++) {
+        seen += h.bucket[b];
+        if (seen >= target) {
+            uint32_t top = bucketTop(b);
+            s.p99Us = top < h.maxUs ? top : h.maxUs;
+            break;
+        }
+    }
+}
+
+static void sampleSystem(PerfReport &r) {
+#ifndef NATIVE_BUILD
+    r.freeHeap = ESP.getFreeHeap();
+    r.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    r.minFreeHeap = ESP.getMinFreeHeap();
+    r.loopStackFree = uxTaskGetStackHighWaterMark(nullptr);  // Called from loop()
+#endif
+    r.orbitStackFree = orbitTaskStackFree();
+}
+
+static void printReport(const PerfReport &r) {
+    Serial.printf("perf #%lu heap=%lu big=%lu min=%lu stack loop=%lu orbit=%lu px/s=%lu\n",
+                  (unsigned long)r.seq, (unsigned long)r.freeHeap, (unsigned long)r.largestBlock,
+                  (unsigned long)r.minFreeHeap, (unsigned long)r.loopStackFree,
+                  (unsigned long)r.orbitStackFree, (unsigned long)r.pixelsPerSec);
+    for (int i = 0; i < PERF_PHASES; i++) {
+        const PerfPhaseStats &s = r.phase[i];
+        Serial.printf("perf %-5s n=%lu min=%lu avg=%lu p99=%lu max=%lu us\n", PHASE_NAMES[i],
+                      (unsigned long)s.count, (unsigned long)s.minUs, (unsigned long)s.avgUs,
+                      (unsigned long)s.p99Us, (unsigned long)s.maxUs);
+    }
+}
+
+bool perfPoll(uint32_t pixelsPerSec) {
+    unsigned long now = millis();
+    if (now - windowStart < PERF_WINDOW_MS) return false;
+
+    report.seq++;
+    report.windowMs = now - windowStart;
+    for (int i = 0; i < PERF_PHASES; i++) summarise(hist[i], report.phase[i]);
+    report.pixelsPerSec = pixelsPerSec;
+    sampleSystem(report);
+    memset(hist, 0, sizeof(hist));
+    windowStart = now;
+
+    if (streaming) printReport(report);
+    return true;
+}
+
+const PerfReport &perfReport() {
+    return report;
+}
+
+const char *perfPhaseName(PerfPhase phase) {
+    return phase < PERF_PHASES ? PHASE_NAMES[phase] : "?";
+}
+
+void perfStream(bool on) {
+    streaming = on;
+}
+
+bool perfStreaming() {
+    return streaming;
+}
+
+#endif
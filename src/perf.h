@@ -0,0 +1,66 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// --- PERF ---
+// Where loop() spends its time. PERF_BEGIN / PERF_END around a phase feed
+// a histogram of microseconds: exact below 16 us, then four buckets per
+// power of two, so p99 is within 25%. Every PERF_WINDOW_MS the histograms
+// are summarised and cleared and the heap and stack watermarks sampled;
+// the report shows on the hidden diagnostics screen and, if streaming is
+// on, goes out over Serial. With PERF_ENABLED 0 the macros are empty.
+
+enum PerfPhase : uint8_t {
+    PERF_LOOP,      // Everything but the idle delay
+    PERF_INPUT,     // Keyboard / button scan
+    PERF_GPS,       // UART drain and NMEA parse
+    PERF_KEYS,      // Acting on keys (includes text input and screenshots)
+    PERF_NET,
+    PERF_ORBIT,     // Snapshot pickup, LED, AOS audio, pass cache save
+    PERF_DRAW,      // Into the canvas
+    PERF_PUSH,      // Canvas to panel
+    PERF_IDLE,
+    PERF_PHASES
+};
+
+#if PERF_ENABLED
+
+#define PERF_BUCKETS 96
+
+struct PerfPhaseStats {
+    uint32_t count;
+    uint32_t minUs, avgUs, p99Us, maxUs;
+};
+
+struct PerfReport {
+    uint32_t seq;               // Bumps with every window
+    uint32_t windowMs;
+    PerfPhaseStats phase[PERF_PHASES];
+    uint32_t freeHeap;          // Bytes (0 on the host)
+    uint32_t largestBlock;
+    uint32_t minFreeHeap;       // Lowest since boot
+    uint32_t loopStackFree;     // Stack never touched, bytes
+    uint32_t orbitStackFree;
+    uint32_t pixelsPerSec;      // Sent to the panel
+};
+
+void perfRecord(PerfPhase phase, uint32_t us);
+
+// Closes the window once PERF_WINDOW_MS is up; true if a new report is out
+bool perfPoll(uint32_t pixelsPerSec);
+const PerfReport &perfReport();
+const char *perfPhaseName(PerfPhase phase);
+
+// Each report to Serial as it closes
+void perfStream(bool on);
+bool perfStreaming();
+
+#define PERF_BEGIN(phase) uint32_t perfStart_##phase = micros()
+#define PERF_END(phase)   perfRecord(phase, micros() - perfStart_##phase)
+
+#else
+
+#define PERF_BEGIN(phase)
+#define PERF_END(phase)
+
+#endif
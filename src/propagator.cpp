@@ -0,0 +1,367 @@
+#include "propagator.h"
+#include <cmath>
+
+// WGS-72, to match the constants the TLEs are fitted with
+static const double EARTH_RADIUS_KM = 6378.135;
+static const double EARTH_FLATTENING = 1.0 / 298.26;
+static const double EARTH_E2 = EARTH_FLATTENING * (2.0 - EARTH_FLATTENING);
+static const double EARTH_J2 = 0.001082616;
+static const double EARTH_XKE = 0.0743669161331734132;  // sqrt(mu / Re^3), per minute
+
+template <typename T>
+static void loadCoeffs(NearEarthCoeffs<T> &c, const elsetrec &r) {
+    c.simple = r.isimp == 1;
+    c.no = r.no;         c.ecco = r.ecco;     c.inclo = r.inclo;   c.bstar = r.bstar;
+    c.cc1 = r.cc1;       c.cc4 = r.cc4;       c.cc5 = r.cc5;
+    c.d2 = r.d2;         c.d3 = r.d3;         c.d4 = r.d4;
+    c.t2cof = r.t2cof;   c.t3cof = r.t3cof;   c.t4cof = r.t4cof;   c.t5cof = r.t5cof;
+    c.eta = r.eta;       c.delmo = r.delmo;   c.sinmao = r.sinmao;
+    c.omgcof = r.omgcof; c.xmcof = r.xmcof;   c.nodecf = r.nodecf;
+    c.con41 = r.con41;   c.x1mth2 = r.x1mth2; c.x7thm1 = r.x7thm1;
+    c.xlcof = r.xlcof;   c.aycof = r.aycof;
+}
+
+bool loadElements(SatElements &out, const char *name, const char *line1, const char *line2) {
+    // The library's init() does the TLE decoding and sgp4init for us;
+    // we only keep the resulting record.
+    char l1[130], l2[130];
+    strncpy(l1, line1, sizeof(l1) - 1); l1[sizeof(l1) - 1] = 0;
+    strncpy(l2, line2, sizeof(l2) - 1); l2[sizeof(l2) - 1] = 0;
+
+    Sgp4 decoder;
+    if (!decoder.init(name, l1, l2)) return false;
+
+    out.rec = decoder.satrec;
+    out.epochUnix = (out.rec.jdsatepoch - 2440587.5) * 86400.0;
+    out.nearEarth = out.rec.method != 'd';
+    out.periodMin = TWO_PI / out.rec.no;
+    double aKm = pow(EARTH_XKE / out.rec.no, 2.0 / 3.0) * EARTH_RADIUS_KM;
+    out.perigeeKm = aKm * (1.0 - out.rec.ecco) - EARTH_RADIUS_KM;
+    out.apogeeKm = aKm * (1.0 + out.rec.ecco) - EARTH_RADIUS_KM;
+    loadCoeffs(out.coeffsF, out.rec);
+    loadCoeffs(out.coeffsD, out.rec);
+    strncpy(out.name, name, sizeof(out.name) - 1);
+    out.name[sizeof(out.name) - 1] = 0;
+    return true;
+}
+
+// --- NEAR-EARTH SGP4 ---
+// The library's sgp4() without the deep-space branches, templated on the
+// scalar type. The secular angle terms (mo + mdot * t etc.) are summed in
+// double and wrapped to one turn first; left in float they alone cost
+// ~0.5 km along-track after a week. Everything after that is T.
+
+template <typename T> static const NearEarthCoeffs<T> &coeffsFor(const SatElements &el);
+template <> const NearEarthCoeffs<float> &coeffsFor<float>(const SatElements &el) { return el.coeffsF; }
+template <> const NearEarthCoeffs<double> &coeffsFor<double>(const SatElements &el) { return el.coeffsD; }
+
+// Kepler solver tolerance, a few ulps of an angle near 2*pi
+template <typename T> static T keplerTol();
+template <> float keplerTol<float>() { return 1e-6f; }
+template <> double keplerTol<double>() { return 1e-12; }
+
+template <typename T>
+bool sgp4NearEarthCore(const NearEarthCoeffs<T> &c, T xmdf, T argpdf, T nodedf, T t, T r[3], T v[3]) {
+    using std::sin; using std::cos; using std::sqrt; using std::pow; using std::fmod; using std::atan2; using std::fabs;
+    const T twoPi = (T)TWO_PI;
+    const T xke = (T)EARTH_XKE;
+    const T j2 = (T)EARTH_J2;
+
+    // Drag
+    T t2 = t * t;
+    T argpm = argpdf;
+    T mm = xmdf;
+    T nodem = nodedf + c.nodecf * t2;
+    T tempa = 1 - c.cc1 * t;
+    T tempe = c.bstar * c.cc4 * t;
+    T templ = c.t2cof * t2;
+    if (!c.simple) {
+        T delomg = c.omgcof * t;
+        T delmtemp = 1 + c.eta * cos(xmdf);
+        T delm = c.xmcof * (delmtemp * delmtemp * delmtemp - c.delmo);
+        T temp = delomg + delm;
+        mm = xmdf + temp;
+        argpm = argpdf - temp;
+        T t3 = t2 * t;
+        T t4 = t3 * t;
+        tempa = tempa - c.d2 * t2 - c.d3 * t3 - c.d4 * t4;
+        tempe = tempe + c.bstar * c.cc5 * (sin(mm) - c.sinmao);
+        templ = templ + c.t3cof * t3 + t4 * (c.t4cof + t * c.t5cof);
+    }
+
+    if (c.no <= 0) return false;
+    T am = pow(xke / c.no, (T)2 / 3) * tempa * tempa;
+    T nm = xke / pow(am, (T)1.5);
+    T em = c.ecco - tempe;
+    if (em >= 1 || em < (T)-0.001) return false;
+    if (em < (T)1e-6) em = (T)1e-6;
+
+    mm = mm + c.no * templ;
+    T xlm = fmod(mm + argpm + nodem, twoPi);
+    nodem = fmod(nodem, twoPi);
+    argpm = fmod(argpm, twoPi);
+    mm = fmod(xlm - argpm - nodem, twoPi);
+
+    // Long-period periodics
+    T sinip = sin(c.inclo);
+    T cosip = cos(c.inclo);
+    T axnl = em * cos(argpm);
+    T temp = 1 / (am * (1 - em * em));
+    T aynl = em * sin(argpm) + temp * c.aycof;
+    T xl = mm + argpm + nodem + temp * c.xlcof * axnl;
+
+    // Kepler's equation
+    T u = fmod(xl - nodem, twoPi);
+    T eo1 = u;
+    T tem5 = 9999;
+    T sineo1 = 0, coseo1 = 1;
+    for (int ktr = 0; fabs(tem5) >= keplerTol<T>() && ktr < 10; ktr++) {
+        sineo1 = sin(eo1);
+        coseo1 = cos(eo1);
+        tem5 = 1 - coseo1 * axnl - sineo1 * aynl;
+        tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+        if (fabs(tem5) >= (T)0.95) tem5 = tem5 > 0 ? (T)0.95 : (T)-0.95;
+        eo1 = eo1 + tem5;
+    }
+
+    // Short-period periodics
+    T ecose = axnl * coseo1 + aynl * sineo1;
+    T esine = axnl * sineo1 - aynl * coseo1;
+    T el2 = axnl * axnl + aynl * aynl;
+    T pl = am * (1 - el2);
+    if (pl < 0) return false;
+
+    T rl = am * (1 - ecose);
+    T rdotl = sqrt(am) * esine / rl;
+    T rvdotl = sqrt(pl) / rl;
+    T betal = sqrt(1 - el2);
+    temp = esine / (1 + betal);
+    T sinu = am / rl * (sineo1 - aynl - axnl * temp);
+    T cosu = am / rl * (coseo1 - axnl + aynl * temp);
+    T su = atan2(sinu, cosu);
+    T sin2u = (cosu + cosu) * sinu;
+    T cos2u = 1 - 2 * sinu * sinu;
+    temp = 1 / pl;
+    T temp1 = (T)0.5 * j2 * temp;
+    T temp2 = temp1 * temp;
+
+    T mrt = rl * (1 - (T)1.5 * temp2 * betal * c.con41) + (T)0.5 * temp1 * c.x1mth2 * cos2u;
+    su = su - (T)0.25 * temp2 * c.x7thm1 * sin2u;
+    T xnode = nodem + (T)1.5 * temp2 * cosip * sin2u;
+    T xinc = c.inclo + (T)1.5 * temp2 * cosip * sinip * cos2u;
+    T mvt = rdotl - nm * temp1 * c.x1mth2 * sin2u / xke;
+    T rvdot = rvdotl + nm * temp1 * (c.x1mth2 * cos2u + (T)1.5 * c.con41) / xke;
+
+    // Orientation vectors
+    T sinsu = sin(su), cossu = cos(su);
+    T snod = sin(xnode), cnod = cos(xnode);
+    T sini = sin(xinc), cosi = cos(xinc);
+    T xmx = -snod * cosi;
+    T xmy = cnod * cosi;
+    T ux = xmx * sinsu + cnod * cossu;
+    T uy = xmy * sinsu + snod * cossu;
+    T uz = sini * sinsu;
+    T vx = xmx * cossu - cnod * sinsu;
+    T vy = xmy * cossu - snod * sinsu;
+    T vz = sini * cossu;
+
+    const T kmPerSec = (T)(EARTH_RADIUS_KM * EARTH_XKE / 60.0);
+    r[0] = mrt * ux * (T)EARTH_RADIUS_KM;
+    r[1] = mrt * uy * (T)EARTH_RADIUS_KM;
+    r[2] = mrt * uz * (T)EARTH_RADIUS_KM;
+    v[0] = (mvt * ux + rvdot * vx) * kmPerSec;
+    v[1] = (mvt * uy + rvdot * vy) * kmPerSec;
+    v[2] = (mvt * uz + rvdot * vz) * kmPerSec;
+
+    return mrt >= 1;  // Below 1 Earth radius: decayed
+}
+
+template bool sgp4NearEarthCore<float>(const NearEarthCoeffs<float> &, float, float, float, float, float[3], float[3]);
+template bool sgp4NearEarthCore<double>(const NearEarthCoeffs<double> &, double, double, double, double, double[3], double[3]);
+
+template <typename T>
+static bool sgp4NearEarth(const SatElements &el, double tsince, double rOut[3], double vOut[3]) {
+    // Secular gravity terms, in double
+    T xmdf   = (T)fmod(el.rec.mo + el.rec.mdot * tsince, TWO_PI);
+    T argpdf = (T)fmod(el.rec.argpo + el.rec.argpdot * tsince, TWO_PI);
+    T nodedf = (T)fmod(el.rec.nodeo + el.rec.nodedot * tsince, TWO_PI);
+
+    T r[3], v[3];
+    bool ok = sgp4NearEarthCore<T>(coeffsFor<T>(el), xmdf, argpdf, nodedf, (T)tsince, r, v);
+    for (int i = 0; i < 3; i++) {
+        rOut[i] = r[i];
+        vOut[i] = v[i];
+    }
+    return ok;
+}
+
+template <typename T>
+SatState propagate(const SatElements &el, double unixTime) {
+    SatState s;
+    s.unixTime = unixTime;
+    double tsince = (unixTime - el.epochUnix) / 60.0;
+
+    if (el.nearEarth) {
+        s.valid = sgp4NearEarth<T>(el, tsince, s.r, s.v);
+    } else {
+        // sgp4() updates integrator bookkeeping in the record, so give it a copy
+        elsetrec rec = el.rec;
+        s.valid = sgp4(wgs72, rec, tsince, s.r, s.v);
+    }
+    return s;
+}
+
+template SatState propagate<float>(const SatElements &el, double unixTime);
+template SatState propagate<double>(const SatElements &el, double unixTime);
+
+Observer makeObserver(double latDeg, double lonDeg, double altM) {
+    Observer o;
+    double lat = latDeg * DEG_TO_RAD;
+    double lon = lonDeg * DEG_TO_RAD;
+    o.latDeg = latDeg;
+    o.lonDeg = lonDeg;
+    o.sinLat = sin(lat);
+    o.cosLat = cos(lat);
+    o.sinLon = sin(lon);
+    o.cosLon = cos(lon);
+
+    double n = EARTH_RADIUS_KM / sqrt(1.0 - EARTH_E2 * o.sinLat * o.sinLat);
+    double h = altM / 1000.0;
+    o.ecef[0] = (n + h) * o.cosLat * o.cosLon;
+    o.ecef[1] = (n + h) * o.cosLat * o.sinLon;
+    o.ecef[2] = (n * (1.0 - EARTH_E2) + h) * o.sinLat;
+    return o;
+}
+
+double observerDistanceKm(const Observer &obs, double latDeg, double lonDeg) {
+    double dLon = lonDeg - obs.lonDeg;
+    if (dLon > 180) dLon -= 360;
+    if (dLon < -180) dLon += 360;
+    double north = (latDeg - obs.latDeg) * DEG_TO_RAD * EARTH_RADIUS_KM;
+    double east = dLon * DEG_TO_RAD * EARTH_RADIUS_KM * obs.cosLat;
+    return sqrt(north * north + east * east);
+}
+
+// Greenwich mean sidereal time (IAU-82, same as the SGP4 library's gstime)
+static double gmstRad(double unixTime) {
+    double jd = unixTime / 86400.0 + 2440587.5;
+    double tut1 = (jd - 2451545.0) / 36525.0;
+    double secs = -6.2e-6 * tut1 * tut1 * tut1 + 0.093104 * tut1 * tut1 +
+                  (876600.0 * 3600.0 + 8640184.812866) * tut1 + 67310.54841;
+    double g = fmod(secs * DEG_TO_RAD / 240.0, TWO_PI);
+    return (g < 0) ? g + TWO_PI : g;
+}
+
+// TEME -> ECEF (polar motion ignored)
+static void temeToEcef(const SatState &s, double out[3]) {
+    double g = gmstRad(s.unixTime);
+    double cg = cos(g), sg = sin(g);
+    out[0] = cg * s.r[0] + sg * s.r[1];
+    out[1] = -sg * s.r[0] + cg * s.r[1];
+    out[2] = s.r[2];
+}
+
+LookAngles lookAngles(const SatState &s, const Observer &obs) {
+    LookAngles out = {0, -90, 0, 0};
+    if (!s.valid) return out;
+
+    double p[3];
+    temeToEcef(s, p);
+
+    // Range vector in the observer's south/east/up frame
+    double dx = p[0] - obs.ecef[0];
+    double dy = p[1] - obs.ecef[1];
+    double dz = p[2] - obs.ecef[2];
+    double south = obs.sinLat * obs.cosLon * dx + obs.sinLat * obs.sinLon * dy - obs.cosLat * dz;
+    double east  = -obs.sinLon * dx + obs.cosLon * dy;
+    double up    = obs.cosLat * obs.cosLon * dx + obs.cosLat * obs.sinLon * dy + obs.sinLat * dz;
+
+    out.rangeKm = sqrt(dx * dx + dy * dy + dz * dz);
+    out.el = asin(up / out.rangeKm) * RAD_TO_DEG;
+    out.az = atan2(east, -south) * RAD_TO_DEG;
+    if (out.az < 0) out.az += 360.0;
+    out.altKm = sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]) - EARTH_RADIUS_KM;
+    return out;
+}
+
+GeoPoint subSatellitePoint(const SatState &s) {
+    GeoPoint g = {0, 0, 0};
+    if (!s.valid) return g;
+
+    double p[3];
+    temeToEcef(s, p);
+
+    // Geodetic latitude by fixed-point iteration (converges in a few rounds)
+    double rxy = sqrt(p[0] * p[0] + p[1] * p[1]);
+    double lat = atan2(p[2], rxy);
+    double n = EARTH_RADIUS_KM;
+    for (int i = 0; i < 5; i++) {
+        double sl = sin(lat);
+        n = EARTH_RADIUS_KM / sqrt(1.0 - EARTH_E2 * sl * sl);
+        lat = atan2(p[2] + n * EARTH_E2 * sl, rxy);
+    }
+
+    g.latDeg = lat * RAD_TO_DEG;
+    g.lonDeg = atan2(p[1], p[0]) * RAD_TO_DEG;
+    double sl = sin(lat);
+    g.altKm = rxy * cos(lat) + (p[2] + n * EARTH_E2 * sl) * sl - n;
+    return g;
+}
+
+SiteAngles siteAngles(const SatState &s, const Observer &obs) {
+    SiteAngles a = {M_PI, M_PI / 2};
+    if (!s.valid) return a;
+
+    // Observer direction in TEME
+    double g = gmstRad(s.unixTime);
+    double cg = cos(g), sg = sin(g);
+    double on = sqrt(obs.ecef[0] * obs.ecef[0] + obs.ecef[1] * obs.ecef[1] + obs.ecef[2] * obs.ecef[2]);
+    double o[3] = {(cg * obs.ecef[0] - sg * obs.ecef[1]) / on,
+                   (sg * obs.ecef[0] + cg * obs.ecef[1]) / on,
+                   obs.ecef[2] / on};
+
+    double rn = sqrt(s.r[0] * s.r[0] + s.r[1] * s.r[1] + s.r[2] * s.r[2]);
+    double c = (o[0] * s.r[0] + o[1] * s.r[1] + o[2] * s.r[2]) / rn;
+    a.toSat = acos(constrain(c, -1.0, 1.0));
+
+    // Orbit normal h = r x v
+    double h[3] = {s.r[1] * s.v[2] - s.r[2] * s.v[1],
+                   s.r[2] * s.v[0] - s.r[0] * s.v[2],
+                   s.r[0] * s.v[1] - s.r[1] * s.v[0]};
+    double hn = sqrt(h[0] * h[0] + h[1] * h[1] + h[2] * h[2]);
+    double d = (o[0] * h[0] + o[1] * h[1] + o[2] * h[2]) / hn;
+    a.toPlane = asin(constrain(fabs(d), 0.0, 1.0));
+    return a;
+}
+
+TopoFrame topoFrame(const Observer &obs, double unixTime) {
+    double g = gmstRad(unixTime);
+    double cg = cos(g), sg = sin(g);
+    // ECEF -> TEME is a rotation about z by +GMST
+    double ecef[4][3] = {
+        {obs.ecef[0], obs.ecef[1], obs.ecef[2]},
+        {obs.sinLat * obs.cosLon, obs.sinLat * obs.sinLon, -obs.cosLat},
+        {-obs.sinLon, obs.cosLon, 0},
+        {obs.cosLat * obs.cosLon, obs.cosLat * obs.sinLon, obs.sinLat},
+    };
+    double teme[4][3];
+    for (int i = 0; i < 4; i++) {
+        teme[i][0] = cg * ecef[i][0] - sg * ecef[i][1];
+        teme[i][1] = sg * ecef[i][0] + cg * ecef[i][1];
+        teme[i][2] = ecef[i][2];
+    }
+
+    TopoFrame f;
+    for (int i = 0; i < 3; i++) {
+        f.site[i] = teme[0][i];
+        f.south[i] = teme[1][i];
+        f.east[i] = teme[2][i];
+        f.up[i] = teme[3][i];
+    }
+    return f;
+}
+
+double footprintAngle(double altKm, double minElDeg) {
+    double e = minElDeg * DEG_TO_RAD;
+    return acos(EARTH_RADIUS_KM * cos(e) / (EARTH_RADIUS_KM + altKm)) - e;
+}
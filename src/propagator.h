@@ -0,0 +1,100 @@
+#pragma once
+#include <Arduino.h>
+#include <Sgp4.h>
+
+// --- PROPAGATOR ---
+// Propagation is a pure function of (elements, time): each call works on its
+// own copy of the SGP4 record and returns a value, so any number of callers
+// (live view, pass search, ephemeris cache) can run without clobbering each
+// other or having to "put back" a shared state afterwards.
+
+// Per-call SGP4 coefficients (set up once by the library's sgp4init), kept
+// in the scalar type the near-Earth propagator runs in
+template <typename T>
+struct NearEarthCoeffs {
+    bool simple;  // Perigee below 220 km: truncated drag terms
+    T no, ecco, inclo, bstar;
+    T cc1, cc4, cc5, d2, d3, d4;
+    T t2cof, t3cof, t4cof, t5cof;
+    T eta, delmo, sinmao, omgcof, xmcof, nodecf;
+    T con41, x1mth2, x7thm1, xlcof, aycof;
+};
+
+struct SatElements {
+    elsetrec rec;
+    double epochUnix;
+    char name[25];
+    bool nearEarth;  // Period under 225 min; deep-space always uses the library
+    double periodMin;
+    double perigeeKm, apogeeKm;  // Heights above the equatorial radius
+    NearEarthCoeffs<float> coeffsF;
+    NearEarthCoeffs<double> coeffsD;
+};
+
+// TEME state vector at `unixTime`
+struct SatState {
+    bool valid;
+    double unixTime;
+    double r[3];  // km
+    double v[3];  // km/s
+};
+
+// Observer geometry, computed once per site
+struct Observer {
+    double latDeg, lonDeg;
+    double sinLat, cosLat, sinLon, cosLon;
+    double ecef[3];  // km
+};
+
+struct LookAngles {
+    double az;       // deg, clockwise from north
+    double el;       // deg above the horizon
+    double rangeKm;  // slant range
+    double altKm;    // satellite height above the mean equatorial radius
+};
+
+struct GeoPoint {
+    double latDeg, lonDeg, altKm;
+};
+
+// Earth-central angles (rad) from the observer to the satellite and to the
+// orbit plane. Used to rule out passes without computing elevations.
+struct SiteAngles {
+    double toSat;
+    double toPlane;
+};
+
+// The observer's position and south/east/up axes in TEME at one instant.
+// Lets many satellites at the same time skip the per-satellite TEME -> ECEF.
+struct TopoFrame {
+    double site[3];  // km
+    double south[3], east[3], up[3];
+};
+
+bool loadElements(SatElements &out, const char *name, const char *line1, const char *line2);
+
+// propagate<float> runs on the ESP32-S3's single-precision FPU; double is
+// software-emulated there but is what the library itself computes.
+// Instantiated for float and double.
+template <typename T = double>
+SatState propagate(const SatElements &el, double unixTime);
+
+// The near-Earth kernel itself, for callers that keep their own
+// coefficients (e.g. the batch catalog). `xmdf`, `argpdf` and `nodedf` are
+// the secular mean anomaly, argument of perigee and node (rad) at `t`
+// minutes since epoch. Returns false if the orbit has decayed.
+template <typename T>
+bool sgp4NearEarthCore(const NearEarthCoeffs<T> &c, T xmdf, T argpdf, T nodedf, T t, T r[3], T v[3]);
+
+Observer makeObserver(double latDeg, double lonDeg, double altM);
+// Ground distance (km) from the observer to another site. Flat-earth from
+// the cached cos(lat): within 1% out to ~100 km, which is all it's for.
+double observerDistanceKm(const Observer &obs, double latDeg, double lonDeg);
+LookAngles lookAngles(const SatState &s, const Observer &obs);
+GeoPoint subSatellitePoint(const SatState &s);
+SiteAngles siteAngles(const SatState &s, const Observer &obs);
+TopoFrame topoFrame(const Observer &obs, double unixTime);
+
+// Earth-central radius (rad) of the area that sees a satellite at `altKm`
+// at or above `minElDeg`
+double footprintAngle(double altKm, double minElDeg);
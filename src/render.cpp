@@ -0,0 +1,121 @@
+#include "render.h"
+#include <algorithm>
+#include <stdarg.h>
+#include "config.h"
+
+struct RenderField {
+    char text[RENDER_TEXT_MAX];
+    uint16_t color;
+    int16_t width;        // Drawn last time, so a shorter text clears it
+    bool valid;
+};
+
+struct RenderRect {
+    int16_t x, y, w, h;
+};
+
+static RenderField fields[RENDER_FIELDS];
+static RenderRect dirty[RENDER_DIRTY_MAX];
+static int dirtyCount = 0;
+static bool full = true;
+
+static uint32_t pixelsThisSecond = 0;
+static uint32_t pixelsLastSecond = 0;
+static unsigned long secondStart = 0;
+
+void renderInvalidate() {
+    full = true;
+    for (RenderField &f : fields) f.valid = false;
+}
+
+bool renderFull() {
+    return full;
+}
+
+static bool overlaps(const RenderRect &a, const RenderRect &b) {
+    return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+}
+
+static void merge(RenderRect &a, const RenderRect &b) {
+    int right = std::max(a.x + a.w, b.x + b.w), bottom = std::max(a.y + a.h, b.y + b.h);
+    a.x = std::min(a.x, b.x);
+    a.y = std::min(a.y, b.y);
+    a.w = right - a.x;
+    a.h = bottom - a.y;
+}
+
+void renderDirty(int x, int y, int w, int h) {
+    if (full || w <= 0 || h <= 0) return;
+    RenderRect r = {(int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h};
+
+    // Touching rectangles become one; so does everything once the list is full
+    for (int i = 0; i < dirtyCount; i++) {
+        if (overlaps(dirty[i], r)) {
+            merge(dirty[i], r);
+            return;
+        }
+    }
+    if (dirtyCount == RENDER_DIRTY_MAX) {
+        for (int i = 1; i < dirtyCount; i++) merge(dirty[0], dirty[i]);
+        merge(dirty[0], r);
+        dirtyCount = 1;
+        return;
+    }
+    dirty[dirtyCount++] = r;
+}
+
+void renderText(M5Canvas &d, int id, int x, int y, int w, uint16_t color, const char *fmt, ...) {
+    char text[RENDER_TEXT_MAX];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(text, sizeof(text), fmt, ap);
+    va_end(ap);
+
+    RenderField &f = fields[id];
+    if (f.valid && f.color == color && strcmp(f.text, text) == 0) return;
+
+    int tw = std::min((int)d.textWidth(text), w);
+    int cw = f.valid ? std::max(tw, (int)f.width) : w;
+    int h = d.fontHeight();
+    d.fillRect(x, y, cw, h, COL_BG);
+    d.setTextColor(color);
+    d.setCursor(x, y);
+    d.print(text);
+    renderDirty(x, y, cw, h);
+
+    memcpy(f.text, text, sizeof(text));
+    f.color = color;
+    f.width = tw;
+    f.valid = true;
+}
+
+void renderPush(M5Canvas &d, LGFX_Device &panel) {
+    uint32_t pixels = 0;
+    if (full) {
+        d.pushSprite(0, 0);
+        pixels = (uint32_t)d.width() * d.height();
+    } else {
+        // The panel clips the sprite, so only these rectangles go over SPI
+        for (int i = 0; i < dirtyCount; i++) {
+            const RenderRect &r = dirty[i];
+            panel.setClipRect(r.x, r.y, r.w, r.h);
+            d.pushSprite(0, 0);
+            pixels += (uint32_t)r.w * r.h;
+        }
+        panel.clearClipRect();
+    }
+    full = false;
+    dirtyCount = 0;
+
+    unsigned long now = millis();
+    if (now - secondStart >= 1000) {
+        pixelsLastSecond = pixelsThisSecond;
+        pixelsThisSecond = 0;
+        secondStart = now;
+    }
+    pixelsThisSecond += pixels;
+}
+
+uint32_t renderPixelsPerSec() {
+    return millis() - secondStart < 2000 ? pixelsLastSecond : 0;  // Nothing pushed lately
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <M5GFX.h>
+
+// --- RENDER ---
+// Retained-mode layer over the canvas. A full frame (screen change, menu
+// key) paints everything and pushes the whole sprite as before. Between
+// full frames, screens that update live only repaint what changed: text
+// fields remember what they last showed and repaint themselves when it
+// differs, markers mark the box they moved through. Only those dirty
+// rectangles are sent to the panel.
+
+#define RENDER_FIELDS     16   // Text field ids per screen
+#define RENDER_DIRTY_MAX  8    // More rectangles than this merge into one
+#define RENDER_TEXT_MAX   40
+
+// The next frame is a full one: all fields repaint, the whole sprite goes
+void renderInvalidate();
+
+// True while drawing a full frame: paint the static parts then
+bool renderFull();
+
+void renderDirty(int x, int y, int w, int h);
+
+// A line of text at (x, y), `w` wide. Clears its box and redraws only if
+// the text or colour differ from last time (or on a full frame).
+void renderText(M5Canvas &d, int id, int x, int y, int w, uint16_t color, const char *fmt, ...);
+
+// Sends the dirty rectangles (or everything, on a full frame) to the panel
+// and starts the next frame
+void renderPush(M5Canvas &d, LGFX_Device &panel);
+
+// Pixels sent to the panel over the last whole second
+uint32_t renderPixelsPerSec();
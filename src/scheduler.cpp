@@ -0,0 +1,122 @@
+#include "scheduler.h"
+
+#ifdef NATIVE_BUILD
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#else
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+struct SchedTimer {
+    bool armed;
+    unsigned long due;
+    unsigned long period;     // 0 = one shot
+};
+
+static SchedTimer timers[SCHED_TIMERS];
+static unsigned long (*clockFn)() = nullptr;
+
+static unsigned long now() {
+    return clockFn ? clockFn() : millis();
+}
+
+// Wraparound-safe "a is at or after b"
+static bool reached(unsigned long a, unsigned long b) {
+    return (long)(a - b) >= 0;
+}
+
+// --- PLATFORM GLUE ---
+#ifdef NATIVE_BUILD
+static std::mutex wakeLock;
+static std::condition_variable wakeSignal;
+static bool woken = false;
+
+static void waitFor(unsigned long ms) {
+    std::unique_lock<std::mutex> lock(wakeLock);
+    wakeSignal.wait_for(lock, std::chrono::milliseconds(ms), [] { return woken; });
+    woken = false;
+}
+
+void schedWake() {
+    std::lock_guard<std::mutex> lock(wakeLock);
+    woken = true;
+    wakeSignal.notify_one();
+}
+#else
+static TaskHandle_t waiter = nullptr;
+
+// A task notification is the lightest wake FreeRTOS has; the idle task
+// runs (and the core can clock down) until it arrives
+static void waitFor(unsigned long ms) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+}
+
+void schedWake() {
+    if (waiter) xTaskNotifyGive(waiter);
+}
+#endif
+
+// --- TIMERS ---
+void schedBegin(unsigned long (*clock)()) {
+    clockFn = clock;
+    memset(timers, 0, sizeof(timers));
+#ifndef NATIVE_BUILD
+    waiter = xTaskGetCurrentTaskHandle();
+#endif
+}
+
+void schedIn(int id, unsigned long delayMs) {
+    timers[id].armed = true;
+    timers[id].due = now() + delayMs;
+    timers[id].period = 0;
+}
+
+void schedEvery(int id, unsigned long periodMs) {
+    timers[id].armed = true;
+    timers[id].due = now() + periodMs;
+    timers[id].period = periodMs;
+}
+
+void schedCancel(int id) {
+    timers[id].armed = false;
+}
+
+bool schedPending(int id) {
+    return timers[id].armed;
+}
+
+int schedNextFired() {
+    unsigned long t = now();
+    for (int i = 0; i < SCHED_TIMERS; i++) {
+        SchedTimer &tm = timers[i];
+        if (!tm.armed || !reached(t, tm.due)) continue;
+        if (tm.period == 0) {
+            tm.armed = false;
+        } else {
+            tm.due += tm.period;
+            if (reached(t, tm.due)) tm.due = t + tm.period;  // Fell behind
+        }
+        return i;
+    }
+    return -1;
+}
+
+unsigned long schedUntilNext() {
+    unsigned long t = now();
+    unsigned long best = SCHED_NEVER;
+    for (int i = 0; i < SCHED_TIMERS; i++) {
+        if (!timers[i].armed) continue;
+        if (reached(t, timers[i].due)) return 0;
+        unsigned long left = timers[i].due - t;
+        if (left < best) best = left;
+    }
+    return best;
+}
+
+void schedWait(unsigned long maxMs) {
+    unsigned long ms = schedUntilNext();
+    if (ms == 0) return;
+    waitFor(ms < maxMs ? ms : maxMs);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <Arduino.h>
+
+// --- SCHEDULER ---
+// loop() sleeps until something needs it instead of spinning on delay():
+// the earliest registered deadline comes due, or another task (the orbit
+// worker publishing, GPS bytes arriving) calls schedWake(). Deadlines are a
+// fixed table indexed by the caller's timer ids; for a handful of timers a
+// scan is cheaper than keeping a wheel or heap in order.
+
+#define SCHED_TIMERS       12
+#define SCHED_NEVER        0xFFFFFFFFUL
+#define SCHED_MAX_SLEEP_MS 1000    // Longest single wait
+
+// `clock` returns milliseconds (nullptr = millis(); the bench passes a
+// simulated one). Call from the task that will call schedWait().
+void schedBegin(unsigned long (*clock)() = nullptr);
+
+// One shot `delayMs` from now; replaces whatever `id` had pending
+void schedIn(int id, unsigned long delayMs);
+// Every `periodMs`, the first one period from now. A timer that falls
+// behind skips the periods it missed rather than firing for each.
+void schedEvery(int id, unsigned long periodMs);
+void schedCancel(int id);
+bool schedPending(int id);
+
+// A timer that has come due (re-arming it if it repeats), or -1. Call
+// until -1 after each wait.
+int schedNextFired();
+
+// Milliseconds until the earliest deadline (0 if one is due already), or
+// SCHED_NEVER
+unsigned long schedUntilNext();
+
+// Sleeps until the next deadline or a schedWake(), at most `maxMs`
+void schedWait(unsigned long maxMs = SCHED_MAX_SLEEP_MS);
+
+// From any task (not an ISR). A wake before the wait makes it return at once.
+void schedWake();
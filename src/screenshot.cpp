@@ -0,0 +1,195 @@
+#include "screenshot.h"
+#include "storage.h"
+
+#define BMP_HEADER    54     // File header + BITMAPINFOHEADER
+#define BI_RLE8       1
+#define BI_BITFIELDS  3
+#define PALETTE_MAX   256
+#define PALETTE_SLOTS 512    // Open addressing, at most half full
+#define NO_SLOT       0xFFFF
+
+// --- BLOCK OUTPUT ---
+static uint8_t block[SCREENSHOT_BLOCK];
+static size_t blockLen = 0;
+static uint32_t written = 0;
+static bool writeOk = true;
+
+static void flush(StorageFile &f) {
+    if (blockLen && storageWrite(f, block, blockLen) != blockLen) writeOk = false;
+    written += blockLen;
+    blockLen = 0;
+}
+
+static void put(StorageFile &f, const void *data, size_t n) {
+    const uint8_t *p = (const uint8_t *)data;
+    while (n) {
+        size_t room = SCREENSHOT_BLOCK - blockLen;
+        size_t take = n < room ? n : room;
+        memcpy(block + blockLen, p, take);
+        blockLen += take;
+        p += take;
+        n -= take;
+        if (blockLen == SCREENSHOT_BLOCK) flush(f);
+    }
+}
+
+static void put8(StorageFile &f, uint8_t a, uint8_t b) {
+    uint8_t two[2] = {a, b};
+    put(f, two, 2);
+}
+
+static void le32(uint8_t *p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static void header(uint8_t *out, int w, int h, int bits, int compression, uint32_t dataOffset, int colors) {
+    memset(out, 0, BMP_HEADER);
+    out[0] = 'B';
+    out[1] = 'M';
+    le32(out + 10, dataOffset);
+    le32(out + 14, 40);
+    le32(out + 18, w);
+    le32(out + 22, h);     // Positive: bottom row first (RLE requires it)
+    out[26] = 1;
+    out[28] = bits;
+    le32(out + 30, compression);
+    le32(out + 46, colors);
+}
+
+// --- PALETTE ---
+static uint16_t slotColor[PALETTE_SLOTS];
+static uint16_t slotIndex[PALETTE_SLOTS];
+static uint16_t palette[PALETTE_MAX];
+
+static inline uint16_t pixelAt(const uint16_t *pixels, int i, bool swapped) {
+    uint16_t c = pixels[i];
+    return swapped ? (uint16_t)(c << 8 | c >> 8) : c;
+}
+
+static inline int slotFor(uint16_t c) {
+    int s = (c * 40503u >> 7) & (PALETTE_SLOTS - 1);
+    while (slotIndex[s] != NO_SLOT && slotColor[s] != c) s = (s + 1) & (PALETTE_SLOTS - 1);
+    return s;
+}
+
+// Distinct colours into `palette`; 0 if there are more than it holds
+static int buildPalette(const uint16_t *pixels, int count, bool swapped) {
+    memset(slotIndex, 0xFF, sizeof(slotIndex));
+    int colors = 0;
+    uint16_t last = 0;
+    for (int i = 0; i < count; i++) {
+        uint16_t c = pixelAt(pixels, i, swapped);
+        if (colors && c == last) continue;  // Runs are the common case
+        last = c;
+        int s = slotFor(c);
+        if (slotIndex[s] != NO_SLOT) continue;
+        if (colors == PALETTE_MAX) return 0;
+        slotColor[s] = c;
+        slotIndex[s] = colors;
+        palette[colors++] = c;
+    }
+    return colors;
+}
+
+// --- RLE8 ---
+// Encoded runs for anything repeated, absolute mode for stretches of
+// three or more different pixels, an end-of-line marker per row
+static void encodeRow(StorageFile &f, const uint8_t *row, int w) {
+    int i = 0;
+    while (i < w) {
+        int run = 1;
+        while (i + run < w && run < 255 && row[i + run] == row[i]) run++;
+        if (run >= 2) {
+            put8(f, run, row[i]);
+            i += run;
+            continue;
+        }
+        int j = i;
+        while (j < w && j - i < 255 && !(j + 2 < w && row[j] == row[j + 1] && row[j] == row[j + 2])) j++;
+        int n = j - i;
+        if (n < 3) {
+            for (int k = i; k < j; k++) put8(f, 1, row[k]);
+        } else {
+            put8(f, 0, n);
+            put(f, row + i, n);
+            if (n & 1) put(f, "", 1);  // Absolute runs end on a word boundary
+        }
+        i = j;
+    }
+    put8(f, 0, 0);
+}
+
+static void writeRle(StorageFile &f, const uint16_t *pixels, int w, int h, bool swapped, int colors) {
+    uint8_t head[BMP_HEADER];
+    header(head, w, h, 8, BI_RLE8, BMP_HEADER + colors * 4, colors);
+    put(f, head, BMP_HEADER);
+    for (int i = 0; i < colors; i++) {
+        uint16_t c = palette[i];
+        uint8_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+        uint8_t bgra[4] = {(uint8_t)(b << 3 | b >> 2), (uint8_t)(g << 2 | g >> 4), (uint8_t)(r << 3 | r >> 2), 0};
+        put(f, bgra, 4);
+    }
+    static uint8_t row[SCREENSHOT_MAX_W];
+    for (int y = h - 1; y >= 0; y--) {
+        const uint16_t *src = pixels + y * w;
+        for (int x = 0; x < w; x++) row[x] = slotIndex[slotFor(pixelAt(src, x, swapped))];
+        encodeRow(f, row, w);
+    }
+    put8(f, 0, 1);  // End of bitmap
+}
+
+// --- RGB565 ---
+static void writeBitfields(StorageFile &f, const uint16_t *pixels, int w, int h, bool swapped) {
+    uint8_t head[BMP_HEADER + 12];
+    header(head, w, h, 16, BI_BITFIELDS, BMP_HEADER + 12, 0);
+    le32(head + BMP_HEADER, 0xF800);
+    le32(head + BMP_HEADER + 4, 0x07E0);
+    le32(head + BMP_HEADER + 8, 0x001F);
+    put(f, head, sizeof(head));
+    static uint8_t row[SCREENSHOT_MAX_W * 2 + 2];
+    int rowBytes = (w * 2 + 3) & ~3;
+    memset(row, 0, sizeof(row));
+    for (int y = h - 1; y >= 0; y--) {
+        const uint16_t *src = pixels + y * w;
+        for (int x = 0; x < w; x++) {
+            uint16_t c = pixelAt(src, x, swapped);
+            row[x * 2] = c;
+            row[x * 2 + 1] = c >> 8;
+        }
+        put(f, row, rowBytes);
+    }
+}
+
+// --- PUBLIC API ---
+bool screenshotWriteBmp(const char *path, const uint16_t *pixels, int w, int h, bool swapped,
+                        ScreenshotInfo &info) {
+    info.bytes = 0;
+    info.colors = 0;
+    if (!pixels || w > SCREENSHOT_MAX_W) return false;
+    StorageFile f = storageOpen(path, STORAGE_WRITE);
+    if (!storageOk(f)) return false;
+    blockLen = 0;
+    written = 0;
+    writeOk = true;
+
+    info.colors = buildPalette(pixels, w * h, swapped);
+    if (info.colors) writeRle(f, pixels, w, h, swapped, info.colors);
+    else writeBitfields(f, pixels, w, h, swapped);
+    flush(f);
+
+    // Sizes go in once they're known
+    uint32_t dataOffset = info.colors ? BMP_HEADER + info.colors * 4 : BMP_HEADER + 12;
+    uint8_t size[4];
+    le32(size, written);
+    storageSeek(f, 2);
+    storageWrite(f, size, 4);
+    le32(size, written - dataOffset);
+    storageSeek(f, 34);
+    storageWrite(f, size, 4);
+    storageClose(f);
+    info.bytes = written;
+    return writeOk;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+
+// --- SCREENSHOTS ---
+// Writes a 16-bit frame to a BMP straight from sprite memory, with no
+// readback from the panel. The screens use a handful of flat colours, so
+// the frame goes out as 8-bit RLE (BI_RLE8) with a palette of its own
+// colours. A frame with more than 256 colours is written as uncompressed
+// RGB565 (BI_BITFIELDS) instead. Everything goes through one
+// SCREENSHOT_BLOCK buffer, so the card sees a few large writes.
+
+#define SCREENSHOT_BLOCK 4096
+#define SCREENSHOT_MAX_W 320
+
+struct ScreenshotInfo {
+    uint32_t bytes;     // File size
+    int colors;         // Palette size; 0 when written as RGB565
+};
+
+// `pixels`: w * h RGB565, top row first. `swapped`: bytes swapped, as
+// LovyanGFX sprites keep them.
+bool screenshotWriteBmp(const char *path, const uint16_t *pixels, int w, int h, bool swapped,
+                        ScreenshotInfo &info);
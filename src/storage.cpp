@@ -0,0 +1,99 @@
+#include "storage.h"
+
+#ifdef NATIVE_BUILD
+#include <sys/stat.h>
+
+StorageFile storageOpen(const char *path, StorageMode mode) {
+    static const char *const MODES[] = {"rb", "wb", "r+b"};
+    return fopen(path, MODES[mode]);
+}
+
+bool storageOk(StorageFile &f) { return f != nullptr; }
+size_t storageRead(StorageFile &f, void *buf, size_t n) { return fread(buf, 1, n, f); }
+size_t storageWrite(StorageFile &f, const void *buf, size_t n) { return fwrite(buf, 1, n, f); }
+bool storageSeek(StorageFile &f, uint32_t pos) { return fseek(f, pos, SEEK_SET) == 0; }
+
+void storageClose(StorageFile &f) {
+    if (f) fclose(f);
+    f = nullptr;
+}
+
+bool storageStat(const char *path, uint32_t &size, uint32_t &mtime) {
+    struct stat st;
+    if (stat(path, &st) != 0) return false;
+    size = st.st_size;
+    mtime = st.st_mtime;
+    return true;
+}
+
+bool storageReplace(const char *from, const char *to) {
+    return rename(from, to) == 0;
+}
+
+void storageRemove(const char *path) {
+    remove(path);
+}
+
+void storageMakeDir(const char *path) {
+    mkdir(path, 0755);
+}
+#else
+static void backupPath(const char *path, char *out, size_t size) {
+    snprintf(out, size, "%s.bak", path);
+}
+
+// A replace cut short leaves only the backup
+static bool restoreBackup(const char *path) {
+    char bak[96];
+    backupPath(path, bak, sizeof(bak));
+    return SD.exists(bak) && SD.rename(bak, path);
+}
+
+StorageFile storageOpen(const char *path, StorageMode mode) {
+    static const char *const MODES[] = {FILE_READ, FILE_WRITE, "r+"};
+    File f = SD.open(path, MODES[mode]);
+    if (!f && mode != STORAGE_WRITE && restoreBackup(path)) f = SD.open(path, MODES[mode]);
+    return f;
+}
+
+bool storageOk(StorageFile &f) { return (bool)f; }
+size_t storageRead(StorageFile &f, void *buf, size_t n) { return f.read((uint8_t *)buf, n); }
+size_t storageWrite(StorageFile &f, const void *buf, size_t n) { return f.write((const uint8_t *)buf, n); }
+bool storageSeek(StorageFile &f, uint32_t pos) { return f.seek(pos); }
+void storageClose(StorageFile &f) { f.close(); }
+
+bool storageStat(const char *path, uint32_t &size, uint32_t &mtime) {
+    File f = SD.open(path);
+    if (!f) return false;
+    size = f.size();
+    mtime = f.getLastWrite();
+    f.close();
+    return true;
+}
+
+// FAT won't rename over an existing file; see storage.h
+bool storageReplace(const char *from, const char *to) {
+    char bak[96];
+    backupPath(to, bak, sizeof(bak));
+    bool had = SD.exists(to);
+    if (had) {
+        if (SD.exists(bak)) SD.remove(bak);
+        if (!SD.rename(to, bak)) return false;
+    }
+    if (!SD.rename(from, to)) {
+        if (had) SD.rename(bak, to);
+        return false;
+    }
+    // Also clears a backup left by an earlier replace that was cut short
+    if (SD.exists(bak)) SD.remove(bak);
+    return true;
+}
+
+void storageRemove(const char *path) {
+    if (SD.exists(path)) SD.remove(path);
+}
+
+void storageMakeDir(const char *path) {
+    if (!SD.exists(path)) SD.mkdir(path);
+}
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+#include <Arduino.h>
+
+#ifdef NATIVE_BUILD
+#include <stdio.h>
+#else
+#include <SD.h>
+#endif
+
+// --- STORAGE ---
+// The handful of file operations the SD caches need: SD on the device,
+// stdio on the host build, so the same cache code runs in the benchmarks.
+
+#ifdef NATIVE_BUILD
+typedef FILE *StorageFile;
+#else
+typedef File StorageFile;
+#endif
+
+enum StorageMode : uint8_t {
+    STORAGE_READ,
+    STORAGE_WRITE,    // Create or truncate
+    STORAGE_UPDATE    // Read and write in place; the file must exist
+};
+
+StorageFile storageOpen(const char *path, StorageMode mode);
+bool storageOk(StorageFile &f);
+size_t storageRead(StorageFile &f, void *buf, size_t n);
+size_t storageWrite(StorageFile &f, const void *buf, size_t n);
+bool storageSeek(StorageFile &f, uint32_t pos);
+void storageClose(StorageFile &f);
+
+bool storageStat(const char *path, uint32_t &size, uint32_t &mtime);
+// Renames `from` over `to`, replacing it. Atomic on the host. FAT can't
+// rename over a file, so on the device the old `to` first steps aside as
+// `<to>.bak` and is removed only once `from` has taken its place. If power
+// is lost in between, `to` is missing but `<to>.bak` holds the previous
+// version: opening `to` for reading puts it back.
+bool storageReplace(const char *from, const char *to);
+void storageRemove(const char *path);
+void storageMakeDir(const char *path);   // No-op if it exists
@@ -0,0 +1,71 @@
+#include "timesync.h"
+#include "civil.h"
+#include "config.h"
+#include <math.h>
+#include <sys/time.h>
+
+// --- SYSTEM CLOCK ---
+#ifndef NATIVE_BUILD
+static double systemNow() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void systemStep(double unixtime) {
+    struct timeval tv;
+    tv.tv_sec = (time_t)floor(unixtime);
+    tv.tv_usec = (suseconds_t)((unixtime - floor(unixtime)) * 1e6);
+    settimeofday(&tv, nullptr);
+}
+
+// The IDF runs the clock a little fast or slow until the delta is used up
+static void systemSlew(double seconds) {
+    struct timeval delta;
+    delta.tv_sec = (time_t)floor(seconds);
+    delta.tv_usec = (suseconds_t)((seconds - floor(seconds)) * 1e6);
+    adjtime(&delta, nullptr);
+}
+
+static const TimeSyncDriver SYSTEM_CLOCK = {systemNow, systemStep, systemSlew};
+#endif
+
+// --- DISCIPLINE ---
+static const TimeSyncDriver *driver = nullptr;
+static unsigned long (*clockFn)() = nullptr;
+static double lastOffset = 0;
+
+void timeSyncBegin(const TimeSyncDriver *drv, unsigned long (*clock)()) {
+#ifndef NATIVE_BUILD
+    if (!drv) drv = &SYSTEM_CLOCK;
+#endif
+    driver = drv;
+    clockFn = clock;
+    lastOffset = 0;
+}
+
+double gpsUnixNow(const NmeaFix &fix) {
+    unsigned long ageMs = (clockFn ? clockFn() : millis()) - fix.timeAtMs;
+    if (!fix.timeValid || ageMs > TIMESYNC_MAX_AGE_MS) return 0;
+    int64_t secs = unixFromCivil(fix.year, fix.month, fix.day, fix.hour, fix.minute, fix.second);
+    return secs + (fix.millis + GPS_TIME_LAG_MS + ageMs) / 1000.0;
+}
+
+TimeSyncResult timeSyncFromGps(const NmeaFix &fix) {
+    if (!driver) return TIMESYNC_STALE;
+    double gps = gpsUnixNow(fix);
+    if (gps == 0) return TIMESYNC_STALE;
+
+    double now = driver->now();
+    lastOffset = gps - now;
+    if (now < TIMESYNC_VALID_UNIX || fabs(lastOffset) * 1000 > TIMESYNC_SLEW_MAX_MS) {
+        driver->step(gps);
+        return TIMESYNC_STEPPED;
+    }
+    driver->slew(lastOffset);
+    return TIMESYNC_SLEWED;
+}
+
+double timeSyncLastOffset() {
+    return lastOffset;
+}
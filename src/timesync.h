@@ -0,0 +1,39 @@
+#pragma once
+#include <Arduino.h>
+#include "nmea.h"
+
+// --- GPS CLOCK DISCIPLINE ---
+// Sets the system clock from GPS time to the millisecond: the fractional
+// second from the sentence and the time since it arrived are both added
+// on. A small error is slewed out (adjtime) instead of stepped, so the
+// orbit worker's sub-second clock never jumps, least of all backwards. A
+// large one, or a clock that was never set, is stepped.
+//
+// The clock sits behind a TimeSyncDriver: the system clock on the device,
+// a simulated one in the host bench.
+
+#define TIMESYNC_MAX_AGE_MS  1000   // Older GPS time isn't used
+#define TIMESYNC_SLEW_MAX_MS 500    // Bigger errors are stepped
+#define TIMESYNC_VALID_UNIX  1577836800.0  // 2020: anything earlier was never set
+
+struct TimeSyncDriver {
+    double (*now)();                // Unix seconds
+    void (*step)(double unixtime);
+    void (*slew)(double seconds);   // Gradual; positive runs it ahead
+};
+
+enum TimeSyncResult : uint8_t {
+    TIMESYNC_STALE,     // No usable GPS time; clock untouched
+    TIMESYNC_STEPPED,
+    TIMESYNC_SLEWED
+};
+
+// nullptr = the system clock (the host build has none) / millis()
+void timeSyncBegin(const TimeSyncDriver *driver = nullptr, unsigned long (*clock)() = nullptr);
+
+// GPS time as of now, Unix seconds; 0 if `fix` has none fresh enough
+double gpsUnixNow(const NmeaFix &fix);
+
+TimeSyncResult timeSyncFromGps(const NmeaFix &fix);
+// How far the clock was behind GPS at the last sync, seconds
+double timeSyncLastOffset();
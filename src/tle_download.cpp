@@ -0,0 +1,65 @@
+#include "tle_download.h"
+
+static bool keepRecord(const TleRecord &rec, void *ctx) {
+    TleDownload *d = (TleDownload *)ctx;
+    if (!d->haveFound && (d->catalogNumber == 0 || rec.catalogNumber == d->catalogNumber)) {
+        d->found = rec;
+        d->haveFound = true;
+    }
+    return true;  // Read on: the whole body still goes to the file
+}
+
+bool tleDownloadBegin(TleDownload &d, const char *path, long catalogNumber) {
+    d.path = path;
+    snprintf(d.tmpPath, sizeof(d.tmpPath), "%s.tmp", path);
+    d.fill = 0;
+    d.bytes = 0;
+    d.failed = false;
+    tleReaderInit(d.reader);
+    d.catalogNumber = catalogNumber;
+    d.haveFound = false;
+    d.out = storageOpen(d.tmpPath, STORAGE_WRITE);
+    return storageOk(d.out);
+}
+
+static bool flushBlock(TleDownload &d) {
+    if (d.fill > 0 && storageWrite(d.out, d.block, d.fill) != d.fill) d.failed = true;
+    d.fill = 0;
+    return !d.failed;
+}
+
+bool tleDownloadSink(const char *data, size_t len, void *ctx) {
+    TleDownload &d = *(TleDownload *)ctx;
+    if (d.failed) return false;
+    tleReaderFeed(d.reader, data, len, keepRecord, &d);
+    d.bytes += len;
+
+    // Network chunks come in any size; the card gets whole blocks
+    while (len > 0) {
+        size_t n = TLE_DOWNLOAD_BLOCK - d.fill;
+        if (n > len) n = len;
+        memcpy(d.block + d.fill, data, n);
+        d.fill += n;
+        data += n;
+        len -= n;
+        if (d.fill == TLE_DOWNLOAD_BLOCK && !flushBlock(d)) return false;
+    }
+    return true;
+}
+
+bool tleDownloadFinish(TleDownload &d, TleRecord &out) {
+    tleReaderFinish(d.reader, keepRecord, &d);
+    flushBlock(d);
+    storageClose(d.out);
+    if (d.failed || !d.haveFound || !storageReplace(d.tmpPath, d.path)) {
+        storageRemove(d.tmpPath);
+        return false;
+    }
+    out = d.found;
+    return true;
+}
+
+void tleDownloadAbort(TleDownload &d) {
+    storageClose(d.out);
+    storageRemove(d.tmpPath);
+}
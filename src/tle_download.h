@@ -0,0 +1,40 @@
+#pragma once
+#include <Arduino.h>
+#include "storage.h"
+#include "tle_reader.h"
+
+// --- TLE DOWNLOAD ---
+// Takes an HTTP body as it arrives (a NetSinkFn) and writes it to a
+// temporary file in fixed-size blocks, running it through the TLE reader on
+// the way. The file only replaces `path` if it held the wanted satellite,
+// so an error page or a cut-off transfer never overwrites a good one. RAM
+// use is one block plus the reader, whatever the size of the download.
+
+#define TLE_DOWNLOAD_BLOCK 512    // One SD sector per write
+
+struct TleDownload {
+    const char *path;
+    char tmpPath[64];
+    StorageFile out;
+    char block[TLE_DOWNLOAD_BLOCK];
+    size_t fill;
+    size_t bytes;
+    bool failed;                  // SD write error; the download is aborted
+
+    TleReader reader;
+    long catalogNumber;           // The record to hand back; 0 = the first
+    TleRecord found;
+    bool haveFound;
+};
+
+bool tleDownloadBegin(TleDownload &d, const char *path, long catalogNumber);
+
+// NetSinkFn; `ctx` is the TleDownload. Returns false on a write error.
+bool tleDownloadSink(const char *data, size_t len, void *ctx);
+
+// Completes the file and renames it over `path`. Returns true, with the
+// wanted record in `out`, if it was replaced.
+bool tleDownloadFinish(TleDownload &d, TleRecord &out);
+
+// Drops the temporary file
+void tleDownloadAbort(TleDownload &d);
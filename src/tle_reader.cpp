@@ -0,0 +1,183 @@
+#include "tle_reader.h"
+#include "civil.h"
+
+// --- FIELD PARSING ---
+// Fixed TLE columns, copied to a small stack buffer so the number ends where
+// the column does
+static double fieldDouble(const char *line, int start, int len) {
+    char buf[16];
+    memcpy(buf, line + start, len);
+    buf[len] = 0;
+    return strtod(buf, nullptr);
+}
+
+static long fieldLong(const char *line, int start, int len) {
+    char buf[16];
+    memcpy(buf, line + start, len);
+    buf[len] = 0;
+    return strtol(buf, nullptr, 10);
+}
+
+// " 12345-3" -> 0.12345e-3 (leading sign, implied decimal point, exponent)
+static double fieldExp(const char *line, int start) {
+    char buf[16];
+    int n = 0;
+    buf[n++] = (line[start] == '-') ? '-' : '+';
+    buf[n++] = '.';
+    for (int i = 1; i <= 5; i++) buf[n++] = (line[start + i] == ' ') ? '0' : line[start + i];
+    buf[n++] = 'e';
+    buf[n++] = line[start + 6];
+    buf[n++] = line[start + 7];
+    buf[n] = 0;
+    return strtod(buf, nullptr);
+}
+
+static double epochToUnix(int year, double dayOfYear) {
+    return (daysFromCivil(year, 1, 1) + dayOfYear - 1.0) * 86400.0;
+}
+
+bool tleChecksumOK(const char *line) {
+    int sum = 0;
+    for (int i = 0; i < TLE_LINE_LEN - 1; i++) {
+        char c = line[i];
+        if (c >= '0' && c <= '9') sum += c - '0';
+        else if (c == '-') sum += 1;
+    }
+    char check = line[TLE_LINE_LEN - 1];
+    return check >= '0' && check <= '9' && (sum % 10) == check - '0';
+}
+
+static void parseLine1(TleRecord &rec) {
+    const char *l = rec.line1;
+    rec.catalogNumber = fieldLong(l, 2, 5);
+    int yy = (int)fieldLong(l, 18, 2);
+    rec.epochYear = (yy < 57) ? 2000 + yy : 1900 + yy;
+    rec.epochDay = fieldDouble(l, 20, 12);
+    rec.epochUnix = epochToUnix(rec.epochYear, rec.epochDay);
+    rec.ndot = fieldDouble(l, 33, 10);
+    rec.nddot = fieldExp(l, 44);
+    rec.bstar = fieldExp(l, 53);
+}
+
+static void parseLine2(TleRecord &rec) {
+    const char *l = rec.line2;
+    rec.incDeg = fieldDouble(l, 8, 8);
+    rec.raanDeg = fieldDouble(l, 17, 8);
+    rec.ecc = fieldLong(l, 26, 7) / 10000000.0;  // Implied leading decimal point
+    rec.argPerDeg = fieldDouble(l, 34, 8);
+    rec.meanAnomDeg = fieldDouble(l, 43, 8);
+    rec.meanMotion = fieldDouble(l, 52, 11);
+    rec.revNumber = fieldLong(l, 63, 5);
+}
+
+// --- LINE ASSEMBLY ---
+void tleReaderInit(TleReader &r) {
+    memset(&r, 0, sizeof(r));
+}
+
+static bool isElementLine(const char *line, char number) {
+    return line[0] == number && line[1] == ' ';
+}
+
+// Returns false if the callback asked to stop
+static bool handleLine(TleReader &r, TleRecordFn fn, void *ctx) {
+    // Trim trailing blanks / CR
+    int n = r.lineLen;
+    while (n > 0 && (r.line[n - 1] == ' ' || r.line[n - 1] == '\r' || r.line[n - 1] == '\t')) n--;
+    r.line[n] = 0;
+    bool overflow = r.lineOverflow;
+    r.lineLen = 0;
+    r.lineOverflow = false;
+    if (n == 0) return true;
+
+    if (isElementLine(r.line, '1')) {
+        r.haveLine1 = false;
+        if (overflow || n != TLE_LINE_LEN) { r.badLines++; return true; }
+        if (!tleChecksumOK(r.line)) { r.badChecksums++; return true; }
+        memcpy(r.rec.line1, r.line, TLE_LINE_LEN + 1);
+        r.haveLine1 = true;
+        if (!r.haveName) r.recordStart = r.lineStart;
+        return true;
+    }
+
+    if (isElementLine(r.line, '2')) {
+        bool pending = r.haveLine1;
+        r.haveLine1 = false;
+        if (overflow || n != TLE_LINE_LEN || !pending) { r.badLines++; return true; }
+        if (!tleChecksumOK(r.line)) { r.badChecksums++; return true; }
+        // Both lines carry the catalog number; they have to agree
+        if (memcmp(r.line + 2, r.rec.line1 + 2, 5) != 0) { r.badLines++; return true; }
+        memcpy(r.rec.line2, r.line, TLE_LINE_LEN + 1);
+
+        if (!r.haveName) {
+            memcpy(r.rec.name, r.rec.line1 + 2, 5);
+            r.rec.name[5] = 0;
+        }
+        parseLine1(r.rec);
+        parseLine2(r.rec);
+        r.records++;
+        r.haveName = false;
+        if (fn && !fn(r.rec, ctx)) {
+            r.stopped = true;
+            return false;
+        }
+        return true;
+    }
+
+    // Anything else is a name line ("0 NAME" in the 3LE variant)
+    const char *name = r.line;
+    if (name[0] == '0' && name[1] == ' ') name += 2;
+    strncpy(r.rec.name, name, TLE_NAME_MAX - 1);
+    r.rec.name[TLE_NAME_MAX - 1] = 0;
+    r.haveName = true;
+    r.haveLine1 = false;
+    r.recordStart = r.lineStart;
+    return true;
+}
+
+bool tleReaderFeed(TleReader &r, const char *data, size_t len, TleRecordFn fn, void *ctx) {
+    if (r.stopped) return false;
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        r.offset++;
+        if (c == '\n') {
+            bool more = handleLine(r, fn, ctx);
+            r.lineStart = r.offset;
+            if (!more) return false;
+        } else if (r.lineLen < TLE_LINE_MAX) {
+            r.line[r.lineLen++] = c;
+        } else {
+            r.lineOverflow = true;
+        }
+    }
+    return true;
+}
+
+bool tleReaderFinish(TleReader &r, TleRecordFn fn, void *ctx) {
+    if (r.stopped) return false;
+    if (r.lineLen > 0) return handleLine(r, fn, ctx);
+    return true;
+}
+
+// --- ONE-SHOT PARSE ---
+struct FindCtx {
+    TleRecord *out;
+    long catalogNumber;
+    bool found;
+};
+
+static bool takeMatch(const TleRecord &rec, void *ctx) {
+    FindCtx *f = (FindCtx *)ctx;
+    if (f->catalogNumber != 0 && rec.catalogNumber != f->catalogNumber) return true;
+    *f->out = rec;
+    f->found = true;
+    return false;
+}
+
+bool tleParseText(const char *text, size_t len, TleRecord &out, long catalogNumber) {
+    TleReader reader;
+    FindCtx f = {&out, catalogNumber, false};
+    tleReaderInit(reader);
+    if (tleReaderFeed(reader, text, len, takeMatch, &f)) tleReaderFinish(reader, takeMatch, &f);
+    return f.found;
+}
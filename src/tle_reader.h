@@ -0,0 +1,66 @@
+#pragma once
+#include <Arduino.h>
+
+// --- STREAMING TLE READER ---
+// Parses TLE text (CelesTrak style: optional name line, then lines 1 and 2)
+// fed in chunks of any size. Everything lives in fixed buffers, both element
+// lines must pass the modulo-10 checksum, and each record goes to a callback
+// as soon as its line 2 arrives, so a multi-megabyte group file such as
+// active.txt is read in the RAM of a single record.
+
+#define TLE_LINE_LEN    69
+#define TLE_NAME_MAX    25
+#define TLE_LINE_MAX    96   // Longer lines are rejected, not split
+
+struct TleRecord {
+    char name[TLE_NAME_MAX];
+    char line1[TLE_LINE_LEN + 1];
+    char line2[TLE_LINE_LEN + 1];
+
+    long catalogNumber;
+    int epochYear;              // Four digits
+    double epochDay;            // Day of year, fractional (1.0 = Jan 1 00:00)
+    double epochUnix;
+    double ndot;                // rev/day^2 (first derivative / 2, as printed)
+    double nddot;               // rev/day^3 (second derivative / 6)
+    double bstar;               // 1/earth radii
+    double incDeg, raanDeg, ecc, argPerDeg, meanAnomDeg;
+    double meanMotion;          // rev/day
+    long revNumber;
+};
+
+// Called for every valid record; return false to stop reading
+typedef bool (*TleRecordFn)(const TleRecord &rec, void *ctx);
+
+struct TleReader {
+    char line[TLE_LINE_MAX + 1];
+    int lineLen;
+    bool lineOverflow;
+
+    TleRecord rec;              // Being assembled
+    bool haveName;
+    bool haveLine1;
+    bool stopped;
+
+    unsigned long offset;       // Bytes fed so far
+    unsigned long lineStart;    // Offset of the line being assembled
+    unsigned long recordStart;  // Of the record passed to the callback (its name line, if any)
+
+    unsigned long records;
+    unsigned long badChecksums;
+    unsigned long badLines;     // Element lines that were truncated, overlong or out of order
+};
+
+void tleReaderInit(TleReader &r);
+
+// Returns false once the callback has asked to stop
+bool tleReaderFeed(TleReader &r, const char *data, size_t len, TleRecordFn fn, void *ctx);
+
+// Handles a last line with no trailing newline
+bool tleReaderFinish(TleReader &r, TleRecordFn fn, void *ctx);
+
+bool tleChecksumOK(const char *line);
+
+// One-shot helper for text already in memory: first valid record, or the
+// one with `catalogNumber` when non-zero
+bool tleParseText(const char *text, size_t len, TleRecord &out, long catalogNumber = 0);
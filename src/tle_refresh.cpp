@@ -0,0 +1,231 @@
+#include "tle_refresh.h"
+#include <time.h>
+#include "net.h"
+#include "storage.h"
+#include "tle_download.h"
+
+#define VALIDATORS_MAGIC   0x56535349UL   // "ISSV"
+#define VALIDATORS_VERSION 1
+
+struct ValidatorsHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t slots;
+};
+
+static const char *dir = nullptr;
+static const char *urlFormat = nullptr;
+static TleUpdatedFn updatedFn = nullptr;
+static double (*clockFn)() = nullptr;
+
+static long queue[TLE_REFRESH_MAX];
+static int queueCount = 0;
+static int queueNext = 0;
+static bool forced = false;
+
+static TleValidators validators[TLE_REFRESH_MAX];
+static bool validatorsLoaded = false;
+
+static TleDownload download;      // The request in flight
+static char downloadPath[64];     // TleDownload keeps the pointer
+static int current = -1;          // Its validators slot
+static TleRefreshStats stats;
+
+void tleRefreshBegin(const char *tleDir, const char *format, TleUpdatedFn updated, double (*clock)()) {
+    dir = tleDir;
+    urlFormat = format;
+    updatedFn = updated;
+    clockFn = clock;
+    validatorsLoaded = false;
+    queueCount = queueNext = 0;
+}
+
+long tleMaxAgeSec(const TleRecord &rec) {
+    if (rec.meanMotion >= 15.0) return TLE_MAX_AGE_DRAG_H * 3600L;
+    if (rec.meanMotion >= 11.0) return TLE_MAX_AGE_LEO_H * 3600L;
+    return TLE_MAX_AGE_HIGH_H * 3600L;
+}
+
+static long now() {
+    return clockFn ? (long)clockFn() : (long)time(nullptr);
+}
+
+// --- FILES ---
+static void tlePath(long catalogNumber, char *path, size_t size) {
+    snprintf(path, size, "%s/%ld.tle", dir, catalogNumber);
+}
+
+static void validatorsPath(char *path, size_t size) {
+    snprintf(path, size, "%s/validators.bin", dir);
+}
+
+static void loadValidators() {
+    if (validatorsLoaded) return;
+    validatorsLoaded = true;
+    memset(validators, 0, sizeof(validators));
+
+    char path[64];
+    validatorsPath(path, sizeof(path));
+    StorageFile f = storageOpen(path, STORAGE_READ);
+    if (!storageOk(f)) return;
+    ValidatorsHeader h;
+    bool ok = storageRead(f, &h, sizeof(h)) == sizeof(h) && h.magic == VALIDATORS_MAGIC &&
+              h.version == VALIDATORS_VERSION && h.slots == TLE_REFRESH_MAX &&
+              storageRead(f, validators, sizeof(validators)) == sizeof(validators);
+    storageClose(f);
+    if (!ok) memset(validators, 0, sizeof(validators));
+}
+
+static void saveValidators() {
+    char path[64];
+    validatorsPath(path, sizeof(path));
+    StorageFile f = storageOpen(path, STORAGE_WRITE);
+    if (!storageOk(f)) return;
+    ValidatorsHeader h = {VALIDATORS_MAGIC, VALIDATORS_VERSION, TLE_REFRESH_MAX};
+    storageWrite(f, &h, sizeof(h));
+    storageWrite(f, validators, sizeof(validators));
+    storageClose(f);
+}
+
+// The satellite's slot, else a free one, else the longest unchecked
+static int validatorsSlot(long catalogNumber) {
+    int slot = 0;
+    for (int i = 0; i < TLE_REFRESH_MAX; i++) {
+        if (validators[i].catalogNumber == catalogNumber) return i;
+        if (validators[slot].catalogNumber == 0) continue;
+        if (validators[i].catalogNumber == 0 || validators[i].checkedAt < validators[slot].checkedAt) slot = i;
+    }
+    if (validators[slot].catalogNumber != catalogNumber) {
+        memset(&validators[slot], 0, sizeof(TleValidators));
+        validators[slot].catalogNumber = catalogNumber;
+    }
+    return slot;
+}
+
+static bool firstRecord(const TleRecord &rec, void *ctx) {
+    *(TleRecord *)ctx = rec;
+    return false;
+}
+
+bool tleRefreshLoad(long catalogNumber, TleRecord &out) {
+    if (!dir) return false;
+    char path[64];
+    tlePath(catalogNumber, path, sizeof(path));
+    StorageFile f = storageOpen(path, STORAGE_READ);
+    if (!storageOk(f)) return false;
+
+    static TleReader reader;
+    static char chunk[256];   // A single-satellite file is ~160 bytes
+    tleReaderInit(reader);
+    out.catalogNumber = 0;
+    bool more = true;
+    size_t n;
+    while (more && (n = storageRead(f, chunk, sizeof(chunk))) > 0) {
+        more = tleReaderFeed(reader, chunk, n, firstRecord, &out);
+    }
+    if (more) tleReaderFinish(reader, firstRecord, &out);
+    storageClose(f);
+    return out.catalogNumber == catalogNumber;
+}
+
+// --- POLICY ---
+static bool due(long catalogNumber, long t, bool haveFile, const TleRecord &have) {
+    if (forced || !haveFile || t < TLE_CLOCK_VALID) return true;
+    if (t - (long)have.epochUnix < tleMaxAgeSec(have)) return false;
+    for (int i = 0; i < TLE_REFRESH_MAX; i++) {
+        if (validators[i].catalogNumber == catalogNumber) {
+            return t - (long)validators[i].checkedAt >= TLE_RECHECK_SEC;
+        }
+    }
+    return true;
+}
+
+void tleRefreshSet(const long *catalogNumbers, int count, bool force) {
+    queueCount = 0;
+    for (int i = 0; i < count && queueCount < TLE_REFRESH_MAX; i++) {
+        bool dup = false;
+        for (int j = 0; j < queueCount; j++) dup = dup || queue[j] == catalogNumbers[i];
+        if (!dup && catalogNumbers[i] > 0) queue[queueCount++] = catalogNumbers[i];
+    }
+    queueNext = 0;
+    forced = force;
+}
+
+bool tleRefreshAnyDue(long t) {
+    loadValidators();
+    TleRecord have;
+    for (int i = 0; i < queueCount; i++) {
+        if (due(queue[i], t, tleRefreshLoad(queue[i], have), have)) return true;
+    }
+    return false;
+}
+
+// --- SESSION ---
+// NetNextFn: runs once the clock is synced, so the age checks are real
+static bool nextRequest(NetRequest &req, void *) {
+    long t = now();
+    TleRecord have;
+    while (queueNext < queueCount) {
+        long catnr = queue[queueNext++];
+        stats.considered++;
+        bool haveFile = tleRefreshLoad(catnr, have);
+        if (!due(catnr, t, haveFile, have)) continue;
+
+        tlePath(catnr, downloadPath, sizeof(downloadPath));
+        if (!tleDownloadBegin(download, downloadPath, catnr)) {
+            stats.failed++;
+            continue;
+        }
+
+        current = validatorsSlot(catnr);
+        snprintf(req.url, sizeof(req.url), urlFormat, catnr);
+        // Validators only while the file they describe is still there
+        if (haveFile) {
+            req.etag = validators[current].etag;
+            req.lastModified = validators[current].lastModified;
+        }
+        req.sink = tleDownloadSink;
+        req.ctx = &download;
+        stats.requested++;
+        return true;
+    }
+    return false;
+}
+
+static void copyValidator(char *dst, size_t size, const char *value) {
+    strncpy(dst, value ? value : "", size - 1);
+    dst[size - 1] = 0;
+}
+
+// NetDoneFn
+static void requestDone(int status, const char *etag, const char *lastModified, void *) {
+    TleValidators &v = validators[current];
+    TleRecord rec;
+    if (status == 200 && tleDownloadFinish(download, rec)) {
+        copyValidator(v.etag, sizeof(v.etag), etag);
+        copyValidator(v.lastModified, sizeof(v.lastModified), lastModified);
+        stats.updated++;
+        if (updatedFn) updatedFn(rec);
+    } else {
+        if (status != 200) tleDownloadAbort(download);
+        if (status == 304) stats.unchanged++;
+        else stats.failed++;
+    }
+    if (status != 0) {
+        v.checkedAt = (uint32_t)now();
+        saveValidators();
+    }
+}
+
+bool tleRefreshStart(const char *ssid, const char *pass, long utcOffsetSec) {
+    if (!dir || netBusy()) return false;
+    loadValidators();
+    storageMakeDir(dir);
+    memset(&stats, 0, sizeof(stats));
+    queueNext = 0;
+    return netStartOnline(ssid, pass, utcOffsetSec, nextRequest, requestDone, nullptr);
+}
+
+const TleRefreshStats &tleRefreshStats() {
+    return stats;
+}
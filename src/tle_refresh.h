@@ -0,0 +1,67 @@
+#pragma once
+#include <Arduino.h>
+#include "tle_reader.h"
+
+// --- TLE REFRESH ---
+// Keeps one TLE file per satellite (<dir>/<NORAD>.tle) up to date without
+// downloading what hasn't changed:
+//  - a satellite is only asked for once its elements are older than its
+//    orbit warrants (tleMaxAgeSec), and not again for TLE_RECHECK_SEC
+//    after the server said it had nothing newer;
+//  - every request is conditional, carrying the ETag / Last-Modified of
+//    the last answer, so an unchanged TLE costs a 304 and no body;
+//  - all satellites due go in one online session: one WiFi connect and
+//    one kept-alive HTTPS connection.
+// Validators live in <dir>/validators.bin.
+
+#define TLE_REFRESH_MAX     16
+#define TLE_RECHECK_SEC     (6 * 3600L)   // After a 304 or an error
+#define TLE_CLOCK_VALID     1600000000L   // Before this the clock isn't set
+
+// How old a satellite's elements may get before asking for new ones. Drag
+// moves low orbits away from their elements fastest.
+#define TLE_MAX_AGE_DRAG_H  48    // 15+ rev/day (below ~500 km)
+#define TLE_MAX_AGE_LEO_H   96
+#define TLE_MAX_AGE_HIGH_H  336   // Under 11 rev/day: MEO, Molniya, GEO
+
+struct TleValidators {
+    int32_t catalogNumber;         // 0 = free slot
+    uint32_t checkedAt;            // Unix time of the last answer
+    char etag[48];
+    char lastModified[32];
+};
+
+struct TleRefreshStats {
+    int considered;
+    int requested;
+    int updated;                   // 200 with the satellite in it
+    int unchanged;                 // 304
+    int failed;
+};
+
+// Called for each satellite whose file was replaced
+typedef void (*TleUpdatedFn)(const TleRecord &rec);
+
+// `urlFormat` takes the NORAD number as its only argument (%ld).
+// `clock` returns unix time (nullptr = system clock; the bench passes a
+// simulated one).
+void tleRefreshBegin(const char *dir, const char *urlFormat, TleUpdatedFn updated,
+                     double (*clock)() = nullptr);
+
+long tleMaxAgeSec(const TleRecord &rec);
+
+// The satellites the next session considers. `force` skips the age and
+// recheck limits; the requests are still conditional.
+void tleRefreshSet(const long *catalogNumbers, int count, bool force);
+
+// True if a session would fetch anything at `now`. Without a valid clock
+// everything counts as due.
+bool tleRefreshAnyDue(long now);
+
+// Starts the online session (see net.h); false if the radio is busy
+bool tleRefreshStart(const char *ssid, const char *pass, long utcOffsetSec);
+
+// The satellite's file from earlier refreshes
+bool tleRefreshLoad(long catalogNumber, TleRecord &out);
+
+const TleRefreshStats &tleRefreshStats();
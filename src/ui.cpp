@@ -1,6 +1,9 @@
 #include "ui.h"
 #include "config.h"
 #include "orbit.h"
+#include "orbit_task.h"
+#include "net.h"
+#include "render.h"
 #include "iss_icon.h"
 
 void drawFrame(M5Canvas &d, String title) {
@@ -27,10 +30,11 @@ void drawHomeScreen(M5Canvas &d) {
     d.pushImage(d.width() - 55, 20, 32, 32, ISS_ICON_32x32);
 
     int y = TEXT_TOP + 25;
-    if (isOrbitReady()) {
+    const OrbitSnapshot &o = orbitView();
+    if (o.ready) {
         d.setTextColor(COL_SAT_PATH);
         d.setCursor(TEXT_LEFT, y);
-        d.printf("Tracking - %s", satName.c_str());
+        d.printf("Tracking - %s", o.name);
     } else {
         d.setTextColor(COL_SAT_NOW);
         d.setCursor(TEXT_LEFT, y);
@@ -58,135 +62,226 @@ void drawHomeScreen(M5Canvas &d) {
 
 }
 
-void drawLiveScreen(M5Canvas &d, int year, int mon, int day, int hr, int min) {
-    drawFrame(d, "Live Telemetry");
+// Between full frames only the values that changed are repainted
+void drawLiveScreen(M5Canvas &d) {
+    if (renderFull()) drawFrame(d, "Live Telemetry");
     int y = TEXT_TOP + 22;
+    int w = d.width() - FRAME_MARGIN - 1 - TEXT_LEFT;
+    const OrbitSnapshot &o = orbitView();
 
-    if (!isOrbitReady()) {
-        d.setCursor(TEXT_LEFT, y); d.println("No Data."); return;
+    if (!o.ready) {
+        renderText(d, 0, TEXT_LEFT, y, w, COL_TEXT, "No Data.");
+        return;
     }
 
-    d.setCursor(TEXT_LEFT, y);
-    d.printf("Local Time - %02d : %02d : %02d\n", hr, min, 0); 
+    // Time of the sample, so the clock and position always agree
+    time_t sampleT = (time_t)o.unixtime;
+    struct tm *tm = localtime(&sampleT);
+    int tenths = (int)((o.unixtime - (double)sampleT) * 10);
+    renderText(d, 0, TEXT_LEFT, y, w, COL_TEXT, "Local Time - %02d : %02d : %02d.%d",
+               tm->tm_hour, tm->tm_min, tm->tm_sec, tenths);
     y += LINE_SPACING;
-    d.setCursor(TEXT_LEFT, y);
-    d.printf("Lat : %.2f  Lon : %.2f\n", sat.satLat, sat.satLon);
+    renderText(d, 1, TEXT_LEFT, y, w, COL_TEXT, "Lat : %.2f  Lon : %.2f", o.lat, o.lon);
     y += LINE_SPACING;
-    d.setCursor(TEXT_LEFT, y);
-    d.printf("Alt : %.1f km\n", sat.satAlt);
+    renderText(d, 2, TEXT_LEFT, y, w, COL_TEXT, "Alt : %.1f km", o.altKm);
     y += LINE_SPACING;
-    d.setCursor(TEXT_LEFT, y);
-    d.printf("Az : %.0f  El : %.0f\n", sat.satAz, sat.satEl);
+    renderText(d, 3, TEXT_LEFT, y, w, COL_TEXT, "Az : %.1f  El : %.1f", o.az, o.el);
     y += LINE_SPACING;
-    
-    d.setCursor(TEXT_LEFT, y);
-    if (sat.satEl > 0) {
-        d.setTextColor(COL_SAT_PATH);
-        d.println("VISIBLE (Acquired)");
+
+    if (o.el > 0) {
+        renderText(d, 4, TEXT_LEFT, y, w, COL_SAT_PATH, "VISIBLE (Acquired)");
     } else {
-        d.setTextColor(COL_ACCENT);
-        d.println("BELOW HORIZON (Loss)");
+        renderText(d, 4, TEXT_LEFT, y, w, COL_ACCENT, "BELOW HORIZON (Loss)");
     }
 }
 
-void drawRadarScreen(M5Canvas &d, unsigned long currentUnix) {
-    d.fillScreen(COL_BG);
-    
-    int cx = d.width() / 2;
-    int cy = d.height() / 2 + 5;
-    int r  = 60;
+// --- RADAR ---
+// The polar grid never changes, so it is drawn once into a 4-bit palette
+// sprite (~16 KB) and blitted each frame. The pass track is projected to
+// screen points once per track the worker publishes; a frame then only
+// draws the polyline and the current-position marker. Between full frames
+// only the boxes the marker left and entered are restored and pushed.
+#define RADAR_R 60
+#define RADAR_GRID 0x2124
+
+static M5Canvas radarBg;
+static bool radarBgReady = false;
+
+static int16_t radarTrackX[RADAR_TRACK_POINTS];
+static int16_t radarTrackY[RADAR_TRACK_POINTS];
+static bool radarTrackUp[RADAR_TRACK_POINTS];
+static uint32_t radarTrackGen = 0;
+static bool radarTrackValid = false;
+
+#define RADAR_MARK_BOX 13   // Marker (radius 5) plus a pixel of margin
+static bool radarMarkShown = false;
+static int radarMarkX = 0, radarMarkY = 0;
+
+static void radarCenter(M5Canvas &d, int &cx, int &cy) {
+    cx = d.width() / 2;
+    cy = d.height() / 2 + 5;
+}
 
-    d.drawCircle(cx, cy, r, COL_ACCENT);      
-    d.drawCircle(cx, cy, r*0.66, 0x2124);     
-    d.drawCircle(cx, cy, r*0.33, 0x2124);     
-    d.drawLine(cx-r, cy, cx+r, cy, 0x2124);   
-    d.drawLine(cx, cy-r, cx, cy+r, 0x2124);   
+static void radarProject(int cx, int cy, float az, float el, int &px, int &py) {
+    if (el < 0) el = 0;
+    float theta = (az - 90) * DEG_TO_RAD;
+    float rad = RADAR_R * (1.0f - el / 90.0f);
+    px = cx + (int)lroundf(rad * cosf(theta));
+    py = cy + (int)lroundf(rad * sinf(theta));
+}
 
-    d.setTextColor(COL_HEADER);
-    d.setCursor(cx - 3, cy - r - 10); d.print("N");
-    d.setCursor(cx - 3, cy + r + 2);  d.print("S");
-    d.setCursor(cx - r - 8, cy - 4);  d.print("W");
-    d.setCursor(cx + r + 2, cy - 4);  d.print("E");
+static void buildRadarBackground(M5Canvas &d) {
+    int cx, cy;
+    radarCenter(d, cx, cy);
+
+    radarBg.setColorDepth(4);
+    if (!radarBg.createSprite(d.width(), d.height())) return;
+    radarBg.createPalette();
+    radarBg.setPaletteColor(0, COL_BG);
+    radarBg.setPaletteColor(1, COL_ACCENT);
+    radarBg.setPaletteColor(2, RADAR_GRID);
+    radarBg.setPaletteColor(3, COL_HEADER);
+    radarBg.setFont(&fonts::Font2);
+
+    // With a palette, colours are palette indices
+    radarBg.fillScreen(0);
+    radarBg.drawCircle(cx, cy, RADAR_R, 1);
+    radarBg.drawCircle(cx, cy, RADAR_R * 0.66, 2);
+    radarBg.drawCircle(cx, cy, RADAR_R * 0.33, 2);
+    radarBg.drawLine(cx - RADAR_R, cy, cx + RADAR_R, cy, 2);
+    radarBg.drawLine(cx, cy - RADAR_R, cx, cy + RADAR_R, 2);
+
+    radarBg.setTextColor(3);
+    radarBg.setCursor(cx - 3, cy - RADAR_R - 10); radarBg.print("N");
+    radarBg.setCursor(cx - 3, cy + RADAR_R + 2);  radarBg.print("S");
+    radarBg.setCursor(cx - RADAR_R - 8, cy - 4);  radarBg.print("W");
+    radarBg.setCursor(cx + RADAR_R + 2, cy - 4);  radarBg.print("E");
+    radarBgReady = true;
+}
 
-    if (!isOrbitReady()) return;
+static void projectRadarTrack(M5Canvas &d, const OrbitSnapshot &o) {
+    int cx, cy;
+    radarCenter(d, cx, cy);
+    for (int i = 0; i < o.trackCount; i++) {
+        int px, py;
+        radarProject(cx, cy, o.trackAz[i], o.trackEl[i], px, py);
+        radarTrackX[i] = px;
+        radarTrackY[i] = py;
+        radarTrackUp[i] = o.trackEl[i] > -0.5f;  // Ends sit on the horizon
+    }
+    radarTrackGen = o.trackGen;
+    radarTrackValid = true;
+}
 
-    unsigned long startT = currentUnix - (5 * 60);
-    unsigned long endT   = currentUnix + (15 * 60);
-    
-    for (unsigned long t = startT; t < endT; t+=60) {
-        sat.findsat(t);
-        if (sat.satEl > 0) {
-            float theta = (sat.satAz - 90) * DEG_TO_RAD;
-            float rad = map(sat.satEl, 0, 90, r, 0);
-            
-            int px = cx + rad * cos(theta);
-            int py = cy + rad * sin(theta);
-            
-            d.drawPixel(px, py, COL_SAT_PATH);
+static void drawRadarTrack(M5Canvas &d, const OrbitSnapshot &o) {
+    for (int i = 1; i < o.trackCount; i++) {
+        if (radarTrackUp[i - 1] && radarTrackUp[i]) {
+            d.drawLine(radarTrackX[i - 1], radarTrackY[i - 1], radarTrackX[i], radarTrackY[i], COL_SAT_PATH);
         }
     }
+}
 
-    sat.findsat(currentUnix);
-    if (sat.satEl > 0) {
-        float theta = (sat.satAz - 90) * DEG_TO_RAD;
-        float rad = map(sat.satEl, 0, 90, r, 0);
-        int px = cx + rad * cos(theta);
-        int py = cy + rad * sin(theta);
-        
-        d.fillCircle(px, py, 4, COL_SAT_NOW);
-        d.drawCircle(px, py, 5, COL_TEXT);
+// Grid and track back under the marker box at (x, y)
+static void restoreRadarBox(M5Canvas &d, const OrbitSnapshot &o, int x, int y) {
+    int half = RADAR_MARK_BOX / 2;
+    d.setClipRect(x - half, y - half, RADAR_MARK_BOX, RADAR_MARK_BOX);
+    radarBg.pushSprite(&d, 0, 0);
+    drawRadarTrack(d, o);
+    d.clearClipRect();
+    renderDirty(x - half, y - half, RADAR_MARK_BOX, RADAR_MARK_BOX);
+}
+
+void drawRadarScreen(M5Canvas &d) {
+    if (!radarBgReady) buildRadarBackground(d);
+    const OrbitSnapshot &o = orbitView();
+
+    bool newTrack = o.ready && (!radarTrackValid || o.trackGen != radarTrackGen);
+    if (newTrack) {
+        projectRadarTrack(d, o);
+        renderInvalidate();  // A new pass redraws everything
+    }
+    if (renderFull()) {
+        radarBg.pushSprite(&d, 0, 0);
+        if (o.ready) drawRadarTrack(d, o);
+        radarMarkShown = false;
+    }
+    if (!o.ready) return;
+
+    int px = 0, py = 0;
+    bool show = o.el > 0;
+    if (show) {
+        int cx, cy;
+        radarCenter(d, cx, cy);
+        radarProject(cx, cy, o.az, o.el, px, py);
+    }
+    bool moved = show != radarMarkShown || (show && (px != radarMarkX || py != radarMarkY));
+    if (moved) {
+        if (radarMarkShown) restoreRadarBox(d, o, radarMarkX, radarMarkY);
+        if (show) {
+            d.fillCircle(px, py, 4, COL_SAT_NOW);
+            d.drawCircle(px, py, 5, COL_TEXT);
+            renderDirty(px - RADAR_MARK_BOX / 2, py - RADAR_MARK_BOX / 2, RADAR_MARK_BOX, RADAR_MARK_BOX);
+        }
+        radarMarkShown = show;
+        radarMarkX = px;
+        radarMarkY = py;
+    }
+    renderText(d, 0, 5, d.height() - 15, 130, COL_ACCENT, show ? "" : "Sat below horizon");
+}
+
+// Pass screens read the worker's schedule; while it is still searching
+// (first view, new site/TLE) there's nothing to show yet.
+static bool passesPending(M5Canvas &d, const OrbitSnapshot &o, int minEl) {
+    if (o.searching && (o.passCount == 0 || o.minEl != minEl)) {
+        d.setCursor(TEXT_LEFT, TEXT_TOP + 25);
+        d.println("Calculating...");
+        return true;
+    }
+    return false;
+}
+
+// Orbits that can't produce a pass here at all, whatever the horizon.
+static bool passesImpossible(M5Canvas &d, const OrbitSnapshot &o, int minEl, int y) {
+    if (o.passCount > 0 || o.passVisibility == PASS_VIS_NORMAL) return false;
+    d.setCursor(TEXT_LEFT, y);
+    if (o.passVisibility == PASS_VIS_ALWAYS_UP) {
+        d.println("Always above horizon");
     } else {
-        d.setCursor(5, d.height() - 15);
-        d.setTextColor(COL_ACCENT);
-        d.print("Sat below horizon");
+        d.printf("Never above %d deg\n", minEl);
+        d.setCursor(TEXT_LEFT, y + LINE_SPACING);
+        d.println("from this location.");
     }
+    return true;
 }
 
-void drawPassScreen(M5Canvas &d, unsigned long currentUnix, int minEl, double lat, double lon) {
+void drawPassScreen(M5Canvas &d, unsigned long currentUnix, int minEl, int horizonDays) {
     drawFrame(d, "Pass Prediction");
     int y = TEXT_TOP + 25;
+    const OrbitSnapshot &o = orbitView();
 
-    if (!isOrbitReady()) {
+    if (!o.ready) {
         d.setCursor(TEXT_LEFT, y); d.println("No TLE."); return;
     }
+    if (passesPending(d, o, minEl)) return;
+    if (passesImpossible(d, o, minEl, y)) return;
 
-    static PassDetails nextPass;
-    static unsigned long lastCalc = 0;
-    static int lastMinEl = -1;
-    // ADD CACHING VARIABLES FOR LOCATION
-    static double lastLat = -999;
-    static double lastLon = -999;
-
-    // UPDATE THE CHECK CONDITION:
-    // We now recalc if: Time expired OR Pass passed OR MinEl changed OR Location changed
-    if (currentUnix - lastCalc > 10000 || 
-        nextPass.aosUnix < currentUnix || 
-        lastMinEl != minEl || 
-        lastLat != lat || 
-        lastLon != lon) {
-            
+    // First pass that hasn't started yet
+    const PassDetails *next = nullptr;
+    for (int i = 0; i < o.passCount; i++) {
+        if (o.passes[i].aosUnix >= currentUnix) { next = &o.passes[i]; break; }
+    }
+
+    if (!next) {
         d.setCursor(TEXT_LEFT, y);
-        d.println("Calculating...");
-        d.pushSprite(0,0);
-        
-        if (predictNextPass(currentUnix, nextPass, minEl)) {
-            lastCalc = currentUnix;
-            lastMinEl = minEl;
-            lastLat = lat; // Update Cache
-            lastLon = lon; // Update Cache
-            drawFrame(d, "Pass Prediction");
-        } else {
-            drawFrame(d, "Pass Prediction");
-            d.setCursor(TEXT_LEFT, y);
-            d.printf("No pass > %d deg\n", minEl);
-            y+= LINE_SPACING;
-            d.setCursor(TEXT_LEFT, y);
-            d.println("in next 24h.");
-            return;
-        }
+        d.printf("No pass > %d deg\n", minEl);
+        y+= LINE_SPACING;
+        d.setCursor(TEXT_LEFT, y);
+        if (horizonDays == 1) d.println("in next 24h.");
+        else d.printf("in next %d days.\n", horizonDays);
+        return;
     }
+    const PassDetails &nextPass = *next;
 
-    // ... (The rest of the drawing code remains exactly the same) ...
     time_t rawAos = nextPass.aosUnix;
     struct tm * taos = localtime(&rawAos);
     
@@ -196,14 +291,15 @@ void drawPassScreen(M5Canvas &d, unsigned long currentUnix, int minEl, double la
     d.setTextColor(COL_TEXT);
     
     char timeBuf[30];
-    strftime(timeBuf, 30, "%Y-%m-%d %H:%M", taos);
+    strftime(timeBuf, 30, "%Y-%m-%d %H:%M:%S", taos);
     y += LINE_SPACING;
     d.setCursor(TEXT_LEFT, y);
     d.println(timeBuf);
 
     y += LINE_SPACING;
     d.setCursor(TEXT_LEFT, y);
-    d.printf("Duration - %.1f min\n", nextPass.durationMins);
+    unsigned long durSecs = nextPass.losUnix - nextPass.aosUnix;
+    d.printf("Duration - %lum %02lus\n", durSecs / 60, durSecs % 60);
     
     y += LINE_SPACING;
     d.setCursor(TEXT_LEFT, y);
@@ -216,6 +312,97 @@ void drawPassScreen(M5Canvas &d, unsigned long currentUnix, int minEl, double la
 }
 
 
+void drawPassListScreen(M5Canvas &d, unsigned long currentUnix, int minEl, int horizonDays, int &offset) {
+    drawFrame(d, "Pass Schedule");
+    int y = TEXT_TOP + 20;
+    const OrbitSnapshot &o = orbitView();
+
+    if (!o.ready) {
+        d.setCursor(TEXT_LEFT, y); d.println("No TLE."); return;
+    }
+    if (passesPending(d, o, minEl)) return;
+    if (passesImpossible(d, o, minEl, y)) return;
+
+    int count = o.passCount;
+    int itemsPerPage = 4;
+    if (offset > count - itemsPerPage) offset = count - itemsPerPage;
+    if (offset < 0) offset = 0;
+
+    if (count == 0) {
+        d.setCursor(TEXT_LEFT, y);
+        d.printf("No pass > %d deg\n", minEl);
+    }
+
+    int end = offset + itemsPerPage;
+    if (end > count) end = count;
+
+    for (int i = offset; i < end; i++) {
+        const PassDetails &p = o.passes[i];
+        time_t rawAos = p.aosUnix;
+        char timeBuf[16];
+        strftime(timeBuf, sizeof(timeBuf), "%a %H:%M", localtime(&rawAos));
+
+        // Pass in progress gets highlighted
+        d.setTextColor(p.aosUnix <= currentUnix ? COL_SAT_PATH : COL_TEXT);
+        d.setCursor(TEXT_LEFT, y);
+        d.printf("%s %3lum %3.0f deg\n", timeBuf, (p.losUnix - p.aosUnix + 30) / 60, p.maxElevation);
+        y += LINE_SPACING;
+    }
+
+    // Footer: horizon and scroll hints
+    d.setTextColor(COL_ACCENT);
+    d.setCursor(TEXT_LEFT, d.height() - 24);
+    // A full schedule stops short of the horizon; say where it really ends
+    String nav = "Next " + String(horizonDays) + "d (-/+)";
+    if (count == PASS_SCHEDULE_MAX) {
+        time_t until = o.passSearchedUntil;
+        char untilBuf[16];
+        strftime(untilBuf, sizeof(untilBuf), "%a %H:%M", localtime(&until));
+        nav = "To " + String(untilBuf) + " (-/+)";
+    }
+    if (offset > 0) nav += " | ; Up";
+    if (end < count) nav += " | . Down";
+    d.print(nav);
+    d.setTextColor(COL_TEXT);
+}
+
+// Catalog satellites above the horizon right now, highest first
+void drawOverheadScreen(M5Canvas &d) {
+    drawFrame(d, "Overhead Now");
+    int y = TEXT_TOP + 20;
+    const OrbitSnapshot &o = orbitView();
+
+    if (o.catalogCount == 0) {
+        d.setCursor(TEXT_LEFT, y); d.println("No catalog.");
+        d.setCursor(TEXT_LEFT, y + LINE_SPACING); d.println("Put a TLE group file at");
+        d.setCursor(TEXT_LEFT, y + LINE_SPACING * 2); d.println("iss_tracker/catalog.tle");
+        return;
+    }
+    if (o.overheadCount == 0) {
+        d.setCursor(TEXT_LEFT, y); d.println("Nothing above the horizon.");
+    }
+
+    // The skipped line takes the last row's place
+    int maxRows = o.catalogSkipped > 0 ? 3 : 4;
+    int rows = o.overheadCount < maxRows ? o.overheadCount : maxRows;
+    for (int i = 0; i < rows; i++) {
+        const CatalogSighting &s = o.overhead[i];
+        d.setCursor(TEXT_LEFT, y);
+        d.printf("%-12s %3.0f %3.0f deg\n", s.name, s.az, s.el);
+        y += LINE_SPACING;
+    }
+
+    d.setTextColor(COL_ACCENT);
+    d.setCursor(TEXT_LEFT, d.height() - 24);
+    d.printf("%d of %d up | az el", o.overheadTotal, o.catalogCount);
+    if (o.catalogSkipped > 0) {
+        d.setCursor(TEXT_LEFT, d.height() - 24 - LINE_SPACING);
+        d.printf("%ld deep-space skipped", o.catalogSkipped);
+    }
+    d.setTextColor(COL_TEXT);
+}
+
+
 // New Helper for consistent menu look
 void drawMenu(M5Canvas &d, String title, const char* items[], int count) {
     drawFrame(d, title);
@@ -286,14 +473,25 @@ void drawSatMenu(M5Canvas &d, int minEl, int satCat) {
     y += 10;
     d.setCursor(TEXT_LEFT, y);
     d.setTextColor(COL_ACCENT);
-    if (tleParsedOK) {
-        d.printf("Tracking: %s", satName.c_str());
+    // A background update takes the footer while it runs, and for a while
+    // after it fails
+    const NetProgress &n = netProgress();
+    const OrbitSnapshot &o = orbitView();
+    if (n.state == NET_CONNECTING) {
+        d.print("Connecting WiFi...");
+    } else if (n.state == NET_SYNCING_TIME) {
+        d.print("Syncing time...");
+    } else if (n.state == NET_DOWNLOADING) {
+        d.printf("Updating TLE %d... %u B", n.requests + 1, (unsigned)n.bytes);
+    } else if (n.error && millis() - n.stateSinceMs < STATUS_ERROR_MS) {
+        d.printf("Update failed: %s", n.error);
+    } else if (o.ready) {
+        d.printf("Tracking: %s", o.name);
     } else {
         d.print("TLE Data Invalid/Missing");
     }
 }
 
-
 void drawLocationMenu(M5Canvas &d, double lat, double lon, bool useGps, bool gpsFix, int sats) {
     drawFrame(d, "Location Setup");
     int y = TEXT_TOP + 20;
@@ -338,44 +536,55 @@ void drawLocationMenu(M5Canvas &d, double lat, double lon, bool useGps, bool gps
     }
 }
 
-void drawGpsInfoScreen(M5Canvas &d, TinyGPSPlus &gps) {
+void drawGpsInfoScreen(M5Canvas &d, const NmeaFix &fix, const GpsStats &stats) {
     drawFrame(d, "GPS Details");
     int y = TEXT_TOP + 20;
     
     d.setCursor(TEXT_LEFT, y);
-    d.printf("Sats: %d  HDOP: %.1f\n", gps.satellites.value(), gps.hdop.hdop());
+    d.printf("Sats: %d  HDOP: %.1f\n", fix.sats, fix.hdop);
     y += LINE_SPACING;
 
     d.setCursor(TEXT_LEFT, y);
-    d.printf("Lat: %.5f\n", gps.location.lat());
+    d.printf("Lat: %.5f\n", fix.lat);
     y += LINE_SPACING;
 
     d.setCursor(TEXT_LEFT, y);
-    d.printf("Lon: %.5f\n", gps.location.lng());
+    d.printf("Lon: %.5f\n", fix.lon);
     y += LINE_SPACING;
 
     d.setCursor(TEXT_LEFT, y);
-    d.printf("Alt: %.1f m\n", gps.altitude.meters());
+    d.printf("Alt: %.1f m\n", fix.altM);
     y += LINE_SPACING;
 
     d.setCursor(TEXT_LEFT, y);
-    d.printf("Time: %02d:%02d:%02d UTC\n", gps.time.hour(), gps.time.minute(), gps.time.second());
+    d.printf("Time: %02d:%02d:%02d UTC\n", fix.hour, fix.minute, fix.second);
     
     y += LINE_SPACING;
     d.setCursor(TEXT_LEFT, y);
-    if (gps.location.isValid()) {
+    if (fix.locationValid) {
         d.setTextColor(COL_SAT_PATH);
         d.print("STATUS: 3D FIX");
     } else {
         d.setTextColor(COL_SAT_NOW);
         d.print("STATUS: NO FIX");
     }
+
+    // Sentences lost on the way in (an overflow shows up as a cut-short line)
+    unsigned long lost = stats.badChecksums + stats.badLines;
+    d.setTextColor(lost ? COL_SAT_NOW : COL_ACCENT);
+    d.printf("  lost %lu", lost);
 }
 
 void drawWifiScanResults(M5Canvas &d, int count) {
     drawFrame(d, "Select Network");
     int y = TEXT_TOP + 20;
 
+    if (netProgress().state == NET_SCANNING) {
+        d.setCursor(TEXT_LEFT, y);
+        d.println("Scanning WiFi...");
+        return;
+    }
+
     if (count == 0) {
         d.setCursor(TEXT_LEFT, y);
         d.println("No networks found.");
@@ -484,4 +693,42 @@ void drawAudioMenu(M5Canvas &d, bool enabled) {
     d.setTextColor(COL_ACCENT);
     d.setCursor(TEXT_LEFT, d.height() - 25);
     d.print("Press ESC to return");
-}
\ No newline at end of file
+}
+
+// --- DIAGNOSTICS ---
+// The last perf window in the small font, one row per loop phase. Rows are
+// render fields, so a new report only repaints the numbers that moved.
+#if PERF_ENABLED
+#define DIAG_LINE 8
+
+void drawDiagScreen(M5Canvas &d) {
+    if (renderFull()) drawFrame(d, perfStreaming() ? "Diagnostics - serial on" : "Diagnostics");
+    d.setFont(&fonts::Font0);
+    int y = TEXT_TOP + 23;
+    int w = d.width() - FRAME_MARGIN - 1 - TEXT_LEFT;
+    const PerfReport &r = perfReport();
+
+    if (renderFull()) {
+        d.setTextColor(COL_HEADER);
+        d.setCursor(TEXT_LEFT, y);
+        d.print("phase    n   min   avg   p99    max");
+    }
+    y += DIAG_LINE;
+
+    for (int i = 0; i < PERF_PHASES; i++) {
+        const PerfPhaseStats &s = r.phase[i];
+        renderText(d, i, TEXT_LEFT, y, w, COL_TEXT, "%-5s %4lu %5lu %5lu %5lu %6lu",
+                   perfPhaseName((PerfPhase)i), (unsigned long)s.count, (unsigned long)s.minUs,
+                   (unsigned long)s.avgUs, (unsigned long)s.p99Us, (unsigned long)s.maxUs);
+        y += DIAG_LINE;
+    }
+    renderText(d, PERF_PHASES, TEXT_LEFT, y, w, COL_SAT_PATH, "heap %lu big %lu min %lu",
+               (unsigned long)r.freeHeap, (unsigned long)r.largestBlock, (unsigned long)r.minFreeHeap);
+    y += DIAG_LINE;
+    renderText(d, PERF_PHASES + 1, TEXT_LEFT, y, w, COL_SAT_PATH, "stack %lu/%lu  px/s %lu",
+               (unsigned long)r.loopStackFree, (unsigned long)r.orbitStackFree,
+               (unsigned long)r.pixelsPerSec);
+
+    d.setFont(&fonts::Font2);
+}
+#endif
@@ -1,19 +1,25 @@
 #pragma once
 #include <M5GFX.h>
 #include <WiFi.h>
-#include <TinyGPS++.h>
+#include "gps.h"
+#include "perf.h"
 
 void drawHomeScreen(M5Canvas &d);
-void drawLiveScreen(M5Canvas &d, int year, int mon, int day, int hr, int min);
-void drawRadarScreen(M5Canvas &d, unsigned long currentUnix);
-void drawPassScreen(M5Canvas &d, unsigned long currentUnix, int minEl, double lat, double lon);
+void drawLiveScreen(M5Canvas &d);
+void drawRadarScreen(M5Canvas &d);
+void drawPassScreen(M5Canvas &d, unsigned long currentUnix, int minEl, int horizonDays);
+void drawPassListScreen(M5Canvas &d, unsigned long currentUnix, int minEl, int horizonDays, int &offset);
+void drawOverheadScreen(M5Canvas &d);
 
 void drawMainMenu(M5Canvas &d);
 void drawWifiMenu(M5Canvas &d, String storedSsid);
 void drawWifiScanResults(M5Canvas &d, int count);
 void drawSatMenu(M5Canvas &d, int minEl, int satCat);
 void drawLocationMenu(M5Canvas &d, double lat, double lon, bool useGps, bool gpsFix, int sats);
-void drawGpsInfoScreen(M5Canvas &d, TinyGPSPlus &gps);
+void drawGpsInfoScreen(M5Canvas &d, const NmeaFix &fix, const GpsStats &stats);
 void drawSatSelector(M5Canvas &d, const char* names[], int ids[], int count);
 void drawSatSelector(M5Canvas &d, const char* names[], int ids[], int count, int offset);
-void drawAudioMenu(M5Canvas &d, bool enabled);
\ No newline at end of file
+void drawAudioMenu(M5Canvas &d, bool enabled);
+#if PERF_ENABLED
+void drawDiagScreen(M5Canvas &d);
+#endif